@@ -169,6 +169,7 @@ CWEanalysisType::CWEanalysisType(QJsonDocument rawJSON)
             newResult.type = rawResult.value("type").toString();
             newResult.file = rawResult.value("file").toString();
             newResult.values = rawResult.value("values").toString();
+            newResult.patch = rawResult.value("patch").toString();
             newResult.stage = newStage.internalName;
 
             //TODO: Validate new result
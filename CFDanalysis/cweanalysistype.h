@@ -48,6 +48,7 @@ struct RESULT_ENTRY {
     QString file;
     QString values;
     QString stage;
+    QString patch;
 };
 
 
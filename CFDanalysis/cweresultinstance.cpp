@@ -39,12 +39,18 @@
 #include "visualUtils/resultVisuals/resultfield2dwindow.h"
 #include "visualUtils/resultVisuals/resultmesh3dwindow.h"
 #include "visualUtils/resultVisuals/resultmesh2dwindow.h"
+#include "visualUtils/resultVisuals/resultpatch3dwindow.h"
+#include "visualUtils/cfdcodec.h"
 
 #include "remoteFiles/filetreenode.h"
 #include "remoteFiles/fileoperator.h"
 #include "cwe_guiWidgets/cwe_results.h"
 #include "cweanalysistype.h"
 #include "cwe_globals.h"
+#include "cwe_interfacedriver.h"
+
+#include <QDir>
+#include <QInputDialog>
 
 cweResultInstance::cweResultInstance(QString stageName, RESULT_ENTRY resultData, CWE_Results *parent) : QObject(parent)
 {
@@ -71,6 +77,10 @@ cweResultInstance::cweResultInstance(QString stageName, RESULT_ENTRY resultData,
     {
         setInternalParams(true,false,"3D Mesh Image");
     }
+    else if (myResultData.type == "GLpatch3D")
+    {
+        setInternalParams(true,false,"Surface Field Image");
+    }
     else if (myResultData.type == "download")
     {
         setInternalParams(false,true,"Data Download");
@@ -83,26 +93,81 @@ void cweResultInstance::enactShowOp()
     CWEcaseInstance * currentCase = myParent->getCurrentCase();
     if (currentCase == nullptr) return;
 
-    if (myResultData.type == "text")
+    ResultVisualPopup * resultPopup = makeResultPopup(currentCase, &myResultData);
+    if (resultPopup == nullptr) return;
+    resultPopup->initializeView();
+}
+
+void cweResultInstance::showLocalResult(QString stageFolder, QWidget * parent)
+{
+    //A downloaded case is a folder named for its last complete stage, which has the
+    //files of the stages before it as well
+    QString stageId = QDir(stageFolder).dirName();
+
+    QStringList resultNames;
+    QList<RESULT_ENTRY> resultList;
+    QStringList typeNames;
+
+    for (CWEanalysisType * aType : *(cwe_globals::get_CWE_Driver()->getTemplateList()))
     {
-        ResultTextDisplay * resultPopup = new ResultTextDisplay(currentCase, &myResultData, nullptr);
-        resultPopup->initializeView();
+        QStringList stageIds = aType->getStageIds();
+        if (!stageIds.contains(stageId)) continue;
+
+        for (QString aStage : stageIds.mid(0, stageIds.indexOf(stageId) + 1))
+        {
+            for (RESULT_ENTRY aResult : aType->getStageFromId(aStage).resultList)
+            {
+                if (aResult.type == "download") continue;
+
+                resultNames.append(aType->getDisplayName() + ": " + aResult.displayName);
+                resultList.append(aResult);
+                typeNames.append(aType->getDisplayName());
+            }
+        }
     }
-    else if (myResultData.type == "GLdata")
+
+    if (resultNames.isEmpty())
     {
-        ResultField2dWindow * resultPopup = new ResultField2dWindow(currentCase, &myResultData, nullptr);
-        resultPopup->initializeView();
+        cwe_globals::displayPopup("This folder is not the stage folder of a known case type. Please select the folder saved by \"Download entire case\".", "Local Results");
+        return;
     }
-    else if (myResultData.type == "GLmesh")
+
+    bool resultChosen = false;
+    QString chosenName = QInputDialog::getItem(parent, "View Downloaded Results", "Result to view:", resultNames, 0, false, &resultChosen);
+    if (!resultChosen) return;
+
+    int chosenIndex = resultNames.indexOf(chosenName);
+    if (chosenIndex < 0) return;
+
+    ResultVisualPopup * resultPopup = makeResultPopup(nullptr, &resultList[chosenIndex]);
+    if (resultPopup == nullptr) return;
+    resultPopup->setLocalFolder(stageFolder, typeNames.at(chosenIndex));
+    resultPopup->initializeView();
+}
+
+ResultVisualPopup * cweResultInstance::makeResultPopup(CWEcaseInstance * theCase, RESULT_ENTRY * resultDesc)
+{
+    if (resultDesc->type == "text")
     {
-        ResultMesh2dWindow * resultPopup = new ResultMesh2dWindow(currentCase, &myResultData, nullptr);
-        resultPopup->initializeView();
+        return new ResultTextDisplay(theCase, resultDesc, nullptr);
     }
-    else if (myResultData.type == "GLmesh3D")
+    else if (resultDesc->type == "GLdata")
+    {
+        return new ResultField2dWindow(theCase, resultDesc, nullptr);
+    }
+    else if (resultDesc->type == "GLmesh")
+    {
+        return new ResultMesh2dWindow(theCase, resultDesc, nullptr);
+    }
+    else if (resultDesc->type == "GLmesh3D")
     {
-        ResultMesh3dWindow * resultPopup = new ResultMesh3dWindow(currentCase, &myResultData, nullptr);
-        resultPopup->initializeView();
+        return new ResultMesh3dWindow(theCase, resultDesc, nullptr);
     }
+    else if (resultDesc->type == "GLpatch3D")
+    {
+        return new ResultPatch3dWindow(theCase, resultDesc, nullptr);
+    }
+    return nullptr;
 }
 
 void cweResultInstance::enactDownloadOp()
@@ -204,7 +269,7 @@ void cweResultInstance::recomputeResultState()
     }
     else
     {
-        if (myResultData.type == "GLdata")
+        if ((myResultData.type == "GLdata") || (myResultData.type == "GLpatch3D"))
         {
             if (!baseFolderContainsNumber())
             {
@@ -216,20 +281,32 @@ void cweResultInstance::recomputeResultState()
         QList<QString> neededFiles;
         neededFiles.append("/constant/polyMesh/points");
         neededFiles.append("/constant/polyMesh/faces");
-        neededFiles.append("/constant/polyMesh/owner");
+        if (myResultData.type == "GLpatch3D")
+        {
+            neededFiles.append("/constant/polyMesh/boundary");
+        }
+        else
+        {
+            neededFiles.append("/constant/polyMesh/owner");
+        }
 
         for (QString aFileName : neededFiles)
         {
-            NodeState fileNodeState1 = cwe_globals::get_file_handle()->speculateFileWithName(baseNode, aFileName, false, false).getNodeState();
-            NodeState fileNodeState2 = cwe_globals::get_file_handle()->speculateFileWithName(baseNode, aFileName.append(".gz"), false, false).getNodeState();
+            //The file may be stored uncompressed, or with any codec
+            bool allMissing = true;
+            bool allSpeculating = true;
+            for (QString aVariant : CFDcodecList::getFileVariants(aFileName))
+            {
+                NodeState fileNodeState = cwe_globals::get_file_handle()->speculateFileWithName(baseNode, aVariant, false, false).getNodeState();
+                if ((fileNodeState != NodeState::NON_EXTANT) && (fileNodeState != NodeState::ERROR)) allMissing = false;
+                if ((fileNodeState != NodeState::FILE_SPECULATE_IDLE) && (fileNodeState != NodeState::FILE_SPECULATE_LOADING)) allSpeculating = false;
+            }
 
-            if ( ((fileNodeState1 == NodeState::NON_EXTANT) || (fileNodeState1 == NodeState::ERROR)) &&
-                ((fileNodeState2 == NodeState::NON_EXTANT) || (fileNodeState2 == NodeState::ERROR)) )
+            if (allMissing)
             {
                 changeMyState(ResultInstanceState::NIL);
             }
-            else if ( ((fileNodeState1 == NodeState::FILE_SPECULATE_IDLE) || (fileNodeState1 == NodeState::FILE_SPECULATE_LOADING)) &&
-                      ((fileNodeState2 == NodeState::FILE_SPECULATE_IDLE) || (fileNodeState2 == NodeState::FILE_SPECULATE_LOADING)) )
+            else if (allSpeculating)
             {
                 changeMyState(ResultInstanceState::UNLOADED);
                 return;
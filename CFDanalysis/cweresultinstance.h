@@ -43,6 +43,8 @@
 #include "CFDanalysis/cweanalysistype.h"
 class CWE_Results;
 class FileNodeRef;
+class CWEcaseInstance;
+class ResultVisualPopup;
 
 enum class ResultInstanceState {UNLOADED, NIL, LOADED};
 
@@ -55,6 +57,10 @@ public:
     void enactShowOp();
     void enactDownloadOp();
 
+    //For a stage folder on local disk, such as one saved by CWEcaseInstance::downloadCase,
+    //asks which result of that stage to show, then shows it
+    static void showLocalResult(QString stageFolder, QWidget * parent);
+
     QList<QStandardItem *> getItemList();
     ResultInstanceState getState();
 
@@ -62,6 +68,9 @@ public slots:
     void recomputeResultState();
 
 private:
+    //Returns nullptr if the result type has no display
+    static ResultVisualPopup * makeResultPopup(CWEcaseInstance * theCase, RESULT_ENTRY * resultDesc);
+
     void setInternalParams(bool show, bool download, QString type);
     void changeMyState(ResultInstanceState newState);
     bool baseFolderContainsNumber();
@@ -41,6 +41,7 @@ NEEDED_PRI=$$PWD/../$$NEEDED_REPO/"$$NEEDED_REPO".pri
 }
 
 include($$NEEDED_PRI)
+include(visualUtils/cfdparsing.pri)
 
 QT += core gui network
 
@@ -69,8 +70,6 @@ SOURCES += \
     main.cpp \
     mainWindow/cwe_mainwindow.cpp \
     visualUtils/cfdglcanvas.cpp \
-    visualUtils/cfdtoken.cpp \
-    visualUtils/decompresswrapper.cpp \
     cwe_guiWidgets/cwe_super.cpp \
     cwe_guiWidgets/cwe_help.cpp \
     cwe_guiWidgets/cwe_manage_simulation.cpp \
@@ -88,6 +87,7 @@ SOURCES += \
     cwe_interfacedriver.cpp \
     visualUtils/resultVisuals/resultmesh2dwindow.cpp \
     visualUtils/resultprocurebase.cpp \
+    visualUtils/cfdresultcache.cpp \
     visualUtils/resultvisualpopup.cpp \
     visualUtils/resultVisuals/resultfield2dwindow.cpp \
     visualUtils/resultVisuals/resulttextdisp.cpp \
@@ -103,16 +103,17 @@ SOURCES += \
     cwe_guiWidgets/cwe_param_tabs/cwe_paramtab.cpp \
     cwe_guiWidgets/cwe_param_tabs/cwe_paneltab.cpp \
     visualUtils/resultVisuals/resultmesh3dwindow.cpp \
+    visualUtils/resultVisuals/resultpatch3dwindow.cpp \
     visualUtils/cfdglcanvas2D.cpp \
     CFDanalysis/cweresultinstance.cpp \
     CFDanalysis/cweanalysistype.cpp \
     CFDanalysis/cwecaseinstance.cpp \
-    visualUtils/cfdglcanvas3D.cpp
+    visualUtils/cfdglcanvas3D.cpp \
+    visualUtils/cfdfielddisplay.cpp \
+    visualUtils/cfdhistogramlegend.cpp
 
 HEADERS  += \
     visualUtils/cfdglcanvas.h \
-    visualUtils/cfdtoken.h \
-    visualUtils/decompresswrapper.h \
     mainWindow/cwe_mainwindow.h \
     cwe_guiWidgets/cwe_super.h \
     cwe_guiWidgets/cwe_help.h \
@@ -131,6 +132,7 @@ HEADERS  += \
     cwe_interfacedriver.h \
     visualUtils/resultVisuals/resultmesh2dwindow.h \
     visualUtils/resultprocurebase.h \
+    visualUtils/cfdresultcache.h \
     visualUtils/resultvisualpopup.h \
     visualUtils/resultVisuals/resultfield2dwindow.h \
     visualUtils/resultVisuals/resulttextdisp.h \
@@ -146,11 +148,14 @@ HEADERS  += \
     cwe_guiWidgets/cwe_param_tabs/cwe_paramtab.h \
     cwe_guiWidgets/cwe_param_tabs/cwe_paneltab.h \
     visualUtils/resultVisuals/resultmesh3dwindow.h \
+    visualUtils/resultVisuals/resultpatch3dwindow.h \
     visualUtils/cfdglcanvas2D.h \
     CFDanalysis/cweresultinstance.h \
     CFDanalysis/cweanalysistype.h \
     CFDanalysis/cwecaseinstance.h \
-    visualUtils/cfdglcanvas3D.h
+    visualUtils/cfdglcanvas3D.h \
+    visualUtils/cfdfielddisplay.h \
+    visualUtils/cfdhistogramlegend.h
 
 FORMS    += \
     mainWindow/cwe_mainwindow.ui \
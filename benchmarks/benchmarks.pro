@@ -0,0 +1,8 @@
+# Benchmarks for loading result files, these need no Agave connection
+# Build in release mode, ex: qmake CONFIG+=release benchmarks.pro
+
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    numberparse \
+    resultload
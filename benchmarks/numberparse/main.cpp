@@ -0,0 +1,179 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+//Usage: numberparse [MB of test data, default 64]
+//Checks that parsed doubles round-trip exactly, then reports throughput
+//of the number parser against QByteArray::toDouble
+
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "cfdnumberparser.h"
+#include "cfdlistreader.h"
+
+static QByteArray makePointFile(int targetBytes, std::vector<double> * expected)
+{
+    std::mt19937_64 randGen(12345);
+    std::uniform_real_distribution<double> coordDist(-50.0, 50.0);
+    std::uniform_int_distribution<int> formatDist(0, 3);
+
+    QByteArray listBody;
+    listBody.reserve(targetBytes + 128);
+    int pointCount = 0;
+    char lineBuff[128];
+
+    while (listBody.size() < targetBytes)
+    {
+        double coords[3];
+        listBody.append('(');
+        for (int ind = 0; ind < 3; ind++)
+        {
+            //Mix OpenFOAM's usual 6 digit output with full precision values
+            const char * numFormat = (formatDist(randGen) != 0) ? "%.6g" : "%.17g";
+            snprintf(lineBuff, sizeof(lineBuff), numFormat, coordDist(randGen));
+            coords[ind] = strtod(lineBuff, nullptr);
+            if (ind != 0) listBody.append(' ');
+            listBody.append(lineBuff, static_cast<int>(strlen(lineBuff)));
+        }
+        listBody.append(")\n");
+        expected->insert(expected->end(), coords, coords + 3);
+        pointCount++;
+    }
+
+    QByteArray ret("FoamFile\n{\n    version     2.0;\n    format      ascii;\n"
+                   "    class       vectorField;\n    object      points;\n}\n\n");
+    ret.append(QByteArray::number(pointCount));
+    ret.append("\n(\n");
+    ret.append(listBody);
+    ret.append(")\n");
+    return ret;
+}
+
+static double toMBs(qint64 bytes, qint64 nsecs)
+{
+    if (nsecs <= 0) return 0.0;
+    return (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (static_cast<double>(nsecs) / 1.0e9);
+}
+
+int main(int argc, char *argv[])
+{
+    int targetMB = 64;
+    if (argc > 1) targetMB = atoi(argv[1]);
+    if (targetMB < 1) targetMB = 1;
+
+    std::vector<double> expected;
+    QByteArray pointFile = makePointFile(targetMB * 1024 * 1024, &expected);
+    const char * fileEnd = pointFile.constData() + pointFile.size();
+
+    printf("SIMD mode: %s\n", CFDnumberParser::getSimdMode());
+    printf("Test data: %d bytes, %zu values\n", pointFile.size(), expected.size());
+
+    //Round trip check, with the raw scanner
+    const char * listStart = pointFile.constData() + pointFile.indexOf("\n(\n") + 3;
+    size_t mismatches = 0;
+    size_t valueCount = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (const char * pos = listStart; pos < fileEnd; )
+    {
+        pos = CFDnumberParser::skipSpace(pos, fileEnd);
+        if ((pos < fileEnd) && ((*pos == '(') || (*pos == ')')))
+        {
+            pos++;
+            continue;
+        }
+        const char * tokenEnd = CFDnumberParser::findTokenEnd(pos, fileEnd);
+        if (tokenEnd == pos) break;
+        double aValue = 0.0;
+        if (!CFDnumberParser::parseDouble(pos, tokenEnd, &aValue) ||
+                (valueCount >= expected.size()) ||
+                (memcmp(&aValue, &expected[valueCount], sizeof(double)) != 0))
+        {
+            mismatches++;
+        }
+        valueCount++;
+        pos = tokenEnd;
+    }
+    qint64 scanTime = timer.nsecsElapsed();
+
+    if ((mismatches != 0) || (valueCount != expected.size()))
+    {
+        printf("FAIL: %zu values did not round trip, %zu of %zu values found\n",
+               mismatches, valueCount, expected.size());
+        return 1;
+    }
+    printf("Round trip: all values exact\n");
+
+    //Baseline, the old path through QByteArray
+    timer.restart();
+    double checkSum = 0.0;
+    for (const char * pos = listStart; pos < fileEnd; )
+    {
+        while ((pos < fileEnd) && ((*pos == ' ') || (*pos == '\n') || (*pos == '(') || (*pos == ')'))) pos++;
+        const char * tokenEnd = pos;
+        while ((tokenEnd < fileEnd) && (*tokenEnd != ' ') && (*tokenEnd != '\n') && (*tokenEnd != ')')) tokenEnd++;
+        if (tokenEnd == pos) break;
+        QByteArray aWord(pos, static_cast<int>(tokenEnd - pos));
+        bool isNum;
+        aWord.toInt(&isNum);
+        checkSum += aWord.toDouble(&isNum);
+        pos = tokenEnd;
+    }
+    qint64 baselineTime = timer.nsecsElapsed();
+
+    timer.restart();
+    std::vector<double> readPoints;
+    CFDlistReader pointReader(&pointFile);
+    bool readOK = pointReader.readVectorList(&readPoints);
+    qint64 readerTime = timer.nsecsElapsed();
+
+    if (!readOK || (readPoints != expected))
+    {
+        printf("FAIL: list reader result does not match\n");
+        return 1;
+    }
+
+    printf("Number scanner:      %8.1f MB/s\n", toMBs(pointFile.size(), scanTime));
+    printf("Vector list reader:  %8.1f MB/s\n", toMBs(pointFile.size(), readerTime));
+    printf("QByteArray baseline: %8.1f MB/s (checksum %g)\n", toMBs(pointFile.size(), baselineTime), checkSum);
+
+    return 0;
+}
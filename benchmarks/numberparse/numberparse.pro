@@ -0,0 +1,15 @@
+# Microbenchmark for the OpenFOAM ASCII number parser
+# Build in release mode, the SIMD path used (from the CPU) is printed with the results
+
+QT += core
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = numberparse
+TEMPLATE = app
+
+include(../../visualUtils/cfdparsing.pri)
+
+SOURCES += main.cpp
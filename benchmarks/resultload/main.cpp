@@ -0,0 +1,350 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+//Usage: resultload [--min-faces N] [--max-faces N] [--out results.json]
+//Generates synthetic cases, from 1e4 to 1e8 faces by default, in steps of 10x, in ASCII and binary,
+//and times each stage of loading them. Results are written as JSON, to stdout unless --out is given.
+//Note: peak RSS is for the whole process so far, so sizes are run from smallest to largest.
+//Cases whose faces file would not fit in a QByteArray are listed as skipped.
+
+#include <QApplication>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "synthcase.h"
+#include "decompresswrapper.h"
+#include "cfdparsepipeline.h"
+#include "cfdlocalfile.h"
+#include "cfdmeshsidecar.h"
+#include "cfdmemoryuse.h"
+#include "cfdtoken.h"
+#include "cfdtokenizer.h"
+#include "cfdnumberparser.h"
+#include "cfdglcanvas2D.h"
+
+//The token tree holds every word of the input, so it is only run on files this small
+static const qint64 TREE_BYTE_LIMIT = 512LL * 1024 * 1024;
+
+class CountingSink : public CFDtokenSink
+{
+public:
+    virtual void receiveToken(CFDlexType, qint64, const char *, int)
+    {
+        tokenCount++;
+    }
+
+    qint64 tokenCount = 0;
+};
+
+static QJsonObject makeRecord(const char * stage, const char * format, const SynthCase &aCase,
+                              qint64 bytes, qint64 nsecs, bool readOK)
+{
+    double seconds = static_cast<double>(nsecs) / 1.0e9;
+
+    QJsonObject ret;
+    ret["stage"] = stage;
+    ret["format"] = format;
+    ret["faces"] = static_cast<double>(aCase.faceCount);
+    ret["cells"] = static_cast<double>(aCase.cellCount);
+    ret["bytes"] = static_cast<double>(bytes);
+    ret["seconds"] = seconds;
+    ret["mbPerSec"] = (seconds > 0.0) ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / seconds : 0.0;
+    ret["peakRssMB"] = CFDmemoryUse::getPeakRssMB();
+    ret["ok"] = readOK;
+
+    fprintf(stderr, "%-20s %-7s %12lld faces %10.3f s %s\n", stage, format,
+            static_cast<long long>(aCase.faceCount), seconds, readOK ? "" : "FAILED");
+    return ret;
+}
+
+static void runCase(qint64 targetFaces, SynthFormat format, QJsonArray * results)
+{
+    const char * formatName = (format == SynthFormat::BINARY) ? "binary" : "ascii";
+
+    qint64 faceFileBytes = SynthCaseMaker::estimateFaceFileBytes(targetFaces, format);
+    if (faceFileBytes > 2000LL * 1000 * 1000)
+    {
+        QJsonObject skipRecord;
+        skipRecord["format"] = formatName;
+        skipRecord["faces"] = static_cast<double>(targetFaces);
+        skipRecord["skipped"] = "faces file would not fit in a QByteArray";
+        results->append(skipRecord);
+        fprintf(stderr, "Skipping %s case of %lld faces\n", formatName, static_cast<long long>(targetFaces));
+        return;
+    }
+
+    SynthCase aCase;
+    SynthCaseMaker::makeCase(targetFaces, format, &aCase);
+    QByteArray * caseFiles[5] = {&aCase.points, &aCase.faces, &aCase.owner, &aCase.scalarField, &aCase.vectorField};
+    qint64 meshBytes = aCase.points.size() + aCase.faces.size() + aCase.owner.size();
+    qint64 totalBytes = meshBytes + aCase.scalarField.size() + aCase.vectorField.size();
+
+    QElapsedTimer timer;
+
+    //The token based paths only read text
+    if (format == SynthFormat::ASCII)
+    {
+        if (totalBytes <= TREE_BYTE_LIMIT)
+        {
+            bool readOK = true;
+            timer.start();
+            for (QByteArray * aFile : caseFiles)
+            {
+                CFDtokenTree fileTree;
+                readOK = fileTree.lexifyString(aFile) && readOK;
+            }
+            results->append(makeRecord("tokenTree", formatName, aCase, totalBytes, timer.nsecsElapsed(), readOK));
+        }
+
+        bool readOK = true;
+        qint64 tokenCount = 0;
+        timer.start();
+        for (QByteArray * aFile : caseFiles)
+        {
+            CountingSink aSink;
+            CFDtokenizer aTokenizer(&aSink);
+            aTokenizer.feed(aFile->constData(), aFile->size());
+            readOK = aTokenizer.finish() && readOK;
+            tokenCount += aSink.tokenCount;
+        }
+        QJsonObject tokenRecord = makeRecord("tokenizer", formatName, aCase, totalBytes, timer.nsecsElapsed(), readOK);
+        tokenRecord["tokens"] = static_cast<double>(tokenCount);
+        results->append(tokenRecord);
+    }
+
+    CFDglCanvas2D * aCanvas = new CFDglCanvas2D();
+
+    timer.start();
+    bool readOK = aCanvas->loadMeshData(&aCase.points, &aCase.faces, &aCase.owner);
+    QJsonObject meshRecord = makeRecord("loadMesh", formatName, aCase, meshBytes, timer.nsecsElapsed(), readOK);
+    //What the canvas keeps of the mesh, once its shown faces are found
+    meshRecord["heldBytes"] = static_cast<double>(aCanvas->getHeldBytes());
+    results->append(meshRecord);
+
+    timer.start();
+    readOK = readOK && aCanvas->loadFieldData(&aCase.scalarField, "scalar");
+    results->append(makeRecord("loadFieldScalar", formatName, aCase, aCase.scalarField.size(), timer.nsecsElapsed(), readOK));
+
+    timer.start();
+    readOK = readOK && aCanvas->loadFieldData(&aCase.vectorField, "magnitude");
+    results->append(makeRecord("loadFieldMagnitude", formatName, aCase, aCase.vectorField.size(), timer.nsecsElapsed(), readOK));
+
+    delete aCanvas;
+
+    //Compressed as stored on the server, bytes are counted after decompression
+    QByteArray zipFiles[5];
+    qint64 zipBytes = 0;
+    for (int ind = 0; ind < 5; ind++)
+    {
+        zipFiles[ind] = SynthCaseMaker::gzipBytes(*caseFiles[ind]);
+        zipBytes += zipFiles[ind].size();
+    }
+
+    readOK = true;
+    timer.start();
+    for (int ind = 0; ind < 5; ind++)
+    {
+        DeCompressWrapper inflater(&zipFiles[ind]);
+        QByteArray * inflatedFile = inflater.getDecompressedFile();
+        readOK = (inflatedFile != nullptr) && (inflatedFile->size() == caseFiles[ind]->size()) && readOK;
+        delete inflatedFile;
+    }
+    QJsonObject zipRecord = makeRecord("decompress", formatName, aCase, totalBytes, timer.nsecsElapsed(), readOK);
+    zipRecord["compressedBytes"] = static_cast<double>(zipBytes);
+    results->append(zipRecord);
+
+    //The same files re-blocked as BGZF, whose blocks are inflated in parallel
+    QByteArray blockedFiles[5];
+    qint64 blockedBytes = 0;
+    readOK = true;
+    for (int ind = 0; ind < 5; ind++)
+    {
+        QByteArray * blockedFile = DeCompressWrapper::reblockFile(zipFiles[ind]);
+        readOK = (blockedFile != nullptr) && readOK;
+        if (blockedFile == nullptr) continue;
+        blockedFiles[ind].swap(*blockedFile);
+        blockedBytes += blockedFiles[ind].size();
+        delete blockedFile;
+    }
+
+    timer.start();
+    for (int ind = 0; ind < 5; ind++)
+    {
+        DeCompressWrapper inflater(&blockedFiles[ind]);
+        QByteArray * inflatedFile = inflater.getDecompressedFile();
+        readOK = (inflatedFile != nullptr) && (inflatedFile->size() == caseFiles[ind]->size()) && readOK;
+        delete inflatedFile;
+    }
+    QJsonObject blockedRecord = makeRecord("decompressBgzf", formatName, aCase, totalBytes, timer.nsecsElapsed(), readOK);
+    blockedRecord["compressedBytes"] = static_cast<double>(blockedBytes);
+    results->append(blockedRecord);
+
+    //Inflate and parse together, from the compressed files
+    const CFDparseTarget fileTargets[5] = {CFDparseTarget::POINTS, CFDparseTarget::FACES, CFDparseTarget::LABELS,
+                                           CFDparseTarget::SCALAR_FIELD, CFDparseTarget::VECTOR_FIELD};
+    readOK = true;
+    timer.start();
+    for (int ind = 0; ind < 5; ind++)
+    {
+        CFDparsePipeline aPipeline(zipFiles[ind], fileTargets[ind]);
+        readOK = aPipeline.run() && readOK;
+    }
+    QJsonObject pipeRecord = makeRecord("pipeline", formatName, aCase, totalBytes, timer.nsecsElapsed(), readOK);
+    pipeRecord["compressedBytes"] = static_cast<double>(zipBytes);
+    results->append(pipeRecord);
+
+    //The same, from memory mapped files in a local folder, uncompressed then compressed
+    QTemporaryDir caseFolder;
+    const char * localStages[2] = {"localFile", "localFileGz"};
+    for (int zipped = 0; zipped < 2; zipped++)
+    {
+        readOK = caseFolder.isValid();
+        QString fileNames[5];
+        for (int ind = 0; (ind < 5) && readOK; ind++)
+        {
+            fileNames[ind] = caseFolder.filePath(QString("file%1%2").arg(ind).arg(zipped ? ".gz" : ""));
+            QFile outputFile(fileNames[ind]);
+            const QByteArray &fileData = zipped ? zipFiles[ind] : *caseFiles[ind];
+            readOK = outputFile.open(QIODevice::WriteOnly) && (outputFile.write(fileData) == fileData.size());
+        }
+
+        timer.start();
+        for (int ind = 0; (ind < 5) && readOK; ind++)
+        {
+            CFDlocalFile localFile(fileNames[ind]);
+            readOK = localFile.openFile();
+            if (!readOK) break;
+
+            CFDparsePipeline aPipeline(localFile.getRawData(), fileTargets[ind]);
+            readOK = aPipeline.run();
+        }
+        results->append(makeRecord(localStages[zipped], formatName, aCase, totalBytes, timer.nsecsElapsed(), readOK));
+    }
+
+    //Opening the same results again, from the sidecars written after the first parse
+    readOK = caseFolder.isValid();
+    QString sidecarNames[5];
+    for (int ind = 0; (ind < 5) && readOK; ind++)
+    {
+        sidecarNames[ind] = caseFolder.filePath(QString("file%1.cwemesh").arg(ind));
+        CFDparsePipeline aPipeline(zipFiles[ind], fileTargets[ind]);
+        readOK = aPipeline.run() && CFDmeshSidecar::writeSidecar(sidecarNames[ind], fileTargets[ind], *aPipeline.getResult());
+    }
+
+    timer.start();
+    for (int ind = 0; (ind < 5) && readOK; ind++)
+    {
+        CFDparsedList parsedList;
+        readOK = CFDmeshSidecar::readSidecar(sidecarNames[ind], fileTargets[ind], &parsedList);
+    }
+    results->append(makeRecord("sidecar", formatName, aCase, totalBytes, timer.nsecsElapsed(), readOK));
+}
+
+int main(int argc, char *argv[])
+{
+    //The canvas is a widget, but is never shown, so no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication benchApp(argc, argv);
+
+    qint64 minFaces = 10000;
+    qint64 maxFaces = 100000000;
+    QString outFileName;
+
+    for (int ind = 1; ind < argc; ind++)
+    {
+        bool hasValue = (ind + 1 < argc);
+        if (hasValue && (strcmp(argv[ind], "--min-faces") == 0))
+        {
+            minFaces = atoll(argv[++ind]);
+        }
+        else if (hasValue && (strcmp(argv[ind], "--max-faces") == 0))
+        {
+            maxFaces = atoll(argv[++ind]);
+        }
+        else if (hasValue && (strcmp(argv[ind], "--out") == 0))
+        {
+            outFileName = QString::fromLocal8Bit(argv[++ind]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: resultload [--min-faces N] [--max-faces N] [--out results.json]\n");
+            return 1;
+        }
+    }
+    if (minFaces < 1) minFaces = 1;
+
+    QJsonArray results;
+    for (qint64 targetFaces = minFaces; targetFaces <= maxFaces; targetFaces *= 10)
+    {
+        runCase(targetFaces, SynthFormat::ASCII, &results);
+        runCase(targetFaces, SynthFormat::BINARY, &results);
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "resultload";
+    report["simdMode"] = CFDnumberParser::getSimdMode();
+    report["threads"] = QThread::idealThreadCount();
+    report["results"] = results;
+    QByteArray reportText = QJsonDocument(report).toJson();
+
+    if (outFileName.isEmpty())
+    {
+        fwrite(reportText.constData(), 1, static_cast<size_t>(reportText.size()), stdout);
+        return 0;
+    }
+
+    QFile outFile(outFileName);
+    if (!outFile.open(QIODevice::WriteOnly))
+    {
+        fprintf(stderr, "Unable to write %s\n", qPrintable(outFileName));
+        return 1;
+    }
+    outFile.write(reportText);
+    outFile.close();
+    return 0;
+}
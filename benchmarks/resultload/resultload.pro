@@ -0,0 +1,27 @@
+# Benchmark of the result loading path on synthetic OpenFOAM cases
+# Build in release mode, output is JSON, see main.cpp for usage
+
+QT += core gui widgets
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = resultload
+TEMPLATE = app
+
+include(../../visualUtils/cfdparsing.pri)
+
+win32 {
+    LIBS += OpenGL32.lib
+}
+
+SOURCES += \
+    main.cpp \
+    synthcase.cpp \
+    ../../visualUtils/cfdglcanvas.cpp \
+    ../../visualUtils/cfdglcanvas2D.cpp
+
+HEADERS += \
+    synthcase.h \
+    ../../visualUtils/cfdglcanvas.h \
+    ../../visualUtils/cfdglcanvas2D.h
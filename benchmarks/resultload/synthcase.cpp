@@ -0,0 +1,316 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "synthcase.h"
+
+#include <QSysInfo>
+
+#ifdef Q_OS_WIN
+    #include <QtZlib/zlib.h>
+#else
+    #include <zlib.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//Calls faceFunc(a, b, c, d, owner) for each quad face of an nx by nx by 1 block of cells
+template <typename FaceFunc>
+static void forEachFace(qint64 nx, FaceFunc faceFunc)
+{
+    qint64 rowPoints = nx + 1;
+    qint64 layerPoints = rowPoints * rowPoints;
+
+    //Front and back faces, on z = 0 and z = 1
+    for (qint64 layer = 0; layer < 2; layer++)
+    {
+        for (qint64 j = 0; j < nx; j++)
+        {
+            for (qint64 i = 0; i < nx; i++)
+            {
+                qint64 base = layer * layerPoints + j * rowPoints + i;
+                faceFunc(base, base + rowPoints, base + rowPoints + 1, base + 1, j * nx + i);
+            }
+        }
+    }
+
+    //Faces normal to x, then to y
+    for (qint64 j = 0; j < nx; j++)
+    {
+        for (qint64 i = 0; i <= nx; i++)
+        {
+            qint64 base = j * rowPoints + i;
+            qint64 cell = j * nx + ((i < nx) ? i : nx - 1);
+            faceFunc(base, base + rowPoints, base + rowPoints + layerPoints, base + layerPoints, cell);
+        }
+    }
+    for (qint64 j = 0; j <= nx; j++)
+    {
+        for (qint64 i = 0; i < nx; i++)
+        {
+            qint64 base = j * rowPoints + i;
+            qint64 cell = ((j < nx) ? j : nx - 1) * nx + i;
+            faceFunc(base, base + 1, base + 1 + layerPoints, base + layerPoints, cell);
+        }
+    }
+}
+
+qint64 SynthCaseMaker::estimateFaceFileBytes(qint64 targetFaces, SynthFormat format)
+{
+    qint64 nx = getGridWidth(targetFaces);
+    qint64 faceCount = 4 * nx * nx + 2 * nx;
+
+    if (format == SynthFormat::BINARY)
+    {
+        return faceCount * 5 * static_cast<qint64>(sizeof(qint32));
+    }
+
+    qint64 labelDigits = static_cast<qint64>(std::log10(2.0 * (nx + 1) * (nx + 1))) + 1;
+    return faceCount * (4 * (labelDigits + 1) + 3);
+}
+
+void SynthCaseMaker::makeCase(qint64 targetFaces, SynthFormat format, SynthCase * newCase)
+{
+    qint64 nx = getGridWidth(targetFaces);
+    qint64 pointCount = 2 * (nx + 1) * (nx + 1);
+    newCase->cellCount = nx * nx;
+    newCase->faceCount = 4 * nx * nx + 2 * nx;
+    bool isBinary = (format == SynthFormat::BINARY);
+
+    QByteArray * fileBytes = &newCase->points;
+    *fileBytes = QByteArray();
+    appendHeader(fileBytes, format, "vectorField", "points");
+    appendLabel(fileBytes, pointCount);
+    fileBytes->append("\n(");
+    for (qint64 layer = 0; layer < 2; layer++)
+    {
+        for (qint64 j = 0; j <= nx; j++)
+        {
+            for (qint64 i = 0; i <= nx; i++)
+            {
+                double aPoint[3] = {0.01 * i, 0.01 * j, 0.01 * layer};
+                if (isBinary)
+                {
+                    appendBinary(fileBytes, aPoint, sizeof(aPoint));
+                    continue;
+                }
+                fileBytes->append("\n(");
+                appendScalar(fileBytes, aPoint[0]);
+                fileBytes->append(' ');
+                appendScalar(fileBytes, aPoint[1]);
+                fileBytes->append(' ');
+                appendScalar(fileBytes, aPoint[2]);
+                fileBytes->append(')');
+            }
+        }
+    }
+    fileBytes->append(isBinary ? ")\n" : "\n)\n");
+
+    fileBytes = &newCase->faces;
+    *fileBytes = QByteArray();
+    if (isBinary)
+    {
+        appendHeader(fileBytes, format, "faceCompactList", "faces");
+        appendLabel(fileBytes, newCase->faceCount + 1);
+        fileBytes->append("\n(");
+        for (qint64 ind = 0; ind <= newCase->faceCount; ind++)
+        {
+            qint32 anOffset = static_cast<qint32>(4 * ind);
+            appendBinary(fileBytes, &anOffset, sizeof(anOffset));
+        }
+        fileBytes->append(")\n\n");
+        appendLabel(fileBytes, 4 * newCase->faceCount);
+        fileBytes->append("\n(");
+        forEachFace(nx, [fileBytes](qint64 a, qint64 b, qint64 c, qint64 d, qint64)
+        {
+            qint32 aFace[4] = {static_cast<qint32>(a), static_cast<qint32>(b),
+                               static_cast<qint32>(c), static_cast<qint32>(d)};
+            appendBinary(fileBytes, aFace, sizeof(aFace));
+        });
+        fileBytes->append(")\n");
+    }
+    else
+    {
+        appendHeader(fileBytes, format, "faceList", "faces");
+        appendLabel(fileBytes, newCase->faceCount);
+        fileBytes->append("\n(\n");
+        forEachFace(nx, [fileBytes](qint64 a, qint64 b, qint64 c, qint64 d, qint64)
+        {
+            fileBytes->append("4(");
+            appendLabel(fileBytes, a);
+            fileBytes->append(' ');
+            appendLabel(fileBytes, b);
+            fileBytes->append(' ');
+            appendLabel(fileBytes, c);
+            fileBytes->append(' ');
+            appendLabel(fileBytes, d);
+            fileBytes->append(")\n");
+        });
+        fileBytes->append(")\n");
+    }
+
+    fileBytes = &newCase->owner;
+    *fileBytes = QByteArray();
+    appendHeader(fileBytes, format, "labelList", "owner");
+    appendLabel(fileBytes, newCase->faceCount);
+    fileBytes->append("\n(");
+    forEachFace(nx, [fileBytes, isBinary](qint64, qint64, qint64, qint64, qint64 owner)
+    {
+        if (isBinary)
+        {
+            qint32 anOwner = static_cast<qint32>(owner);
+            appendBinary(fileBytes, &anOwner, sizeof(anOwner));
+            return;
+        }
+        fileBytes->append('\n');
+        appendLabel(fileBytes, owner);
+    });
+    fileBytes->append(isBinary ? ")\n" : "\n)\n");
+
+    //Fields are smooth functions of the cell index, written as OpenFOAM writes them
+    for (int component = 1; component <= 3; component += 2)
+    {
+        bool isVector = (component == 3);
+        fileBytes = isVector ? &newCase->vectorField : &newCase->scalarField;
+        *fileBytes = QByteArray();
+        appendHeader(fileBytes, format, isVector ? "volVectorField" : "volScalarField", isVector ? "U" : "p");
+        fileBytes->append(isVector ? "dimensions      [0 1 -1 0 0 0 0];\n\n" : "dimensions      [0 2 -2 0 0 0 0];\n\n");
+        fileBytes->append(isVector ? "internalField   nonuniform List<vector> \n" : "internalField   nonuniform List<scalar> \n");
+        appendLabel(fileBytes, newCase->cellCount);
+        fileBytes->append("\n(");
+        for (qint64 cell = 0; cell < newCase->cellCount; cell++)
+        {
+            double aValue[3] = {std::sin(0.001 * cell), std::cos(0.001 * cell), 0.0};
+            if (isBinary)
+            {
+                appendBinary(fileBytes, aValue, component * static_cast<int>(sizeof(double)));
+                continue;
+            }
+            fileBytes->append('\n');
+            if (!isVector)
+            {
+                appendScalar(fileBytes, aValue[0]);
+                continue;
+            }
+            fileBytes->append('(');
+            appendScalar(fileBytes, aValue[0]);
+            fileBytes->append(' ');
+            appendScalar(fileBytes, aValue[1]);
+            fileBytes->append(' ');
+            appendScalar(fileBytes, aValue[2]);
+            fileBytes->append(')');
+        }
+        fileBytes->append(isBinary ? ")\n" : "\n)\n");
+        fileBytes->append(";\n\nboundaryField\n{\n    frontAndBack\n    {\n        type            empty;\n    }\n"
+                          "    walls\n    {\n        type            zeroGradient;\n    }\n}\n");
+    }
+}
+
+QByteArray SynthCaseMaker::gzipBytes(const QByteArray &rawBytes)
+{
+    z_stream zipStream;
+    memset(&zipStream, 0, sizeof(zipStream));
+    //Note: 16 added to the window bits gives a gzip header
+    if (deflateInit2(&zipStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return QByteArray();
+    }
+
+    QByteArray ret;
+    ret.resize(static_cast<int>(deflateBound(&zipStream, static_cast<uLong>(rawBytes.size()))));
+    zipStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(rawBytes.constData()));
+    zipStream.avail_in = static_cast<uInt>(rawBytes.size());
+    zipStream.next_out = reinterpret_cast<Bytef *>(ret.data());
+    zipStream.avail_out = static_cast<uInt>(ret.size());
+
+    int resultVal = deflate(&zipStream, Z_FINISH);
+    ret.resize(static_cast<int>(zipStream.total_out));
+    deflateEnd(&zipStream);
+
+    if (resultVal != Z_STREAM_END) return QByteArray();
+    return ret;
+}
+
+qint64 SynthCaseMaker::getGridWidth(qint64 targetFaces)
+{
+    qint64 nx = static_cast<qint64>(std::sqrt(static_cast<double>(targetFaces) / 4.0));
+    if (nx < 1) nx = 1;
+    return nx;
+}
+
+void SynthCaseMaker::appendHeader(QByteArray * fileBytes, SynthFormat format, const char * className, const char * objectName)
+{
+    fileBytes->append("FoamFile\n{\n    version     2.0;\n");
+    if (format == SynthFormat::BINARY)
+    {
+        fileBytes->append("    format      binary;\n    arch        \"LSB;label=32;scalar=64\";\n");
+    }
+    else
+    {
+        fileBytes->append("    format      ascii;\n");
+    }
+    fileBytes->append("    class       ").append(className).append(";\n");
+    fileBytes->append("    object      ").append(objectName).append(";\n}\n");
+    fileBytes->append("// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * //\n\n");
+}
+
+void SynthCaseMaker::appendLabel(QByteArray * fileBytes, qint64 value)
+{
+    char digitBuff[24];
+    int digitPos = sizeof(digitBuff);
+    bool isNegative = (value < 0);
+    quint64 remaining = isNegative ? static_cast<quint64>(-value) : static_cast<quint64>(value);
+    do
+    {
+        digitBuff[--digitPos] = static_cast<char>('0' + (remaining % 10));
+        remaining /= 10;
+    } while (remaining != 0);
+    if (isNegative) digitBuff[--digitPos] = '-';
+    fileBytes->append(digitBuff + digitPos, static_cast<int>(sizeof(digitBuff)) - digitPos);
+}
+
+void SynthCaseMaker::appendScalar(QByteArray * fileBytes, double value)
+{
+    //OpenFOAM's default writePrecision is 6
+    char numBuff[32];
+    int numLength = snprintf(numBuff, sizeof(numBuff), "%.6g", value);
+    fileBytes->append(numBuff, numLength);
+}
+
+void SynthCaseMaker::appendBinary(QByteArray * fileBytes, const void * value, int length)
+{
+    fileBytes->append(static_cast<const char *>(value), length);
+}
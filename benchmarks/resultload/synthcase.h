@@ -0,0 +1,82 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef SYNTHCASE_H
+#define SYNTHCASE_H
+
+#include <QByteArray>
+
+//A synthetic OpenFOAM case, one cell thick like the 2D cases, with about the requested number of faces.
+//Binary cases use faceCompactList, as OpenFOAM writes for binary faces files.
+
+enum class SynthFormat
+{
+    ASCII,
+    BINARY
+};
+
+struct SynthCase
+{
+    QByteArray points;
+    QByteArray faces;
+    QByteArray owner;
+    QByteArray scalarField;
+    QByteArray vectorField;
+
+    qint64 faceCount = 0;
+    qint64 cellCount = 0;
+};
+
+class SynthCaseMaker
+{
+public:
+    //Size of the largest file (faces), to skip cases which cannot fit in a QByteArray
+    static qint64 estimateFaceFileBytes(qint64 targetFaces, SynthFormat format);
+
+    static void makeCase(qint64 targetFaces, SynthFormat format, SynthCase * newCase);
+
+    //Compresses as gzip, as the files are stored on the server
+    static QByteArray gzipBytes(const QByteArray &rawBytes);
+
+private:
+    static qint64 getGridWidth(qint64 targetFaces);
+
+    static void appendHeader(QByteArray * fileBytes, SynthFormat format, const char * className, const char * objectName);
+    static void appendLabel(QByteArray * fileBytes, qint64 value);
+    static void appendScalar(QByteArray * fileBytes, double value);
+    static void appendBinary(QByteArray * fileBytes, const void * value, int length);
+};
+
+#endif // SYNTHCASE_H
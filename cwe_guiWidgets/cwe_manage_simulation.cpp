@@ -37,6 +37,7 @@
 
 #include "CFDanalysis/cweanalysistype.h"
 #include "CFDanalysis/cwecaseinstance.h"
+#include "CFDanalysis/cweresultinstance.h"
 
 #include "popupWindows/create_case_popup.h"
 #include "popupWindows/duplicate_case_popup.h"
@@ -235,6 +236,15 @@ void CWE_manage_simulation::on_pb_viewResults_clicked()
     theMainWindow->switchToResultsTab();
 }
 
+void CWE_manage_simulation::on_pb_viewLocalResults_clicked()
+{
+    //Note: This needs no connection, so it is also how results are viewed in offline mode
+    QString stageFolder = QFileDialog::getExistingDirectory(this, "Select Downloaded Case Folder:");
+    if (stageFolder.isEmpty()) return;
+
+    cweResultInstance::showLocalResult(stageFolder, this);
+}
+
 void CWE_manage_simulation::clearSelectView()
 {
     ui->label_caseTypeTag->setVisible(false);
@@ -68,6 +68,7 @@ private slots:
     void duplicate_case_clicked();
     void on_pb_viewParameters_clicked();
     void on_pb_viewResults_clicked();
+    void on_pb_viewLocalResults_clicked();
 
 private:
     void clearSelectView();
@@ -49,8 +49,11 @@
 #include "CFDanalysis/cwejobaccountant.h"
 
 #include "mainWindow/cwe_mainwindow.h"
+#include "visualUtils/cfdresultcache.h"
 #include "cwe_globals.h"
 
+#include <cstdlib>
+
 CWE_InterfaceDriver::CWE_InterfaceDriver(int argc, char *argv[], QObject *parent) : AgaveSetupDriver(argc, argv, parent)
 {
     qRegisterMetaType<CaseState>("CaseState");
@@ -97,6 +100,11 @@ CWE_InterfaceDriver::CWE_InterfaceDriver(int argc, char *argv[], QObject *parent
         {
             useAlternateApps = true;
         }
+        //Ex: resultCacheMB=4096, 0 turns the result cache off
+        if (strncmp(argv[i],"resultCacheMB=",14) == 0)
+        {
+            CFDresultCache::setMaxBytes(atoll(argv[i] + 14) * 1024 * 1024);
+        }
     }
 }
 
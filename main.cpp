@@ -38,14 +38,38 @@
 #include <QSslSocket>
 #include <QtGlobal>
 #include <QStringList>
+#include <QFileInfo>
+
+#include <cstring>
 
 #include "remotedatainterface.h"
+#include "decompresswrapper.h"
 
 #include "cwe_interfacedriver.h"
 #include "cwe_globals.h"
 
 int main(int argc, char *argv[])
 {
+    //Utility mode: "reblockGz <files or folders>" rewrites .gz results as BGZF, which is read in parallel
+    if ((argc > 1) && (strcmp(argv[1], "reblockGz") == 0))
+    {
+        int failCount = 0;
+        for (int i = 2; i < argc; i++)
+        {
+            QString targetName = QString::fromLocal8Bit(argv[i]);
+            if (QFileInfo(targetName).isDir())
+            {
+                qInfo("Re-blocked %d files in: %s", DeCompressWrapper::reblockFolder(targetName), qPrintable(targetName));
+            }
+            else if (!DeCompressWrapper::reblockFileOnDisk(targetName))
+            {
+                qWarning("Unable to re-block file: %s", qPrintable(targetName));
+                failCount++;
+            }
+        }
+        return (failCount == 0) ? 0 : 1;
+    }
+
     QApplication mainRunLoop(argc, argv);
 
     mainRunLoop.setWindowIcon(QIcon(":/icons/NHERI-CWE-Icon.icns"));
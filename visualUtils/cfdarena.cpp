@@ -0,0 +1,88 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdarena.h"
+
+CFDarena::CFDarena(size_t blockSize)
+{
+    myBlockSize = blockSize;
+}
+
+void * CFDarena::allocate(size_t byteCount, size_t alignment)
+{
+    if (byteCount == 0) byteCount = 1;
+
+    size_t padding = (alignment - (reinterpret_cast<quintptr>(nowPos) % alignment)) % alignment;
+    if ((nowPos == nullptr) || (static_cast<size_t>(blockEnd - nowPos) < byteCount + padding))
+    {
+        addBlock(byteCount + alignment);
+        padding = (alignment - (reinterpret_cast<quintptr>(nowPos) % alignment)) % alignment;
+    }
+
+    char * ret = nowPos + padding;
+    nowPos = ret + byteCount;
+    bytesUsed += byteCount + padding;
+    return ret;
+}
+
+void CFDarena::reserve(size_t byteCount)
+{
+    //For callers who know roughly how much they need, so it comes in one block
+    if ((nowPos != nullptr) && (static_cast<size_t>(blockEnd - nowPos) >= byteCount)) return;
+    addBlock(byteCount);
+}
+
+void CFDarena::reset()
+{
+    blockList.clear();
+    nowPos = nullptr;
+    blockEnd = nullptr;
+    bytesUsed = 0;
+}
+
+size_t CFDarena::getBytesUsed() const
+{
+    return bytesUsed;
+}
+
+void CFDarena::addBlock(size_t minSize)
+{
+    size_t newSize = myBlockSize;
+    if (newSize < minSize) newSize = minSize;
+
+    blockList.emplace_back(new char[newSize]);
+    nowPos = blockList.back().get();
+    blockEnd = nowPos + newSize;
+}
@@ -0,0 +1,84 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDARENA_H
+#define CFDARENA_H
+
+#include <QtGlobal>
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+//Bump allocator: memory is handed out in order from large blocks,
+//and everything is released at once by reset() or by deleting the arena.
+//Destructors are never run, so only trivially destructible types may be placed here.
+
+class CFDarena
+{
+public:
+    explicit CFDarena(size_t blockSize = 64 * 1024);
+
+    void * allocate(size_t byteCount, size_t alignment);
+    void reserve(size_t byteCount);
+    void reset();
+
+    size_t getBytesUsed() const;
+
+    template <typename T> T * allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        T * ret = static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+        for (size_t ind = 0; ind < count; ind++)
+        {
+            new (ret + ind) T();
+        }
+        return ret;
+    }
+
+private:
+    Q_DISABLE_COPY(CFDarena)
+
+    void addBlock(size_t minSize);
+
+    std::vector<std::unique_ptr<char[]>> blockList;
+    char * nowPos = nullptr;
+    char * blockEnd = nullptr;
+    size_t myBlockSize;
+    size_t bytesUsed = 0;
+};
+
+#endif // CFDARENA_H
@@ -0,0 +1,321 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdcodec.h"
+#include "cfdlz4frame.h"
+
+#include <climits>
+#include <cstring>
+
+#include <zstd.h>
+
+//Largest output which a QByteArray can hold, with room for its header
+static const qint64 MAX_OUTPUT_LEN = INT_MAX - 64;
+
+static bool hasMagic(const QByteArray &encodedData, const char * magicBytes, int magicLength)
+{
+    if (encodedData.size() < magicLength) return false;
+    return (memcmp(encodedData.constData(), magicBytes, static_cast<size_t>(magicLength)) == 0);
+}
+
+//Collects the output of decodeToSink, for decodeAll
+class CFDcodecCollector : public DeCompressSink
+{
+public:
+    explicit CFDcodecCollector(qint64 sizeHint)
+    {
+        if ((sizeHint > 0) && (sizeHint <= MAX_OUTPUT_LEN)) output.reserve(static_cast<int>(sizeHint));
+    }
+
+    bool receiveChunk(const char * data, int length) override
+    {
+        if (output.size() + static_cast<qint64>(length) > MAX_OUTPUT_LEN) return false;
+        output.append(data, length);
+        return true;
+    }
+
+    QByteArray output;
+};
+
+QByteArray * CFDcodec::decodeAll(const QByteArray &encodedData) const
+{
+    CFDcodecCollector outputCollector(getSizeHint(encodedData));
+    if (!decodeToSink(encodedData, &outputCollector, DECOMPRESS_MIN_CHUNK_LEN)) return nullptr;
+
+    QByteArray * ret = new QByteArray();
+    ret->swap(outputCollector.output);
+    return ret;
+}
+
+qint64 CFDcodec::getSizeHint(const QByteArray &) const
+{
+    return 0;
+}
+
+QByteArray * CFDcodec::decodeAllIndexed(const QByteArray &encodedData, QByteArray *) const
+{
+    return decodeAll(encodedData);
+}
+
+bool CFDcodec::decodeToSinkIndexed(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength, QByteArray *) const
+{
+    return decodeToSink(encodedData, outputSink, chunkLength);
+}
+
+class CFDplainCodec : public CFDcodec
+{
+public:
+    QString getCodecName() const override { return "none"; }
+    QString getSuffix() const override { return ""; }
+    bool matchesData(const QByteArray &) const override { return true; }
+
+    QByteArray * decodeAll(const QByteArray &encodedData) const override
+    {
+        return new QByteArray(encodedData);
+    }
+
+    bool decodeToSink(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength) const override
+    {
+        for (int dataPos = 0; dataPos < encodedData.size(); dataPos += chunkLength)
+        {
+            int thisLength = qMin(chunkLength, encodedData.size() - dataPos);
+            if (!outputSink->receiveChunk(encodedData.constData() + dataPos, thisLength)) return false;
+        }
+        return true;
+    }
+
+    qint64 getSizeHint(const QByteArray &encodedData) const override { return encodedData.size(); }
+};
+
+class CFDgzipCodec : public CFDcodec
+{
+public:
+    QString getCodecName() const override { return "gzip"; }
+    QString getSuffix() const override { return ".gz"; }
+    bool matchesData(const QByteArray &encodedData) const override { return hasMagic(encodedData, "\x1f\x8b", 2); }
+
+    QByteArray * decodeAll(const QByteArray &encodedData) const override
+    {
+        //Note: the copy is shared, not a deep copy
+        QByteArray inputData = encodedData;
+        DeCompressWrapper inflater(&inputData);
+        return inflater.getDecompressedFile();
+    }
+
+    bool decodeToSink(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength) const override
+    {
+        QByteArray inputData = encodedData;
+        DeCompressWrapper inflater(&inputData);
+        return inflater.inflateToSink(outputSink, chunkLength);
+    }
+
+    qint64 getSizeHint(const QByteArray &encodedData) const override
+    {
+        return DeCompressWrapper::getSizeHint(encodedData);
+    }
+
+    QByteArray * decodeAllIndexed(const QByteArray &encodedData, QByteArray * blockIndex) const override
+    {
+        QByteArray inputData = encodedData;
+        DeCompressWrapper inflater(&inputData);
+        bool hadIndex = useBlockIndex(&inflater, blockIndex);
+        QByteArray * ret = inflater.getDecompressedFile();
+        if ((ret != nullptr) && !hadIndex) keepBlockIndex(inflater, blockIndex);
+        return ret;
+    }
+
+    bool decodeToSinkIndexed(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength, QByteArray * blockIndex) const override
+    {
+        QByteArray inputData = encodedData;
+        DeCompressWrapper inflater(&inputData);
+        bool hadIndex = useBlockIndex(&inflater, blockIndex);
+        if (!inflater.inflateToSink(outputSink, chunkLength)) return false;
+        if (!hadIndex) keepBlockIndex(inflater, blockIndex);
+        return true;
+    }
+
+private:
+    static bool useBlockIndex(DeCompressWrapper * inflater, QByteArray * blockIndex)
+    {
+        //An index which does not fit the data, ex: of an older file, is found again
+        if (blockIndex->isEmpty()) return false;
+        if (inflater->setBlockIndex(*blockIndex)) return true;
+        blockIndex->clear();
+        return false;
+    }
+
+    static void keepBlockIndex(const DeCompressWrapper &inflater, QByteArray * blockIndex)
+    {
+        if (inflater.getBlockIndex().empty()) return;
+        *blockIndex = DeCompressWrapper::blockIndexToGzi(inflater.getBlockIndex());
+    }
+};
+
+class CFDzstdCodec : public CFDcodec
+{
+public:
+    QString getCodecName() const override { return "zstd"; }
+    QString getSuffix() const override { return ".zst"; }
+    bool matchesData(const QByteArray &encodedData) const override { return hasMagic(encodedData, "\x28\xb5\x2f\xfd", 4); }
+
+    bool decodeToSink(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength) const override
+    {
+        ZSTD_DCtx * decodeContext = ZSTD_createDCtx();
+        if (decodeContext == nullptr) return false;
+
+        QByteArray outputChunk;
+        outputChunk.resize(chunkLength);
+        ZSTD_inBuffer inputBuffer = {encodedData.constData(), static_cast<size_t>(encodedData.size()), 0};
+
+        //As with gzip, several frames one after another are read as one file
+        bool decodeOK = true;
+        bool frameEnded = false;
+        bool outputFull = true;
+        while (decodeOK && ((inputBuffer.pos < inputBuffer.size) || outputFull))
+        {
+            ZSTD_outBuffer outputBuffer = {outputChunk.data(), static_cast<size_t>(chunkLength), 0};
+            size_t resultVal = ZSTD_decompressStream(decodeContext, &outputBuffer, &inputBuffer);
+            if (ZSTD_isError(resultVal))
+            {
+                decodeOK = false;
+                break;
+            }
+
+            frameEnded = (resultVal == 0);
+            outputFull = (outputBuffer.pos == outputBuffer.size);
+            if (outputBuffer.pos > 0)
+            {
+                decodeOK = outputSink->receiveChunk(outputChunk.constData(), static_cast<int>(outputBuffer.pos));
+            }
+        }
+
+        ZSTD_freeDCtx(decodeContext);
+        return decodeOK && frameEnded;
+    }
+
+    qint64 getSizeHint(const QByteArray &encodedData) const override
+    {
+        //Note: this is the size of the first frame only, if it was recorded
+        unsigned long long decodedSize = ZSTD_getFrameContentSize(encodedData.constData(), static_cast<size_t>(encodedData.size()));
+        if (decodedSize >= ZSTD_CONTENTSIZE_ERROR) return 0;
+        return static_cast<qint64>(decodedSize);
+    }
+};
+
+class CFDlz4Codec : public CFDcodec
+{
+public:
+    QString getCodecName() const override { return "lz4"; }
+    QString getSuffix() const override { return ".lz4"; }
+    bool matchesData(const QByteArray &encodedData) const override { return hasMagic(encodedData, "\x04\x22\x4d\x18", 4); }
+
+    bool decodeToSink(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength) const override
+    {
+        return CFDlz4Frame::decodeToSink(encodedData, outputSink, chunkLength);
+    }
+
+    qint64 getSizeHint(const QByteArray &encodedData) const override
+    {
+        return CFDlz4Frame::getContentSize(encodedData);
+    }
+};
+
+const QList<const CFDcodec *> &CFDcodecList::getCodecs()
+{
+    static CFDzstdCodec zstdCodec;
+    static CFDlz4Codec lz4Codec;
+    static CFDgzipCodec gzipCodec;
+    static CFDplainCodec plainCodec;
+
+    //Faster to decode first
+    static const QList<const CFDcodec *> codecList = {
+        &zstdCodec,
+        &lz4Codec,
+        &gzipCodec,
+        &plainCodec
+    };
+    return codecList;
+}
+
+const CFDcodec * CFDcodecList::getCodecForData(const QByteArray &encodedData)
+{
+    for (const CFDcodec * aCodec : getCodecs())
+    {
+        if (aCodec->matchesData(encodedData)) return aCodec;
+    }
+    return getCodecs().last();
+}
+
+const CFDcodec * CFDcodecList::getCodecForFile(const QString &fileName, const QByteArray &encodedData)
+{
+    for (const CFDcodec * aCodec : getCodecs())
+    {
+        if (aCodec->getSuffix().isEmpty()) continue;
+        if (fileName.endsWith(aCodec->getSuffix()) && aCodec->matchesData(encodedData)) return aCodec;
+    }
+    return getCodecForData(encodedData);
+}
+
+QString CFDcodecList::stripSuffix(const QString &fileName)
+{
+    for (const CFDcodec * aCodec : getCodecs())
+    {
+        if (aCodec->getSuffix().isEmpty()) continue;
+        if (fileName.endsWith(aCodec->getSuffix()))
+        {
+            return fileName.left(fileName.size() - aCodec->getSuffix().size());
+        }
+    }
+    return fileName;
+}
+
+QStringList CFDcodecList::getFileVariants(const QString &fileName)
+{
+    QString baseName = stripSuffix(fileName);
+
+    QStringList ret;
+    ret.append(fileName);
+    for (const CFDcodec * aCodec : getCodecs())
+    {
+        QString aVariant = baseName + aCodec->getSuffix();
+        if (!ret.contains(aVariant)) ret.append(aVariant);
+    }
+    return ret;
+}
+
+QByteArray * CFDcodecList::decodeFile(const QString &fileName, const QByteArray &encodedData)
+{
+    return getCodecForFile(fileName, encodedData)->decodeAll(encodedData);
+}
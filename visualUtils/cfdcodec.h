@@ -0,0 +1,90 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDCODEC_H
+#define CFDCODEC_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "decompresswrapper.h"
+
+//Result files may be stored compressed in several ways, each known by its file suffix
+//and by the magic bytes at its start. All codecs are built in: zstd from the decoder
+//in thirdParty/zstd, and lz4 with CFDlz4Frame, so no library is needed for either.
+
+class CFDcodec
+{
+public:
+    virtual ~CFDcodec() {}
+
+    //Ex: "zstd", and ".zst"
+    virtual QString getCodecName() const = 0;
+    virtual QString getSuffix() const = 0;
+    virtual bool matchesData(const QByteArray &encodedData) const = 0;
+
+    //Returns nullptr if the data could not be decoded
+    virtual QByteArray * decodeAll(const QByteArray &encodedData) const;
+    //Gives the output to the sink in pieces of at most chunkLength
+    virtual bool decodeToSink(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength) const = 0;
+    //Decoded size, if the format records it, else 0
+    virtual qint64 getSizeHint(const QByteArray &encodedData) const;
+
+    //As above, for codecs which can decode blocks in parallel given an index of them, ex: gzip.
+    //blockIndex is an index from an earlier read, or empty. If it is empty and the data has
+    //blocks, it is filled in, so that it can be kept for the next read. Other codecs ignore it.
+    virtual QByteArray * decodeAllIndexed(const QByteArray &encodedData, QByteArray * blockIndex) const;
+    virtual bool decodeToSinkIndexed(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength, QByteArray * blockIndex) const;
+};
+
+class CFDcodecList
+{
+public:
+    //Compressed codecs, in the order they are preferred, then "none", which reads any data as is
+    static const QList<const CFDcodec *> &getCodecs();
+    static const CFDcodec * getCodecForData(const QByteArray &encodedData);
+    //The codec of the file suffix, if the data matches it, else found from the data
+    static const CFDcodec * getCodecForFile(const QString &fileName, const QByteArray &encodedData);
+
+    //Ex: "p.zst" and "p" both give "p"
+    static QString stripSuffix(const QString &fileName);
+    //The given name first, then each other stored variant of it, with the plain file last
+    static QStringList getFileVariants(const QString &fileName);
+
+    static QByteArray * decodeFile(const QString &fileName, const QByteArray &encodedData);
+};
+
+#endif // CFDCODEC_H
@@ -0,0 +1,154 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdfielddisplay.h"
+
+#include "cfdglcanvas.h"
+#include "cfdhistogramlegend.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QDoubleSpinBox>
+
+CFDfieldDisplay::CFDfieldDisplay(CFDglCanvas * theCanvas, QWidget *parent) : QWidget(parent)
+{
+    myCanvas = theCanvas;
+
+    QVBoxLayout * displayLayout = new QVBoxLayout(this);
+    displayLayout->setContentsMargins(0, 0, 0, 0);
+    displayLayout->addWidget(myCanvas, 1);
+    //Note: A canvas loaded as a hidden child of a window must be shown again
+    myCanvas->show();
+
+    myLegend = new CFDhistogramLegend(myCanvas, this);
+    displayLayout->addWidget(myLegend);
+
+    //Note: In the same order as CFDcolorMap
+    colorMapBox = new QComboBox(this);
+    colorMapBox->addItem("Blue-Red");
+    colorMapBox->addItem("Rainbow");
+    colorMapBox->addItem("Grayscale");
+
+    logScaleBox = new QCheckBox("Log Scale", this);
+    lowRangeEdit = new QLineEdit(this);
+    highRangeEdit = new QLineEdit(this);
+    QPushButton * resetButton = new QPushButton("Reset Range", this);
+
+    clipPercentBox = new QDoubleSpinBox(this);
+    clipPercentBox->setRange(0.0, 25.0);
+    clipPercentBox->setSingleStep(0.1);
+    clipPercentBox->setSuffix(" %");
+    clipPercentBox->setValue(myCanvas->getClipPercent());
+
+    QHBoxLayout * controlLayout = new QHBoxLayout();
+    controlLayout->addWidget(new QLabel("Colors:", this));
+    controlLayout->addWidget(colorMapBox);
+    controlLayout->addWidget(logScaleBox);
+    controlLayout->addWidget(new QLabel("Range:", this));
+    controlLayout->addWidget(lowRangeEdit);
+    controlLayout->addWidget(new QLabel("to", this));
+    controlLayout->addWidget(highRangeEdit);
+    controlLayout->addWidget(resetButton);
+    controlLayout->addWidget(new QLabel("Clip:", this));
+    controlLayout->addWidget(clipPercentBox);
+    controlLayout->addStretch();
+    displayLayout->addLayout(controlLayout);
+
+    QObject::connect(colorMapBox, SIGNAL(currentIndexChanged(int)), this, SLOT(colorMapSelected(int)));
+    QObject::connect(logScaleBox, SIGNAL(toggled(bool)), this, SLOT(logScaleToggled(bool)));
+    QObject::connect(lowRangeEdit, SIGNAL(editingFinished()), this, SLOT(rangeEdited()));
+    QObject::connect(highRangeEdit, SIGNAL(editingFinished()), this, SLOT(rangeEdited()));
+    QObject::connect(resetButton, SIGNAL(clicked()), this, SLOT(resetButtonClicked()));
+    QObject::connect(clipPercentBox, SIGNAL(valueChanged(double)), this, SLOT(clipPercentChanged(double)));
+
+    showColorRange();
+}
+
+CFDfieldDisplay::~CFDfieldDisplay() {}
+
+void CFDfieldDisplay::colorMapSelected(int mapIndex)
+{
+    myCanvas->setColorMap(static_cast<CFDcolorMap>(mapIndex));
+    myLegend->update();
+}
+
+void CFDfieldDisplay::logScaleToggled(bool useLog)
+{
+    myCanvas->setLogScale(useLog);
+    myLegend->update();
+}
+
+void CFDfieldDisplay::rangeEdited()
+{
+    bool lowOK = false;
+    bool highOK = false;
+    double newLow = lowRangeEdit->text().toDouble(&lowOK);
+    double newHigh = highRangeEdit->text().toDouble(&highOK);
+
+    //Invalid entries are put back to the range in use
+    if (!lowOK || !highOK || (newHigh <= newLow))
+    {
+        showColorRange();
+        return;
+    }
+
+    myCanvas->setColorRange(newLow, newHigh);
+    myLegend->update();
+}
+
+void CFDfieldDisplay::clipPercentChanged(double newPercent)
+{
+    myCanvas->setClipPercent(newPercent);
+    showColorRange();
+    myLegend->update();
+}
+
+void CFDfieldDisplay::resetButtonClicked()
+{
+    myCanvas->resetColorRange();
+    showColorRange();
+    myLegend->update();
+}
+
+void CFDfieldDisplay::showColorRange()
+{
+    lowRangeEdit->setText(QString::number(myCanvas->getColorRangeLow(), 'g', 6));
+    highRangeEdit->setText(QString::number(myCanvas->getColorRangeHigh(), 'g', 6));
+}
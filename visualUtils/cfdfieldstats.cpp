@@ -0,0 +1,221 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdfieldstats.h"
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <cmath>
+
+//Fields at least this long are counted in parallel
+const size_t PARALLEL_STATS_COUNT = 1024 * 1024;
+const size_t MIN_CHUNK_COUNT = 256 * 1024;
+
+struct CFDstatsChunk
+{
+    const double * startPos = nullptr;
+    const double * endPos = nullptr;
+
+    qint64 valueCount = 0;
+    double lowVal = 0.0;
+    double highVal = 0.0;
+    std::vector<qint64> binCounts;
+};
+
+template <typename ChunkFunction>
+static void runOnChunks(std::vector<CFDstatsChunk> &chunkList, ChunkFunction chunkFunction)
+{
+    if (chunkList.size() == 1)
+    {
+        chunkFunction(chunkList.front());
+        return;
+    }
+    QtConcurrent::blockingMap(chunkList, chunkFunction);
+}
+
+CFDfieldStats::CFDfieldStats() {}
+
+CFDfieldStats::CFDfieldStats(const std::vector<double> &values)
+{
+    if (values.empty()) return;
+
+    size_t chunkCount = 1;
+    if ((values.size() >= PARALLEL_STATS_COUNT) && (QThread::idealThreadCount() > 1))
+    {
+        chunkCount = qMin(static_cast<size_t>(QThread::idealThreadCount()) * 4, values.size() / MIN_CHUNK_COUNT);
+    }
+
+    std::vector<CFDstatsChunk> chunkList(chunkCount);
+    size_t chunkLength = values.size() / chunkCount;
+    for (size_t ind = 0; ind < chunkCount; ind++)
+    {
+        chunkList[ind].startPos = values.data() + ind * chunkLength;
+        chunkList[ind].endPos = (ind + 1 == chunkCount) ? (values.data() + values.size()) : (chunkList[ind].startPos + chunkLength);
+    }
+
+    runOnChunks(chunkList, [](CFDstatsChunk & aChunk)
+    {
+        for (const double * valuePos = aChunk.startPos; valuePos < aChunk.endPos; valuePos++)
+        {
+            double aValue = *valuePos;
+            if (!std::isfinite(aValue)) continue;
+
+            if ((aChunk.valueCount == 0) || (aValue < aChunk.lowVal)) aChunk.lowVal = aValue;
+            if ((aChunk.valueCount == 0) || (aValue > aChunk.highVal)) aChunk.highVal = aValue;
+            aChunk.valueCount++;
+        }
+    });
+
+    for (const CFDstatsChunk &aChunk : chunkList)
+    {
+        if (aChunk.valueCount == 0) continue;
+        if ((valueCount == 0) || (aChunk.lowVal < lowVal)) lowVal = aChunk.lowVal;
+        if ((valueCount == 0) || (aChunk.highVal > highVal)) highVal = aChunk.highVal;
+        valueCount += aChunk.valueCount;
+    }
+    if (valueCount == 0) return;
+
+    runOnChunks(chunkList, [this](CFDstatsChunk & aChunk)
+    {
+        aChunk.binCounts.assign(BIN_COUNT, 0);
+        for (const double * valuePos = aChunk.startPos; valuePos < aChunk.endPos; valuePos++)
+        {
+            if (!std::isfinite(*valuePos)) continue;
+            aChunk.binCounts[static_cast<size_t>(getBinIndex(*valuePos))]++;
+        }
+    });
+
+    binCounts.assign(BIN_COUNT, 0);
+    for (const CFDstatsChunk &aChunk : chunkList)
+    {
+        for (size_t ind = 0; ind < binCounts.size(); ind++)
+        {
+            binCounts[ind] += aChunk.binCounts[ind];
+        }
+    }
+}
+
+bool CFDfieldStats::isEmpty() const
+{
+    return (valueCount == 0);
+}
+
+qint64 CFDfieldStats::getCount() const
+{
+    return valueCount;
+}
+
+double CFDfieldStats::getMin() const
+{
+    return lowVal;
+}
+
+double CFDfieldStats::getMax() const
+{
+    return highVal;
+}
+
+const std::vector<qint64> &CFDfieldStats::getBins() const
+{
+    return binCounts;
+}
+
+double CFDfieldStats::getPercentile(double percent) const
+{
+    if (valueCount == 0) return 0.0;
+    if (percent <= 0.0) return lowVal;
+    if (percent >= 100.0) return highVal;
+
+    double targetCount = percent / 100.0 * static_cast<double>(valueCount);
+    double binWidth = (highVal - lowVal) / BIN_COUNT;
+    qint64 countBelow = 0;
+
+    for (int ind = 0; ind < BIN_COUNT; ind++)
+    {
+        qint64 binCount = binCounts[static_cast<size_t>(ind)];
+        if ((binCount > 0) && (static_cast<double>(countBelow + binCount) >= targetCount))
+        {
+            //Note: The values in a bin are taken to be evenly spread across it
+            double binFraction = (targetCount - static_cast<double>(countBelow)) / static_cast<double>(binCount);
+            return lowVal + binWidth * (ind + binFraction);
+        }
+        countBelow += binCount;
+    }
+    return highVal;
+}
+
+void CFDfieldStats::merge(const CFDfieldStats &otherStats)
+{
+    if (otherStats.isEmpty()) return;
+    if (isEmpty())
+    {
+        *this = otherStats;
+        return;
+    }
+
+    CFDfieldStats joinedStats;
+    joinedStats.valueCount = valueCount + otherStats.valueCount;
+    joinedStats.lowVal = qMin(lowVal, otherStats.lowVal);
+    joinedStats.highVal = qMax(highVal, otherStats.highVal);
+    joinedStats.binCounts.assign(BIN_COUNT, 0);
+
+    //Each bin's count is put in the joint bin holding its center
+    std::vector<const CFDfieldStats *> statsList = {this, &otherStats};
+    for (const CFDfieldStats * someStats : statsList)
+    {
+        double binWidth = (someStats->highVal - someStats->lowVal) / BIN_COUNT;
+        for (int ind = 0; ind < BIN_COUNT; ind++)
+        {
+            qint64 binCount = someStats->binCounts[static_cast<size_t>(ind)];
+            if (binCount == 0) continue;
+
+            double binCenter = someStats->lowVal + binWidth * (ind + 0.5);
+            joinedStats.binCounts[static_cast<size_t>(joinedStats.getBinIndex(binCenter))] += binCount;
+        }
+    }
+
+    *this = joinedStats;
+}
+
+int CFDfieldStats::getBinIndex(double aValue) const
+{
+    if (highVal <= lowVal) return 0;
+
+    int binIndex = static_cast<int>((aValue - lowVal) / (highVal - lowVal) * BIN_COUNT);
+    if (binIndex < 0) return 0;
+    if (binIndex >= BIN_COUNT) return BIN_COUNT - 1;
+    return binIndex;
+}
@@ -0,0 +1,81 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDFIELDSTATS_H
+#define CFDFIELDSTATS_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+//Statistics of the values of a field, found without sorting or copying the data:
+//one pass for the low and high, then one pass to fill a histogram of BIN_COUNT bins
+//between them. Both passes are split over several threads for large fields.
+//Percentiles are found from the histogram, so are within one bin width of exact.
+//Values which are not finite are not counted.
+
+//A canvas may be given the statistics of another field, ex: another time step,
+//so that both are colored alike
+
+class CFDfieldStats
+{
+public:
+    CFDfieldStats();
+    explicit CFDfieldStats(const std::vector<double> &values);
+
+    bool isEmpty() const;
+    qint64 getCount() const;
+    double getMin() const;
+    double getMax() const;
+    const std::vector<qint64> &getBins() const;
+
+    //The value below which the given percent of the values lie
+    double getPercentile(double percent) const;
+
+    //Adds the values counted in other statistics, the bins of both are spread over the joint range
+    void merge(const CFDfieldStats &otherStats);
+
+    static const int BIN_COUNT = 1024;
+
+private:
+    int getBinIndex(double aValue) const;
+
+    qint64 valueCount = 0;
+    double lowVal = 0.0;
+    double highVal = 0.0;
+    std::vector<qint64> binCounts;
+};
+
+#endif // CFDFIELDSTATS_H
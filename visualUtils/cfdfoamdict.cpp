@@ -0,0 +1,705 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdfoamdict.h"
+
+#include "cfdnumberparser.h"
+#include "cfdtoken.h"
+
+#include <cctype>
+#include <cstring>
+
+CFDfoamDict::CFDfoamDict(const QByteArray * rawInput)
+{
+    if (rawInput == nullptr) return;
+
+    myStart = rawInput->constData();
+    myPos = myStart;
+    myEnd = myStart + rawInput->size();
+}
+
+bool CFDfoamDict::readHeader()
+{
+    myFormat = CFDfoamFormat();
+    headerEnd = 0;
+    myPos = myStart;
+    if (myPos == nullptr) return readFailure("Unable to read file");
+
+    skipSpace();
+    const char * headerStart = myPos;
+    if (readWord() != "FoamFile")
+    {
+        //Files without a header are taken to be ASCII
+        myPos = headerStart;
+        headerEnd = headerStart - myStart;
+        return true;
+    }
+    if (!expectChar('{')) return readFailure("Unable to read file header");
+
+    while (true)
+    {
+        skipSpace();
+        if (myPos >= myEnd) return readFailure("Unable to read file header");
+        if (*myPos == '}')
+        {
+            myPos++;
+            headerEnd = myPos - myStart;
+            return true;
+        }
+        if ((*myPos == ';') || (*myPos == '(') || (*myPos == ')') || (*myPos == '{'))
+        {
+            myPos++;
+            continue;
+        }
+
+        QByteArray keyword = readWord();
+        skipSpace();
+        QByteArray value = readWord();
+
+        if (keyword == "format")
+        {
+            myFormat.isBinary = (value == "binary");
+        }
+        else if (keyword == "class")
+        {
+            myFormat.className = QByteArray(value.constData(), value.size());
+        }
+        else if (keyword == "arch")
+        {
+            readArch(value);
+        }
+    }
+}
+
+bool CFDfoamDict::readDict()
+{
+    myDimensions.clear();
+    internalField = CFDfieldEntry();
+    boundaryField.clear();
+
+    if (!readHeader()) return false;
+
+    while (true)
+    {
+        skipSpace();
+        if (myPos >= myEnd) return true;
+
+        char aLetter = *myPos;
+        if (aLetter == ';')
+        {
+            myPos++;
+            continue;
+        }
+        if ((aLetter == '(') || (aLetter == '{'))
+        {
+            if (!skipGroup()) return readFailure("Unable to read dictionary");
+            continue;
+        }
+        if ((aLetter == ')') || (aLetter == '}'))
+        {
+            return readFailure("Unable to read dictionary");
+        }
+
+        QByteArray keyword = readWord();
+        if (keyword.startsWith('#'))
+        {
+            //Directives such as #include are not followed
+            skipLine();
+            continue;
+        }
+
+        if (keyword == "dimensions")
+        {
+            if (!readDimensions()) return false;
+        }
+        else if (keyword == "internalField")
+        {
+            if (!readFieldValue(&internalField)) return false;
+        }
+        else if (keyword == "boundaryField")
+        {
+            if (!readBoundaryField()) return false;
+        }
+        else if (!skipEntry())
+        {
+            return false;
+        }
+    }
+}
+
+bool CFDfoamDict::readPatchList(std::vector<CFDmeshPatch> * patchList)
+{
+    //ex: N ( name { type wall; nFaces 10; startFace 5; } ... )
+    patchList->clear();
+    if (!readHeader()) return false;
+    if (myStart == nullptr) return readFailure("Unable to read boundary file");
+
+    //Note: the boundary file is small, and has no binary data even in binary cases
+    QByteArray boundaryText = QByteArray::fromRawData(myStart + headerEnd, static_cast<int>((myEnd - myStart) - headerEnd));
+    CFDtokenTree boundaryTree;
+    if (!boundaryTree.lexifyString(&boundaryText))
+    {
+        return readFailure("Unable to read boundary file");
+    }
+
+    CFDtoken * patchArray = boundaryTree.getRoot()->getLargestChildArray();
+    if (patchArray == nullptr)
+    {
+        return readFailure("Boundary file does not contain a patch list");
+    }
+
+    CFDtokenSpan patchTokens = patchArray->getChildList();
+    for (int ind = 0; ind + 1 < patchTokens.size(); ind += 2)
+    {
+        CFDtoken & nameToken = patchTokens[ind];
+        CFDtoken & dictToken = patchTokens[ind + 1];
+        if (dictToken.getType() != CFDtokenType::TREE_NODE)
+        {
+            return readFailure("Boundary file patch list is not readable");
+        }
+
+        CFDmeshPatch newPatch;
+        newPatch.patchName = nameToken.getStringVal();
+        if ((newPatch.patchName.size() >= 2) && newPatch.patchName.startsWith('"') && newPatch.patchName.endsWith('"'))
+        {
+            newPatch.patchName = newPatch.patchName.mid(1, newPatch.patchName.size() - 2);
+        }
+
+        //Entries run together as words, ex: nFaces 10;
+        CFDtokenSpan entryTokens = dictToken.getChildList();
+        for (int entryInd = 0; entryInd + 1 < entryTokens.size(); entryInd++)
+        {
+            QByteArray keyword = entryTokens[entryInd].getStringVal();
+            QByteArray value = entryTokens[entryInd + 1].getStringVal();
+            if (value.endsWith(';')) value.chop(1);
+
+            bool isInt = false;
+            int intValue = value.toInt(&isInt);
+
+            if (keyword == "type")
+            {
+                newPatch.patchType = value;
+            }
+            else if ((keyword == "nFaces") && isInt)
+            {
+                newPatch.nFaces = intValue;
+            }
+            else if ((keyword == "startFace") && isInt)
+            {
+                newPatch.startFace = intValue;
+            }
+        }
+
+        if ((newPatch.nFaces < 0) || (newPatch.startFace < 0))
+        {
+            return readFailure("Boundary file patch does not give its faces");
+        }
+        patchList->push_back(newPatch);
+    }
+
+    return true;
+}
+
+CFDfoamFormat CFDfoamDict::getFormat() const
+{
+    return myFormat;
+}
+
+qint64 CFDfoamDict::getHeaderEnd() const
+{
+    return headerEnd;
+}
+
+std::vector<double> CFDfoamDict::getDimensions() const
+{
+    return myDimensions;
+}
+
+CFDfieldEntry CFDfoamDict::getInternalField() const
+{
+    return internalField;
+}
+
+std::vector<CFDpatchField> CFDfoamDict::getBoundaryField() const
+{
+    return boundaryField;
+}
+
+QString CFDfoamDict::getReadError() const
+{
+    return readError;
+}
+
+void CFDfoamDict::readArch(QByteArray archString)
+{
+    for (QByteArray anEntry : archString.split(';'))
+    {
+        anEntry = anEntry.trimmed();
+        if (anEntry == "LSB") myFormat.isLittleEndian = true;
+        else if (anEntry == "MSB") myFormat.isLittleEndian = false;
+        else if (anEntry.startsWith("label="))
+        {
+            myFormat.labelSize = anEntry.mid(6).toInt() / 8;
+        }
+        else if (anEntry.startsWith("scalar="))
+        {
+            myFormat.scalarSize = anEntry.mid(7).toInt() / 8;
+        }
+    }
+}
+
+bool CFDfoamDict::readDimensions()
+{
+    //ex: dimensions [0 2 -2 0 0 0 0];
+    skipSpace();
+    if ((myPos >= myEnd) || (*myPos != '[')) return skipEntry();
+
+    const void * closePos = memchr(myPos, ']', static_cast<size_t>(myEnd - myPos));
+    if (closePos == nullptr) return readFailure("Unable to read dimensions");
+    const char * dimEnd = static_cast<const char *>(closePos);
+
+    const char * dimPos = myPos + 1;
+    while (true)
+    {
+        dimPos = CFDnumberParser::skipSpace(dimPos, dimEnd);
+        if (dimPos >= dimEnd) break;
+
+        const char * wordEnd = CFDnumberParser::findTokenEnd(dimPos, dimEnd);
+        double aValue;
+        if (!CFDnumberParser::parseDouble(dimPos, wordEnd, &aValue))
+        {
+            //Named units, ex: [kg m^-3], are not read
+            myDimensions.clear();
+            break;
+        }
+        myDimensions.push_back(aValue);
+        dimPos = wordEnd;
+    }
+
+    myPos = dimEnd + 1;
+    return skipEntry();
+}
+
+bool CFDfoamDict::readFieldValue(CFDfieldEntry * entry)
+{
+    *entry = CFDfieldEntry();
+    skipSpace();
+    QByteArray fieldKind = readWord();
+
+    if (fieldKind == "uniform")
+    {
+        //ex: uniform 0; or uniform (1 0 0);
+        entry->kind = CFDfieldKind::UNIFORM;
+        skipSpace();
+        bool inParens = ((myPos < myEnd) && (*myPos == '('));
+        if (inParens) myPos++;
+
+        while (true)
+        {
+            skipSpace();
+            if (myPos >= myEnd) break;
+            if (inParens && (*myPos == ')'))
+            {
+                myPos++;
+                break;
+            }
+
+            const char * wordEnd = CFDnumberParser::findTokenEnd(myPos, myEnd);
+            double aValue;
+            if (!CFDnumberParser::parseDouble(myPos, wordEnd, &aValue)) break;
+            entry->uniformValue.push_back(aValue);
+            myPos = wordEnd;
+
+            if (!inParens) break;
+        }
+        return skipEntry();
+    }
+
+    if (fieldKind == "nonuniform")
+    {
+        //ex: nonuniform List<scalar> N ( ... );
+        entry->kind = CFDfieldKind::NONUNIFORM;
+        skipSpace();
+        QByteArray listType = readWord();
+        entry->listType = QByteArray(listType.constData(), listType.size());
+
+        if (!readListRange(entry)) return false;
+        return skipEntry();
+    }
+
+    //Other values, ex: $internalField, are not followed
+    return skipEntry();
+}
+
+bool CFDfoamDict::readListRange(CFDfieldEntry * entry)
+{
+    skipSpace();
+    entry->listStart = myPos - myStart;
+
+    if ((myPos < myEnd) && (*myPos != '(') && (*myPos != '{'))
+    {
+        const char * wordEnd = CFDnumberParser::findTokenEnd(myPos, myEnd);
+        if (!CFDnumberParser::parseLabel(myPos, wordEnd, &entry->listSize) || (entry->listSize < 0))
+        {
+            return readFailure("Unable to read list size");
+        }
+        myPos = wordEnd;
+        skipSpace();
+    }
+
+    if (myPos >= myEnd) return readFailure("List is not closed");
+    char openChar = *myPos;
+    if ((openChar != '(') && (openChar != '{'))
+    {
+        return readFailure("Unable to locate list data");
+    }
+    myPos++;
+
+    //Lists of identical entries can be written as N{value}
+    char closeChar = (openChar == '(') ? ')' : '}';
+    int componentCount = getComponentCount(entry->listType);
+
+    if (myFormat.isBinary)
+    {
+        //Binary data is skipped by its size, as it may hold any byte
+        if ((componentCount < 1) || (entry->listSize < 0))
+        {
+            return readFailure("Unable to skip binary list");
+        }
+
+        qint64 valueSize = (entry->listType == "List<label>") ? myFormat.labelSize : myFormat.scalarSize;
+        qint64 entryCount = (openChar == '(') ? entry->listSize : 1;
+        qint64 byteCount = entryCount * componentCount * valueSize;
+        if ((myEnd - myPos) < byteCount) return readFailure("List is not closed");
+
+        myPos += byteCount;
+        if (!expectChar(closeChar)) return readFailure("List is not closed");
+    }
+    else if (!skipAsciiList(closeChar, (componentCount == 1) || (openChar == '{')))
+    {
+        return readFailure("List is not closed");
+    }
+
+    entry->listEnd = myPos - myStart;
+    return true;
+}
+
+bool CFDfoamDict::readBoundaryField()
+{
+    //ex: boundaryField { wall { type fixedValue; value uniform 0; } ... }
+    boundaryField.clear();
+    if (!expectChar('{')) return readFailure("Unable to read boundaryField");
+
+    while (true)
+    {
+        skipSpace();
+        if (myPos >= myEnd) return readFailure("boundaryField is not closed");
+
+        char aLetter = *myPos;
+        if (aLetter == '}')
+        {
+            myPos++;
+            return true;
+        }
+        if (aLetter == ';')
+        {
+            myPos++;
+            continue;
+        }
+        if ((aLetter == '(') || (aLetter == ')') || (aLetter == '{'))
+        {
+            return readFailure("Unable to read boundaryField");
+        }
+
+        QByteArray patchName = readWord();
+        if (patchName.startsWith('#'))
+        {
+            skipLine();
+            continue;
+        }
+
+        skipSpace();
+        if ((myPos < myEnd) && (*myPos == '{'))
+        {
+            if (!readPatch(patchName)) return false;
+        }
+        else if (!skipEntry())
+        {
+            return false;
+        }
+    }
+}
+
+bool CFDfoamDict::readPatch(QByteArray patchName)
+{
+    CFDpatchField newPatch;
+    newPatch.patchName = QByteArray(patchName.constData(), patchName.size());
+    myPos++;
+
+    while (true)
+    {
+        skipSpace();
+        if (myPos >= myEnd) return readFailure("Patch entry is not closed");
+
+        char aLetter = *myPos;
+        if (aLetter == '}')
+        {
+            myPos++;
+            break;
+        }
+        if (aLetter == ';')
+        {
+            myPos++;
+            continue;
+        }
+        if ((aLetter == '(') || (aLetter == ')') || (aLetter == '{'))
+        {
+            return readFailure("Unable to read boundaryField");
+        }
+
+        QByteArray keyword = readWord();
+        if (keyword.startsWith('#'))
+        {
+            skipLine();
+            continue;
+        }
+
+        if (keyword == "type")
+        {
+            skipSpace();
+            QByteArray patchType = readWord();
+            newPatch.patchType = QByteArray(patchType.constData(), patchType.size());
+            if (!skipEntry()) return false;
+        }
+        else if (keyword == "value")
+        {
+            if (!readFieldValue(&newPatch.value)) return false;
+        }
+        else if (!skipEntry())
+        {
+            return false;
+        }
+    }
+
+    boundaryField.push_back(newPatch);
+    return true;
+}
+
+bool CFDfoamDict::skipEntry()
+{
+    //Skips to the ; at the end of an entry, or past a sub-dictionary
+    while (true)
+    {
+        skipSpace();
+        if (myPos >= myEnd) return true;
+
+        char aLetter = *myPos;
+        if (aLetter == ';')
+        {
+            myPos++;
+            return true;
+        }
+        if (aLetter == '{')
+        {
+            if (!skipGroup()) return readFailure("Unable to read dictionary");
+            return true;
+        }
+        if (aLetter == '(')
+        {
+            if (!skipGroup()) return readFailure("Unable to read dictionary");
+            continue;
+        }
+        if ((aLetter == ')') || (aLetter == '}'))
+        {
+            //The end of the enclosing dictionary is left for the caller
+            return true;
+        }
+
+        //Nonuniform lists may be binary, so cannot be skipped by their parens
+        const char * wordStart = myPos;
+        if (readWord() == "nonuniform")
+        {
+            myPos = wordStart;
+            CFDfieldEntry skippedEntry;
+            return readFieldValue(&skippedEntry);
+        }
+    }
+}
+
+bool CFDfoamDict::skipAsciiList(char closeChar, bool isFlat)
+{
+    //Lists of single values have no parens inside them
+    if (isFlat)
+    {
+        const void * closePos = memchr(myPos, closeChar, static_cast<size_t>(myEnd - myPos));
+        if (closePos == nullptr) return false;
+        myPos = static_cast<const char *>(closePos) + 1;
+        return true;
+    }
+
+    int nowDepth = 1;
+    while (myPos < myEnd)
+    {
+        char aLetter = *myPos;
+        myPos++;
+        if (aLetter == '(')
+        {
+            nowDepth++;
+        }
+        else if (aLetter == ')')
+        {
+            nowDepth--;
+            if (nowDepth == 0) return true;
+        }
+    }
+    return false;
+}
+
+int CFDfoamDict::getComponentCount(const QByteArray &listType) const
+{
+    if (listType == "List<scalar>") return 1;
+    if (listType == "List<label>") return 1;
+    if (listType == "List<sphericalTensor>") return 1;
+    if (listType == "List<vector>") return 3;
+    if (listType == "List<symmTensor>") return 6;
+    if (listType == "List<tensor>") return 9;
+    return -1;
+}
+
+QByteArray CFDfoamDict::readWord()
+{
+    //Quoted strings are returned without their quotes
+    if ((myPos < myEnd) && (*myPos == '"'))
+    {
+        const char * wordStart = myPos + 1;
+        const void * quoteEnd = memchr(wordStart, '"', static_cast<size_t>(myEnd - wordStart));
+        if (quoteEnd == nullptr)
+        {
+            myPos = myEnd;
+            return QByteArray();
+        }
+        myPos = static_cast<const char *>(quoteEnd) + 1;
+        return QByteArray::fromRawData(wordStart, static_cast<int>(myPos - 1 - wordStart));
+    }
+
+    const char * wordStart = myPos;
+    while ((myPos < myEnd) && !isDelimiter(*myPos))
+    {
+        if ((*myPos == '/') && (myPos + 1 < myEnd) &&
+                ((myPos[1] == '/') || (myPos[1] == '*'))) break;
+        myPos++;
+    }
+    return QByteArray::fromRawData(wordStart, static_cast<int>(myPos - wordStart));
+}
+
+bool CFDfoamDict::expectChar(char expected)
+{
+    skipSpace();
+    if ((myPos >= myEnd) || (*myPos != expected)) return false;
+    myPos++;
+    return true;
+}
+
+bool CFDfoamDict::skipGroup()
+{
+    int nowDepth = 0;
+    while (myPos < myEnd)
+    {
+        char aLetter = *myPos;
+        if ((aLetter == '(') || (aLetter == '{'))
+        {
+            nowDepth++;
+        }
+        else if ((aLetter == ')') || (aLetter == '}'))
+        {
+            nowDepth--;
+            if (nowDepth == 0)
+            {
+                myPos++;
+                return true;
+            }
+        }
+        myPos++;
+        skipSpace();
+    }
+    return false;
+}
+
+void CFDfoamDict::skipLine()
+{
+    const void * lineEnd = memchr(myPos, '\n', static_cast<size_t>(myEnd - myPos));
+    myPos = (lineEnd == nullptr) ? myEnd : static_cast<const char *>(lineEnd);
+}
+
+void CFDfoamDict::skipSpace()
+{
+    //Comments can be //
+    /* or have the multiline format */
+    while (myPos < myEnd)
+    {
+        myPos = CFDnumberParser::skipSpace(myPos, myEnd);
+        if (myPos >= myEnd) return;
+
+        char aLetter = *myPos;
+        if ((aLetter == '/') && (myPos + 1 < myEnd) && (myPos[1] == '/'))
+        {
+            skipLine();
+            continue;
+        }
+        if ((aLetter == '/') && (myPos + 1 < myEnd) && (myPos[1] == '*'))
+        {
+            const char * searchPos = myPos + 2;
+            while ((searchPos + 1 < myEnd) && !((searchPos[0] == '*') && (searchPos[1] == '/'))) searchPos++;
+            myPos = (searchPos + 1 < myEnd) ? searchPos + 2 : myEnd;
+            continue;
+        }
+        return;
+    }
+}
+
+bool CFDfoamDict::isDelimiter(char aLetter)
+{
+    if (std::isspace(static_cast<unsigned char>(aLetter))) return true;
+    if ((aLetter == '(') || (aLetter == ')')) return true;
+    if ((aLetter == '{') || (aLetter == '}')) return true;
+    if (aLetter == ';') return true;
+    return false;
+}
+
+bool CFDfoamDict::readFailure(QString errorText)
+{
+    readError = errorText;
+    return false;
+}
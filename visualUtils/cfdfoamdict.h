@@ -0,0 +1,154 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDFOAMDICT_H
+#define CFDFOAMDICT_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+//Reads the FoamFile header and the top level entries of an OpenFOAM file,
+//without reading the data lists themselves. Lists are skipped over
+//and their place in the file is recorded, so that loaders can go straight to them.
+
+//The FoamFile header gives the format, and the arch entry gives the
+//byte order and the label/scalar sizes, ex: arch "LSB;label=32;scalar=64";
+
+struct CFDfoamFormat
+{
+    bool isBinary = false;
+    bool isLittleEndian = true;
+    int labelSize = 4;
+    int scalarSize = 8;
+    QByteArray className;
+};
+
+enum class CFDfieldKind
+{
+    MISSING,
+    UNIFORM,
+    NONUNIFORM
+};
+
+//A field value, ex: uniform (0 0 0); or nonuniform List<scalar> N (...);
+struct CFDfieldEntry
+{
+    CFDfieldKind kind = CFDfieldKind::MISSING;
+
+    //For uniform values, one entry per component
+    std::vector<double> uniformValue;
+
+    //For nonuniform values, listStart is the offset of the N before the list
+    //and listEnd is just past its closing paren
+    QByteArray listType;
+    qint64 listSize = -1;
+    qint64 listStart = -1;
+    qint64 listEnd = -1;
+};
+
+struct CFDpatchField
+{
+    QByteArray patchName;
+    QByteArray patchType;
+    CFDfieldEntry value;
+};
+
+//An entry of polyMesh/boundary: the patch holds nFaces faces, from startFace
+struct CFDmeshPatch
+{
+    QByteArray patchName;
+    QByteArray patchType;
+    int startFace = -1;
+    int nFaces = -1;
+};
+
+class CFDfoamDict
+{
+public:
+    explicit CFDfoamDict(const QByteArray * rawInput);
+
+    bool readHeader();
+    //Reads the header, dimensions, internalField and boundaryField
+    bool readDict();
+    //For polyMesh/boundary, which is a list of dictionaries rather than a dictionary
+    bool readPatchList(std::vector<CFDmeshPatch> * patchList);
+
+    CFDfoamFormat getFormat() const;
+    qint64 getHeaderEnd() const;
+
+    std::vector<double> getDimensions() const;
+    CFDfieldEntry getInternalField() const;
+    std::vector<CFDpatchField> getBoundaryField() const;
+
+    QString getReadError() const;
+
+private:
+    void readArch(QByteArray archString);
+    bool readDimensions();
+    bool readFieldValue(CFDfieldEntry * entry);
+    bool readListRange(CFDfieldEntry * entry);
+    bool readBoundaryField();
+    bool readPatch(QByteArray patchName);
+    bool skipEntry();
+    bool skipAsciiList(char closeChar, bool isFlat);
+
+    int getComponentCount(const QByteArray &listType) const;
+
+    QByteArray readWord();
+    bool expectChar(char expected);
+    bool skipGroup();
+    void skipLine();
+    void skipSpace();
+
+    bool isDelimiter(char aLetter);
+    bool readFailure(QString errorText);
+
+    const char * myStart = nullptr;
+    const char * myPos = nullptr;
+    const char * myEnd = nullptr;
+
+    CFDfoamFormat myFormat;
+    qint64 headerEnd = 0;
+
+    std::vector<double> myDimensions;
+    CFDfieldEntry internalField;
+    std::vector<CFDpatchField> boundaryField;
+
+    QString readError;
+};
+
+#endif // CFDFOAMDICT_H
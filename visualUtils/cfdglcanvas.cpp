@@ -35,108 +35,229 @@
 
 #include "cfdglcanvas.h"
 
-#include "cfdtoken.h"
-
-CFDglCanvas::CFDglCanvas(QWidget *parent, Qt::WindowFlags f) : QOpenGLWidget(parent,f) {}
+#include "cfdlistreader.h"
+#include "cfdfoamdict.h"
+#include "cfdparsepipeline.h"
+#include "cfdmemoryuse.h"
+
+#include <QOpenGLShaderProgram>
+
+//Note: GLSL 1.10, so that these also run on the legacy contexts of older drivers
+//Also, 1D textures are not in all OpenGL versions, so the color maps are rows of a 2D texture
+static const char MESH_VERTEX_SHADER[] =
+        "attribute highp vec3 vertex;\n"
+        "attribute highp float vertexValue;\n"
+        "uniform highp mat4 projViewMat;\n"
+        "varying highp float value;\n"
+        "void main()\n"
+        "{\n"
+        "    value = vertexValue;\n"
+        "    gl_Position = projViewMat * vec4(vertex, 1.0);\n"
+        "}\n";
+
+static const char MESH_FRAGMENT_SHADER[] =
+        "uniform bool useColorMap;\n"
+        "uniform lowp vec3 lineColor;\n"
+        "uniform sampler2D colorMaps;\n"
+        "uniform highp float mapRow;\n"
+        "uniform highp float mapWidth;\n"
+        "uniform highp float rangeLow;\n"
+        "uniform highp float rangeHigh;\n"
+        "uniform bool logScale;\n"
+        "varying highp float value;\n"
+        "void main()\n"
+        "{\n"
+        "    if (!useColorMap)\n"
+        "    {\n"
+        "        gl_FragColor = vec4(lineColor, 1.0);\n"
+        "        return;\n"
+        "    }\n"
+        "    highp float scaled = value;\n"
+        "    if (logScale) scaled = log(max(value, 1.0e-30));\n"
+        "    highp float dataVal = clamp((scaled - rangeLow) / (rangeHigh - rangeLow), 0.0, 1.0);\n"
+        "    highp float mapPos = (0.5 + dataVal * (mapWidth - 1.0)) / mapWidth;\n"
+        "    gl_FragColor = vec4(texture2D(colorMaps, vec2(mapPos, mapRow)).rgb, 1.0);\n"
+        "}\n";
+
+CFDglCanvas::CFDglCanvas(QWidget *parent, Qt::WindowFlags f) : QOpenGLWidget(parent,f),
+    cornerVertexBuffer(QOpenGLBuffer::VertexBuffer),
+    fillValueBuffer(QOpenGLBuffer::VertexBuffer),
+    fillIndexBuffer(QOpenGLBuffer::IndexBuffer),
+    edgeIndexBuffer(QOpenGLBuffer::IndexBuffer) {}
 
 CFDglCanvas::~CFDglCanvas()
 {
+    disconnect(contextConnection);
+    releaseGLResources();
     clearAllData();
 }
 
 bool CFDglCanvas::loadFieldData(QByteArray * rawDataFile, QString valueType)
 {
-    CFDtoken * dataRoot = CFDtoken::lexifyString(rawDataFile);
+    dataList.clear();
+
+    CFDlistReader dataReader(rawDataFile);
 
-    if (!CFDtoken::parseTokenStream(dataRoot))
+    if (valueType == "scalar")
     {
-        currentDisplayError = "Unable to read data file";
-        delete dataRoot;
+        if (!dataReader.readScalarField(&dataList))
+        {
+            currentDisplayError = dataReader.getReadError();
+            return false;
+        }
+    }
+    else if (valueType == "magnitude")
+    {
+        std::vector<double> vectorList;
+        if (!dataReader.readVectorField(&vectorList))
+        {
+            currentDisplayError = dataReader.getReadError();
+            return false;
+        }
+
+        computeMagnitudes(vectorList, &dataList);
+    }
+    else
+    {
+        currentDisplayError = "Invalid data type";
         return false;
     }
 
-    CFDtoken * dataElement = dataRoot->getLargestChildArray();
+    return checkFieldData();
+}
 
-    if (dataElement == nullptr)
+bool CFDglCanvas::loadParsedFieldData(CFDparsedList * fieldData, QString valueType)
+{
+    dataList.clear();
+
+    if (!fieldData->readOK)
     {
-        currentDisplayError = "Unable to locate data in data file";
-        delete dataRoot;
+        currentDisplayError = fieldData->readError;
         return false;
     }
 
     if (valueType == "scalar")
     {
-        for (auto itr = dataElement->getChildList().cbegin();
-             itr != dataElement->getChildList().cend(); itr++)
+        dataList.swap(fieldData->doubleVals);
+    }
+    else if (valueType == "magnitude")
+    {
+        computeMagnitudes(fieldData->doubleVals, &dataList);
+        std::vector<double>().swap(fieldData->doubleVals);
+    }
+    else
+    {
+        currentDisplayError = "Invalid data type";
+        return false;
+    }
+
+    return checkFieldData();
+}
+
+bool CFDglCanvas::loadPatchFieldData(QByteArray * rawDataFile, QString valueType)
+{
+    dataList.clear();
+
+    if (loadedPatchName.isEmpty())
+    {
+        currentDisplayError = "No patch is loaded";
+        return false;
+    }
+
+    CFDlistReader dataReader(rawDataFile);
+
+    if (valueType == "scalar")
+    {
+        if (!dataReader.readScalarPatch(loadedPatchName, loadedPatchSize, &dataList))
         {
-            if (((*itr)->getType() == CFDtokenType::FLOAT) ||
-                    ((*itr)->getType() == CFDtokenType::INT))
-            {
-                dataList.append((*itr)->getFloatVal());
-            }
-            else
-            {
-                currentDisplayError = "Data list does not contain floats";
-                delete dataRoot;
-                return false;
-            }
+            currentDisplayError = dataReader.getReadError();
+            return false;
         }
     }
     else if (valueType == "magnitude")
     {
-        for (auto itr = dataElement->getChildList().cbegin();
-             itr != dataElement->getChildList().cend(); itr++)
+        std::vector<double> vectorList;
+        if (!dataReader.readVectorPatch(loadedPatchName, loadedPatchSize, &vectorList))
         {
-            if ((*itr)->getType() != CFDtokenType::DATA_ARRAY)
-            {
-                currentDisplayError = "Data list does not contain float arrays";
-                delete dataRoot;
-                return false;
-            }
-
-            double sum = 0.0;
-            for (auto itr2 = (*itr)->getChildList().cbegin();
-                 itr2 != (*itr)->getChildList().cend(); itr2++)
-            {
-                double rawVal = (*itr2)->getFloatVal();
-                sum += rawVal * rawVal;
-            }
-            dataList.append(sqrt(sum));
+            currentDisplayError = dataReader.getReadError();
+            return false;
         }
+
+        computeMagnitudes(vectorList, &dataList);
     }
     else
     {
         currentDisplayError = "Invalid data type";
+        return false;
+    }
 
-        delete dataRoot;
+    if (dataList.empty())
+    {
+        currentDisplayError = "Data list is empty";
         return false;
     }
 
-    QList<double> sortedList = dataList;
+    return computeDataRange();
+}
+
+bool CFDglCanvas::loadWasCancelled()
+{
+    if (!myCancelCheck || !myCancelCheck()) return false;
+    currentDisplayError = "Loading was cancelled";
+    return true;
+}
 
-    std::sort(sortedList.begin(), sortedList.end());
+bool CFDglCanvas::checkFieldData()
+{
+    if (dataList.empty())
+    {
+        currentDisplayError = "Data list is empty";
+        return false;
+    }
 
-    if (sortedList.size() < 50)
+    if (static_cast<int>(dataList.size()) < cellCount)
     {
-        lowDataVal = sortedList.at(0);
-        highDataVal = sortedList.last();
+        currentDisplayError = "Data list does not match mesh";
+        return false;
     }
-    else
+
+    return computeDataRange();
+}
+
+bool CFDglCanvas::computeDataRange()
+{
+    if (loadWasCancelled()) return false;
+
+    fieldStats = CFDfieldStats(dataList);
+    if (fieldStats.isEmpty())
     {
-        lowDataVal = sortedList.at(19);
-        highDataVal = sortedList.at(sortedList.size()-19);
+        currentDisplayError = "Data list has no valid values";
+        return false;
     }
 
-    delete dataRoot;
+    applyFieldStats();
+    valuesStale = true;
     return true;
 }
 
+void CFDglCanvas::applyFieldStats()
+{
+    lowDataVal = fieldStats.getPercentile(clipPercent);
+    highDataVal = fieldStats.getPercentile(100.0 - clipPercent);
+
+    lowColorVal = lowDataVal;
+    highColorVal = highDataVal;
+}
+
+void CFDglCanvas::setCancelCheck(std::function<bool()> cancelCheck)
+{
+    myCancelCheck = cancelCheck;
+}
+
 bool CFDglCanvas::displayAvailData()
 {
     if (!currentDisplayError.isEmpty()) return false;
-    if (pointList.isEmpty()) return false;
-    if (faceList.isEmpty()) return false;
-    if (ownerList.isEmpty()) return false;
+    if (shownMesh.faceOffsets.empty()) return false;
     readyToDisplay = true;
     recomputePerspecMat();
     recomputeViewModelMat();
@@ -149,10 +270,126 @@ QString CFDglCanvas::getDisplayError()
     return currentDisplayError;
 }
 
+qint64 CFDglCanvas::getHeldBytes()
+{
+    qint64 heldBytes = 0;
+    for (const std::vector<float> * aList : {&shownMesh.xVals, &shownMesh.yVals, &shownMesh.zVals})
+    {
+        heldBytes += CFDmemoryUse::getVectorBytes(*aList);
+    }
+    for (const std::vector<int> * aList : {&shownMesh.faceOffsets, &shownMesh.faceIndices, &shownMesh.ownerList,
+         &faceOffsets, &faceIndices, &ownerList})
+    {
+        heldBytes += CFDmemoryUse::getVectorBytes(*aList);
+    }
+    heldBytes += CFDmemoryUse::getVectorBytes(pointList) + CFDmemoryUse::getVectorBytes(dataList);
+    return heldBytes;
+}
+
+void CFDglCanvas::setColorRange(double low, double high)
+{
+    lowColorVal = low;
+    highColorVal = high;
+    this->update();
+}
+
+void CFDglCanvas::resetColorRange()
+{
+    setColorRange(lowDataVal, highDataVal);
+}
+
+double CFDglCanvas::getColorRangeLow()
+{
+    return lowColorVal;
+}
+
+double CFDglCanvas::getColorRangeHigh()
+{
+    return highColorVal;
+}
+
+void CFDglCanvas::setColorMap(CFDcolorMap newMap)
+{
+    currentColorMap = newMap;
+    this->update();
+}
+
+void CFDglCanvas::setLogScale(bool useLog)
+{
+    useLogScale = useLog;
+    this->update();
+}
+
+CFDcolorMap CFDglCanvas::getColorMap()
+{
+    return currentColorMap;
+}
+
+bool CFDglCanvas::getLogScale()
+{
+    return useLogScale;
+}
+
+void CFDglCanvas::setClipPercent(double newPercent)
+{
+    clipPercent = qBound(0.0, newPercent, 49.0);
+    if (fieldStats.isEmpty()) return;
+    applyFieldStats();
+    this->update();
+}
+
+double CFDglCanvas::getClipPercent()
+{
+    return clipPercent;
+}
+
+const CFDfieldStats &CFDglCanvas::getFieldStats()
+{
+    return fieldStats;
+}
+
+void CFDglCanvas::setFieldStats(const CFDfieldStats &newStats)
+{
+    if (newStats.isEmpty()) return;
+    fieldStats = newStats;
+    applyFieldStats();
+    this->update();
+}
+
+QColor CFDglCanvas::getValueColor(double aValue)
+{
+    double rangeLow;
+    double rangeHigh;
+    if (getShaderRange(&rangeLow, &rangeHigh)) aValue = log(qMax(aValue, 1.0e-30));
+
+    GLubyte aColor[3];
+    getMapColor(currentColorMap, (aValue - rangeLow) / (rangeHigh - rangeLow), aColor);
+    return QColor(aColor[0], aColor[1], aColor[2]);
+}
+
 void CFDglCanvas::initializeGL()
 {
     initializeOpenGLFunctions();
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+    //Note: The context is replaced if the canvas is moved to another window
+    disconnect(contextConnection);
+    contextConnection = connect(context(), &QOpenGLContext::aboutToBeDestroyed,
+                                this, &CFDglCanvas::releaseGLResources);
+
+    meshProgram = new QOpenGLShaderProgram();
+    meshProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, MESH_VERTEX_SHADER);
+    meshProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, MESH_FRAGMENT_SHADER);
+    meshProgram->bindAttributeLocation("vertex", VERTEX_ATTRIB);
+    meshProgram->bindAttributeLocation("vertexValue", VALUE_ATTRIB);
+    if (!meshProgram->link())
+    {
+        currentDisplayError = "Unable to set up OpenGL shaders";
+        delete meshProgram;
+        meshProgram = nullptr;
+    }
+    uploadColorMaps();
+    buffersStale = true;
 }
 
 void CFDglCanvas::resizeGL(int w, int h)
@@ -162,15 +399,16 @@ void CFDglCanvas::resizeGL(int w, int h)
     recomputePerspecMat();
 }
 
-bool CFDglCanvas::isAllZ0(QList<int> aFace)
+bool CFDglCanvas::isAllZ0(int faceIndex)
 {
-    for (auto pointIndItr = aFace.cbegin(); pointIndItr != aFace.cend(); pointIndItr++)
+    for (int ind = faceOffsets[faceIndex]; ind < faceOffsets[faceIndex + 1]; ind++)
     {
-        if (pointList.at(*pointIndItr).at(2) > PRECISION)
+        double zVal = getPoint(faceIndices[ind])[2];
+        if (zVal > PRECISION)
         {
             return false;
         }
-        if (pointList.at(*pointIndItr).at(2) < -PRECISION)
+        if (zVal < -PRECISION)
         {
             return false;
         }
@@ -178,141 +416,578 @@ bool CFDglCanvas::isAllZ0(QList<int> aFace)
     return true;
 }
 
+int CFDglCanvas::getFaceCount()
+{
+    if (faceOffsets.empty()) return 0;
+    return static_cast<int>(faceOffsets.size()) - 1;
+}
+
+const double * CFDglCanvas::getPoint(int pointIndex)
+{
+    return pointList.data() + 3 * static_cast<size_t>(pointIndex);
+}
+
 bool CFDglCanvas::loadRawMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile)
 {
     clearAllData();
 
-    CFDtoken * pointRoot = CFDtoken::lexifyString(rawPointFile);
-    CFDtoken * faceRoot = CFDtoken::lexifyString(rawFaceFile);
-    CFDtoken * ownerRoot = CFDtoken::lexifyString(rawOwnerFile);
+    CFDlistReader pointReader(rawPointFile);
+    CFDlistReader faceReader(rawFaceFile);
+    CFDlistReader ownerReader(rawOwnerFile);
+
+    if (!pointReader.readVectorList(&pointList))
+    {
+        currentDisplayError = pointReader.getReadError();
+        return false;
+    }
+
+    if (!faceReader.readFaceList(&faceOffsets, &faceIndices))
+    {
+        currentDisplayError = faceReader.getReadError();
+        return false;
+    }
+
+    if (!ownerReader.readLabelList(&ownerList))
+    {
+        currentDisplayError = ownerReader.getReadError();
+        return false;
+    }
+
+    if (!checkMeshData() || loadWasCancelled()) return false;
+    buildFaceSet();
+    return true;
+}
+
+bool CFDglCanvas::takeParsedMeshData(CFDparsedList * pointData, CFDparsedList * faceData, CFDparsedList * ownerData)
+{
+    clearAllData();
+
+    for (CFDparsedList * aList : {pointData, faceData, ownerData})
+    {
+        if (!aList->readOK)
+        {
+            currentDisplayError = aList->readError;
+            return false;
+        }
+    }
+
+    pointList.swap(pointData->doubleVals);
+    faceOffsets.swap(faceData->faceOffsets);
+    faceIndices.swap(faceData->labelVals);
+    ownerList.swap(ownerData->labelVals);
+
+    if (!checkMeshData() || loadWasCancelled()) return false;
+    buildFaceSet();
+    return true;
+}
 
-    if (!CFDtoken::parseTokenStream(pointRoot) ||
-        !CFDtoken::parseTokenStream(faceRoot) ||
-        !CFDtoken::parseTokenStream(ownerRoot))
+bool CFDglCanvas::checkMeshData()
+{
+    if (pointList.empty())
     {
-        currentDisplayError = "Unable to read mesh data files";
-        delete pointRoot;
-        delete faceRoot;
-        delete ownerRoot;
+        currentDisplayError = "Point list is empty";
         return false;
     }
 
-    CFDtoken * pointElement = pointRoot->getLargestChildArray();
-    CFDtoken * faceElement = faceRoot->getLargestChildArray();
-    CFDtoken * ownerElement = ownerRoot->getLargestChildArray();
+    int pointCount = static_cast<int>(pointList.size() / 3);
+    for (int pointIndex : faceIndices)
+    {
+        if ((pointIndex < 0) || (pointIndex >= pointCount))
+        {
+            currentDisplayError = "Face list refers to points not in point list";
+            return false;
+        }
+    }
 
-    if ((pointElement == nullptr) || (faceElement == nullptr) || (ownerElement == nullptr))
+    if (static_cast<int>(ownerList.size()) != getFaceCount())
     {
-        currentDisplayError = "Unable to locate mesh data in files";
-        delete pointRoot;
-        delete faceRoot;
-        delete ownerRoot;
+        currentDisplayError = "Owner list does not match face list";
         return false;
     }
 
-    //TODO: Add more validity checks before reading each element
-    for (auto itr = pointElement->getChildList().cbegin();
-         itr != pointElement->getChildList().cend(); itr++)
+    cellCount = 0;
+    for (int cellIndex : ownerList)
     {
-        if ((*itr)->getChildSize() != 3)
+        if (cellIndex < 0)
         {
-            currentDisplayError = "Point list does not contain points";
-            delete pointRoot; delete faceRoot; delete ownerRoot;
+            currentDisplayError = "Owner list contains invalid cells";
             return false;
         }
-        QList<double> aPoint;
+        if (cellIndex >= cellCount) cellCount = cellIndex + 1;
+    }
 
-        for (auto coordItr = (*itr)->getChildList().cbegin();
-             coordItr != (*itr)->getChildList().cend(); coordItr++)
+    return true;
+}
+
+bool CFDglCanvas::loadRawPatchData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawBoundaryFile, QString patchName)
+{
+    clearAllData();
+
+    CFDfoamDict boundaryReader(rawBoundaryFile);
+    std::vector<CFDmeshPatch> patchList;
+    if (!boundaryReader.readPatchList(&patchList))
+    {
+        currentDisplayError = boundaryReader.getReadError();
+        return false;
+    }
+
+    const CFDmeshPatch * usePatch = nullptr;
+    for (const CFDmeshPatch &aPatch : patchList)
+    {
+        if (patchName.isEmpty() ? (aPatch.patchType == "wall") : (aPatch.patchName == patchName.toLatin1()))
         {
-            if ((*coordItr)->getType() == CFDtokenType::INT)
-            {
-                double tmp = static_cast<double> ((*coordItr)->getIntVal());
-                aPoint.append(tmp);
-            }
-            else if ((*coordItr)->getType() == CFDtokenType::FLOAT)
-            {
-                aPoint.append((*coordItr)->getFloatVal());
-            }
-            else
-            {
-                currentDisplayError = "Point list does not contain numbers";
-                delete pointRoot; delete faceRoot; delete ownerRoot;
-                return false;
-            }
+            usePatch = &aPatch;
+            break;
         }
+    }
 
-        pointList.append(aPoint);
+    if (usePatch == nullptr)
+    {
+        currentDisplayError = "Mesh does not contain the requested patch";
+        return false;
+    }
+    if (usePatch->nFaces == 0)
+    {
+        currentDisplayError = "Mesh patch has no faces";
+        return false;
+    }
+
+    CFDlistReader pointReader(rawPointFile);
+    CFDlistReader faceReader(rawFaceFile);
+
+    if (!pointReader.readVectorList(&pointList))
+    {
+        currentDisplayError = pointReader.getReadError();
+        return false;
     }
 
-    for (auto itr = faceElement->getChildList().cbegin();
-         itr != faceElement->getChildList().cend(); itr++)
+    if (!faceReader.readFaceRange(usePatch->startFace, usePatch->nFaces, &faceOffsets, &faceIndices))
     {
-        QList<int> aFace;
+        currentDisplayError = faceReader.getReadError();
+        return false;
+    }
+
+    //Note: Only the points used by the patch are kept, when the shown faces are found
+    ownerList.resize(static_cast<size_t>(getFaceCount()));
+    for (size_t ind = 0; ind < ownerList.size(); ind++)
+    {
+        ownerList[ind] = static_cast<int>(ind);
+    }
+    if (!checkMeshData() || loadWasCancelled()) return false;
 
-        for (auto elementItr = (*itr)->getChildList().cbegin();
-             elementItr != (*itr)->getChildList().cend(); elementItr++)
+    loadedPatchName = usePatch->patchName;
+    loadedPatchSize = usePatch->nFaces;
+
+    buildFaceSet();
+    return true;
+}
+
+void CFDglCanvas::buildFaceSet()
+{
+    //Note: This is done once for each mesh, the paint then only needs the shown faces
+    //The faces are checked first, so that the shown mesh can be sized exactly
+    std::vector<char> faceShown(static_cast<size_t>(getFaceCount()), 0);
+    std::vector<int> newIndex(pointList.size() / 3, -1);
+    int shownFaceCount = 0;
+    int shownCornerCount = 0;
+    int shownPointCount = 0;
+
+    for (int faceIndex = 0; faceIndex < getFaceCount(); faceIndex++)
+    {
+        if (!isFaceShown(faceIndex)) continue;
+
+        faceShown[static_cast<size_t>(faceIndex)] = 1;
+        shownFaceCount++;
+        for (int ind = faceOffsets[faceIndex]; ind < faceOffsets[faceIndex + 1]; ind++)
+        {
+            int &mappedIndex = newIndex[static_cast<size_t>(faceIndices[ind])];
+            if (mappedIndex == -1) mappedIndex = shownPointCount++;
+            shownCornerCount++;
+        }
+    }
+
+    CFDshownMesh newMesh;
+    newMesh.xVals.resize(static_cast<size_t>(shownPointCount));
+    newMesh.yVals.resize(static_cast<size_t>(shownPointCount));
+    newMesh.zVals.resize(static_cast<size_t>(shownPointCount));
+    newMesh.faceOffsets.reserve(static_cast<size_t>(shownFaceCount) + 1);
+    newMesh.faceIndices.reserve(static_cast<size_t>(shownCornerCount));
+    newMesh.ownerList.reserve(static_cast<size_t>(shownFaceCount));
+
+    //The bounds are found as the points are copied
+    double newBounds[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    bool firstPoint = true;
+    for (size_t pointIndex = 0; pointIndex < newIndex.size(); pointIndex++)
+    {
+        if (newIndex[pointIndex] == -1) continue;
+
+        const double * aPoint = getPoint(static_cast<int>(pointIndex));
+        for (int dim = 0; dim < 3; dim++)
         {
-            if ((*elementItr)->getType() == CFDtokenType::INT)
-            {
-                aFace.append((*elementItr)->getIntVal());
-            }
-            else
-            {
-                currentDisplayError = "Face list does not contain ints";
-                delete pointRoot; delete faceRoot; delete ownerRoot;
-                return false;
-            }
+            if (firstPoint || (aPoint[dim] < newBounds[2 * dim])) newBounds[2 * dim] = aPoint[dim];
+            if (firstPoint || (aPoint[dim] > newBounds[2 * dim + 1])) newBounds[2 * dim + 1] = aPoint[dim];
         }
+        firstPoint = false;
 
-        faceList.append(aFace);
+        size_t mappedIndex = static_cast<size_t>(newIndex[pointIndex]);
+        newMesh.xVals[mappedIndex] = static_cast<float>(aPoint[0]);
+        newMesh.yVals[mappedIndex] = static_cast<float>(aPoint[1]);
+        newMesh.zVals[mappedIndex] = static_cast<float>(aPoint[2]);
     }
 
-    for (auto itr = ownerElement->getChildList().cbegin();
-         itr != ownerElement->getChildList().cend(); itr++)
+    newMesh.faceOffsets.push_back(0);
+    for (int faceIndex = 0; faceIndex < getFaceCount(); faceIndex++)
     {
-        if ((*itr)->getType() == CFDtokenType::INT)
+        if (faceShown[static_cast<size_t>(faceIndex)] == 0) continue;
+
+        for (int ind = faceOffsets[faceIndex]; ind < faceOffsets[faceIndex + 1]; ind++)
         {
-            ownerList.append((*itr)->getIntVal());
+            newMesh.faceIndices.push_back(newIndex[static_cast<size_t>(faceIndices[ind])]);
         }
-        else
+        newMesh.ownerList.push_back(ownerList[faceIndex]);
+        newMesh.faceOffsets.push_back(static_cast<int>(newMesh.faceIndices.size()));
+    }
+
+    shownMesh = std::move(newMesh);
+
+    //Note: As before, top is the highest y
+    modelBounds2D.setLeft(newBounds[0]);
+    modelBounds2D.setRight(newBounds[1]);
+    modelBounds2D.setBottom(newBounds[2]);
+    modelBounds2D.setTop(newBounds[3]);
+    modelLowZ = newBounds[4];
+    modelHighZ = newBounds[5];
+
+    //The full mesh is not needed once the shown faces are found
+    std::vector<double>().swap(pointList);
+    std::vector<int>().swap(faceOffsets);
+    std::vector<int>().swap(faceIndices);
+    std::vector<int>().swap(ownerList);
+
+    buffersStale = true;
+}
+
+void CFDglCanvas::drawMeshBuffers(const QMatrix4x4 &projViewMat, bool withFill, bool withEdges)
+{
+    if (meshProgram == nullptr) return;
+
+    if (buffersStale)
+    {
+        uploadCornerBuffer();
+        buffersStale = false;
+    }
+
+    meshProgram->bind();
+    meshProgram->setUniformValue("projViewMat", projViewMat);
+
+    if (withFill && !dataList.empty() && !shownMesh.ownerList.empty())
+    {
+        if (!fillIndexBuffer.isCreated()) uploadFillBuffers();
+        if (valuesStale) updateFaceValues();
+
+        double rangeLow;
+        double rangeHigh;
+        bool logScale = getShaderRange(&rangeLow, &rangeHigh);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colorMapTexture);
+
+        meshProgram->setUniformValue("useColorMap", static_cast<GLint>(true));
+        meshProgram->setUniformValue("colorMaps", 0);
+        meshProgram->setUniformValue("mapRow", static_cast<GLfloat>((static_cast<int>(currentColorMap) + 0.5) / COLOR_MAP_COUNT));
+        meshProgram->setUniformValue("mapWidth", static_cast<GLfloat>(COLOR_MAP_WIDTH));
+        meshProgram->setUniformValue("rangeLow", static_cast<GLfloat>(rangeLow));
+        meshProgram->setUniformValue("rangeHigh", static_cast<GLfloat>(rangeHigh));
+        meshProgram->setUniformValue("logScale", static_cast<GLint>(logScale));
+
+        if (fillVAO.isCreated()) fillVAO.bind();
+        else bindFillAttributes();
+
+        glDrawElements(GL_TRIANGLES, fillIndexCount, GL_UNSIGNED_INT, nullptr);
+
+        if (fillVAO.isCreated()) fillVAO.release();
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (withEdges && !shownMesh.ownerList.empty())
+    {
+        if (!edgeIndexBuffer.isCreated()) uploadEdgeBuffers();
+
+        if (edgeVAO.isCreated()) edgeVAO.bind();
+        else bindEdgeAttributes();
+
+        meshProgram->setUniformValue("useColorMap", static_cast<GLint>(false));
+        meshProgram->setUniformValue("lineColor", 0.0f, 0.0f, 0.0f);
+        glDrawElements(GL_LINES, edgeIndexCount, GL_UNSIGNED_INT, nullptr);
+
+        if (edgeVAO.isCreated()) edgeVAO.release();
+    }
+
+    meshProgram->release();
+}
+
+void CFDglCanvas::updateFaceValues()
+{
+    //Each corner takes the value of its face's owner cell, so the mesh itself is not needed
+    std::vector<GLfloat> cornerValues;
+    cornerValues.reserve(shownMesh.faceIndices.size());
+
+    for (size_t shownIndex = 0; shownIndex < shownMesh.ownerList.size(); shownIndex++)
+    {
+        GLfloat faceValue = static_cast<GLfloat>(dataList[static_cast<size_t>(shownMesh.ownerList[shownIndex])]);
+        int faceSize = shownMesh.faceOffsets[shownIndex + 1] - shownMesh.faceOffsets[shownIndex];
+        cornerValues.insert(cornerValues.end(), static_cast<size_t>(faceSize), faceValue);
+    }
+
+    fillValueBuffer.bind();
+    fillValueBuffer.allocate(cornerValues.data(), static_cast<int>(cornerValues.size() * sizeof(GLfloat)));
+    fillValueBuffer.release();
+    valuesStale = false;
+}
+
+void CFDglCanvas::uploadColorMaps()
+{
+    std::vector<GLubyte> mapTexels;
+    mapTexels.reserve(3 * COLOR_MAP_WIDTH * COLOR_MAP_COUNT);
+
+    for (int mapIndex = 0; mapIndex < COLOR_MAP_COUNT; mapIndex++)
+    {
+        for (int ind = 0; ind < COLOR_MAP_WIDTH; ind++)
         {
-            currentDisplayError = "Owner list does not contain ints";
-            delete pointRoot; delete faceRoot; delete ownerRoot;
-            return false;
+            GLubyte aColor[3];
+            getMapColor(static_cast<CFDcolorMap>(mapIndex), static_cast<double>(ind) / (COLOR_MAP_WIDTH - 1), aColor);
+            mapTexels.insert(mapTexels.end(), aColor, aColor + 3);
+        }
+    }
+
+    glGenTextures(1, &colorMapTexture);
+    glBindTexture(GL_TEXTURE_2D, colorMapTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, COLOR_MAP_WIDTH, COLOR_MAP_COUNT, 0, GL_RGB, GL_UNSIGNED_BYTE, mapTexels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void CFDglCanvas::uploadCornerBuffer()
+{
+    releaseMeshBuffers();
+
+    std::vector<GLfloat> cornerVertices;
+    cornerVertices.reserve(3 * shownMesh.faceIndices.size());
+    for (int pointIndex : shownMesh.faceIndices)
+    {
+        cornerVertices.push_back(shownMesh.xVals[static_cast<size_t>(pointIndex)]);
+        cornerVertices.push_back(shownMesh.yVals[static_cast<size_t>(pointIndex)]);
+        cornerVertices.push_back(shownMesh.zVals[static_cast<size_t>(pointIndex)]);
+    }
+
+    cornerVertexBuffer.create();
+    cornerVertexBuffer.bind();
+    cornerVertexBuffer.allocate(cornerVertices.data(), static_cast<int>(cornerVertices.size() * sizeof(GLfloat)));
+    cornerVertexBuffer.release();
+}
+
+void CFDglCanvas::uploadFillBuffers()
+{
+    fillValueBuffer.create();
+    valuesStale = true;
+
+    //The index lists only need the face offsets, so are made as they are sent, rather than kept
+    //As with GL_POLYGON, faces are taken to be convex, and split into a fan around their first corner
+    std::vector<GLuint> fillIndices;
+    for (size_t shownIndex = 0; shownIndex + 1 < shownMesh.faceOffsets.size(); shownIndex++)
+    {
+        GLuint firstCorner = static_cast<GLuint>(shownMesh.faceOffsets[shownIndex]);
+        GLuint faceEnd = static_cast<GLuint>(shownMesh.faceOffsets[shownIndex + 1]);
+        for (GLuint ind = firstCorner + 1; ind + 1 < faceEnd; ind++)
+        {
+            fillIndices.push_back(firstCorner);
+            fillIndices.push_back(ind);
+            fillIndices.push_back(ind + 1);
         }
     }
+    fillIndexCount = static_cast<GLsizei>(fillIndices.size());
 
-    delete pointRoot;
-    delete faceRoot;
-    delete ownerRoot;
+    fillIndexBuffer.create();
+    fillIndexBuffer.bind();
+    fillIndexBuffer.allocate(fillIndices.data(), static_cast<int>(fillIndices.size() * sizeof(GLuint)));
+    fillIndexBuffer.release();
 
-    modelBounds2D.setBottom(pointList.at(0).at(1));
-    modelBounds2D.setTop(pointList.at(0).at(1));
-    modelBounds2D.setLeft(pointList.at(0).at(0));
-    modelBounds2D.setRight(pointList.at(0).at(0));
+    //Note: If vertex array objects are not supported, the attributes are set at each paint instead
+    if (fillVAO.create())
+    {
+        fillVAO.bind();
+        bindFillAttributes();
+        fillVAO.release();
+    }
+}
 
-    for (auto itr = pointList.cbegin(); itr != pointList.cend(); itr++)
+void CFDglCanvas::uploadEdgeBuffers()
+{
+    std::vector<GLuint> edgeIndices;
+    edgeIndices.reserve(2 * shownMesh.faceIndices.size());
+    for (size_t shownIndex = 0; shownIndex + 1 < shownMesh.faceOffsets.size(); shownIndex++)
     {
-        double xVal = (*itr).at(0);
-        double yVal = (*itr).at(1);
+        GLuint firstCorner = static_cast<GLuint>(shownMesh.faceOffsets[shownIndex]);
+        GLuint faceEnd = static_cast<GLuint>(shownMesh.faceOffsets[shownIndex + 1]);
+        GLuint lastCorner = faceEnd - 1;
+        for (GLuint ind = firstCorner; ind < faceEnd; ind++)
+        {
+            edgeIndices.push_back(lastCorner);
+            edgeIndices.push_back(ind);
+            lastCorner = ind;
+        }
+    }
+    edgeIndexCount = static_cast<GLsizei>(edgeIndices.size());
 
-        if (xVal < modelBounds2D.left()) modelBounds2D.setLeft(xVal);
-        if (xVal > modelBounds2D.right()) modelBounds2D.setRight(xVal);
-        if (yVal > modelBounds2D.top()) modelBounds2D.setTop(yVal);
-        if (yVal < modelBounds2D.bottom()) modelBounds2D.setBottom(yVal);
+    edgeIndexBuffer.create();
+    edgeIndexBuffer.bind();
+    edgeIndexBuffer.allocate(edgeIndices.data(), static_cast<int>(edgeIndices.size() * sizeof(GLuint)));
+    edgeIndexBuffer.release();
+
+    if (edgeVAO.create())
+    {
+        edgeVAO.bind();
+        bindEdgeAttributes();
+        edgeVAO.release();
     }
+}
 
-    return true;
+void CFDglCanvas::bindFillAttributes()
+{
+    cornerVertexBuffer.bind();
+    meshProgram->enableAttributeArray(VERTEX_ATTRIB);
+    meshProgram->setAttributeBuffer(VERTEX_ATTRIB, GL_FLOAT, 0, 3);
+
+    fillValueBuffer.bind();
+    meshProgram->enableAttributeArray(VALUE_ATTRIB);
+    meshProgram->setAttributeBuffer(VALUE_ATTRIB, GL_FLOAT, 0, 1);
+
+    fillIndexBuffer.bind();
+}
+
+void CFDglCanvas::bindEdgeAttributes()
+{
+    cornerVertexBuffer.bind();
+    meshProgram->enableAttributeArray(VERTEX_ATTRIB);
+    meshProgram->setAttributeBuffer(VERTEX_ATTRIB, GL_FLOAT, 0, 3);
+
+    //Edges are drawn in lineColor, without data values
+    meshProgram->disableAttributeArray(VALUE_ATTRIB);
+
+    edgeIndexBuffer.bind();
+}
+
+void CFDglCanvas::releaseMeshBuffers()
+{
+    fillVAO.destroy();
+    edgeVAO.destroy();
+    cornerVertexBuffer.destroy();
+    fillValueBuffer.destroy();
+    fillIndexBuffer.destroy();
+    edgeIndexBuffer.destroy();
+}
+
+void CFDglCanvas::releaseGLResources()
+{
+    makeCurrent();
+    releaseMeshBuffers();
+    if (colorMapTexture != 0)
+    {
+        glDeleteTextures(1, &colorMapTexture);
+        colorMapTexture = 0;
+    }
+    delete meshProgram;
+    meshProgram = nullptr;
+    buffersStale = true;
+    doneCurrent();
+}
+
+bool CFDglCanvas::getShaderRange(double * rangeLow, double * rangeHigh)
+{
+    *rangeLow = lowColorVal;
+    *rangeHigh = highColorVal;
+    bool logScale = useLogScale && (*rangeHigh > 0.0);
+    if (logScale)
+    {
+        //Note: If the range reaches zero or below, the log scale covers six orders of magnitude
+        if (*rangeLow <= 0.0) *rangeLow = *rangeHigh * 0.000001;
+        *rangeLow = log(*rangeLow);
+        *rangeHigh = log(*rangeHigh);
+    }
+    if (*rangeHigh - *rangeLow < PRECISION) *rangeHigh = *rangeLow + PRECISION;
+    return logScale;
+}
+
+void CFDglCanvas::getMapColor(CFDcolorMap aMap, double dataVal, GLubyte * colorOut)
+{
+    double redVal = 1.0;
+    double greenVal = 0.0;
+    double blueVal = 1.0;
+
+    if (dataVal > 1.0) dataVal = 1.0;
+    else if (dataVal < 0.0) dataVal = 0.0;
+
+    if (aMap == CFDcolorMap::GRAYSCALE)
+    {
+        redVal = dataVal;
+        greenVal = dataVal;
+        blueVal = dataVal;
+    }
+    else if (aMap == CFDcolorMap::RAINBOW)
+    {
+        //Blue, cyan, green, yellow, red
+        redVal = qBound(0.0, 4.0 * dataVal - 2.0, 1.0);
+        greenVal = qBound(0.0, (dataVal < 0.75) ? (4.0 * dataVal) : (4.0 - 4.0 * dataVal), 1.0);
+        blueVal = qBound(0.0, 2.0 - 4.0 * dataVal, 1.0);
+    }
+    else if (dataVal > 0.5)
+    {
+        blueVal = 0.3 + 0.7 * ((1.0 - dataVal) / 0.5);
+        greenVal = 0.3 + 0.7 * ((1.0 - dataVal) / 0.5);
+    }
+    else
+    {
+        redVal = 0.3 + 0.7 * (dataVal / 0.5);
+        greenVal = 0.3 + 0.7 * (dataVal / 0.5);
+    }
+
+    colorOut[0] = static_cast<GLubyte>(redVal * 255.0 + 0.5);
+    colorOut[1] = static_cast<GLubyte>(greenVal * 255.0 + 0.5);
+    colorOut[2] = static_cast<GLubyte>(blueVal * 255.0 + 0.5);
 }
 
 void CFDglCanvas::clearAllData()
 {
     currentDisplayError.clear();
 
-    pointList.clear();
-    faceList.clear();
-    ownerList.clear();
+    //Note: swap with empty vectors, so that the memory is actually released
+    std::vector<double>().swap(pointList);
+    std::vector<int>().swap(faceOffsets);
+    std::vector<int>().swap(faceIndices);
+    std::vector<int>().swap(ownerList);
+    cellCount = 0;
+    loadedPatchName.clear();
+    loadedPatchSize = 0;
 
-    dataList.clear();
+    std::vector<double>().swap(dataList);
+    fieldStats = CFDfieldStats();
+
+    shownMesh = CFDshownMesh();
+    buffersStale = true;
+}
+
+void CFDglCanvas::computeMagnitudes(const std::vector<double> &vectorList, std::vector<double> * magnitudeList)
+{
+    magnitudeList->reserve(vectorList.size() / 3);
+    for (size_t ind = 0; ind + 2 < vectorList.size(); ind += 3)
+    {
+        double sum = vectorList[ind] * vectorList[ind] +
+                vectorList[ind + 1] * vectorList[ind + 1] +
+                vectorList[ind + 2] * vectorList[ind + 2];
+        magnitudeList->push_back(sqrt(sum));
+    }
 }
@@ -38,12 +38,38 @@
 
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
 #include <QMouseEvent>
 
 #include <QMatrix4x4>
+#include <QColor>
 
 #include <QtMath>
 
+#include <vector>
+#include <functional>
+
+#include "cfdfieldstats.h"
+
+struct CFDparsedList;
+class QOpenGLShaderProgram;
+
+enum class CFDcolorMap {BLUE_RED, RAINBOW, GRAYSCALE};
+
+//The faces a canvas draws, with only the points those faces use
+//Points are in separate x, y and z arrays, faces are CSR-style, as in CFDlistReader,
+//and ownerList has the owner cell of each face
+struct CFDshownMesh
+{
+    std::vector<float> xVals;
+    std::vector<float> yVals;
+    std::vector<float> zVals;
+    std::vector<int> faceOffsets;
+    std::vector<int> faceIndices;
+    std::vector<int> ownerList;
+};
+
 class CFDglCanvas : public QOpenGLWidget, protected QOpenGLFunctions
 {
 public:
@@ -53,34 +79,143 @@ public:
     virtual bool loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile) = 0;
     bool loadFieldData(QByteArray * rawDataFile, QString valueType);
 
+    //For lists already read by CFDparsePipeline, the lists are moved into the canvas
+    virtual bool loadParsedMeshData(CFDparsedList * pointData, CFDparsedList * faceData, CFDparsedList * ownerData) = 0;
+    bool loadParsedFieldData(CFDparsedList * fieldData, QString valueType);
+    //For data on the patch loaded by loadRawPatchData, read from the field's boundaryField
+    bool loadPatchFieldData(QByteArray * rawDataFile, QString valueType);
+
+    //Checked between the steps of a load, which then stops early, ex: when a window is closed mid-load
+    void setCancelCheck(std::function<bool()> cancelCheck);
+
     bool displayAvailData();
     QString getDisplayError();
+    //Bytes held for the mesh and data, ex: for benchmarks
+    qint64 getHeldBytes();
+
+    //Color settings only change shader uniforms, the data is not sent to the GPU again
+    void setColorRange(double low, double high);
+    void resetColorRange();
+    double getColorRangeLow();
+    double getColorRangeHigh();
+    void setColorMap(CFDcolorMap newMap);
+    void setLogScale(bool useLog);
+    CFDcolorMap getColorMap();
+    bool getLogScale();
+
+    //The default color range leaves out this percent of the values at each end
+    void setClipPercent(double newPercent);
+    double getClipPercent();
+    //Statistics of other data, ex: other time steps, can be given so that the color range is shared
+    const CFDfieldStats &getFieldStats();
+    void setFieldStats(const CFDfieldStats &newStats);
+    //The color drawn for a value, with the current map and range, ex: for a legend
+    QColor getValueColor(double aValue);
 
 protected:
     virtual void initializeGL();
     virtual void resizeGL(int w, int h);
 
-    bool isAllZ0(QList<int> aFace);
+    //Sends the shown faces to the GPU on the first paint after loading, then draws them with the given matrix
+    void drawMeshBuffers(const QMatrix4x4 &projViewMat, bool withFill, bool withEdges);
+    //Checked once per face, when a mesh is loaded, with the full mesh
+    virtual bool isFaceShown(int faceIndex) = 0;
+
+    bool isAllZ0(int faceIndex);
+    int getFaceCount();
+    const double * getPoint(int pointIndex);
     bool loadRawMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile);
+    bool takeParsedMeshData(CFDparsedList * pointData, CFDparsedList * faceData, CFDparsedList * ownerData);
+    //Loads only the faces of one boundary patch, if patchName is empty, the first wall patch is used
+    bool loadRawPatchData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawBoundaryFile, QString patchName);
     void clearAllData();
 
-    QList<QList<double>> pointList;
-    QList<QList<int>> faceList;
-    QList<int> ownerList;
-    QList<double> dataList;
+    bool checkMeshData();
+    bool checkFieldData();
+    bool loadWasCancelled();
+    bool computeDataRange();
+    void applyFieldStats();
+
+    //The full mesh, as read, until the shown faces are found
+    //Points are stored as x, y, z for each point
+    //The points of face n are faceIndices[faceOffsets[n]] to faceIndices[faceOffsets[n+1] - 1]
+    std::vector<double> pointList;
+    std::vector<int> faceOffsets;
+    std::vector<int> faceIndices;
+    std::vector<int> ownerList;
+    std::vector<double> dataList;
+    int cellCount = 0;
+
+    //Set when a single patch is loaded, each patch face is then its own owner
+    QByteArray loadedPatchName;
+    int loadedPatchSize = 0;
 
     bool readyToDisplay = false;
     QString currentDisplayError;
+    std::function<bool()> myCancelCheck;
 
+    //Bounds of the points of the shown faces
     QRectF modelBounds2D;
+    double modelLowZ = 0.0;
+    double modelHighZ = 0.0;
     int myDisplayWidth;
     int myDisplayHeight;
+    //The range found from the data, and the range currently used for colors
     double lowDataVal;
     double highDataVal;
+    double lowColorVal = 0.0;
+    double highColorVal = 1.0;
+    CFDfieldStats fieldStats;
+    double clipPercent = 0.1;
 
     constexpr static const double PRECISION = 0.000000001;
 
 private:
+    static void computeMagnitudes(const std::vector<double> &vectorList, std::vector<double> * magnitudeList);
+
+    static void getMapColor(CFDcolorMap aMap, double dataVal, GLubyte * colorOut);
+    //The range given to the shader, returns true if it is a log scale
+    bool getShaderRange(double * rangeLow, double * rangeHigh);
+
+    void buildFaceSet();
+    void updateFaceValues();
+    void uploadColorMaps();
+    void uploadCornerBuffer();
+    void uploadFillBuffers();
+    void uploadEdgeBuffers();
+    void bindFillAttributes();
+    void bindEdgeAttributes();
+    void releaseMeshBuffers();
+    void releaseGLResources();
+
+    //The faces for which isFaceShown is true
+    //On the GPU, each face corner is its own vertex, with its face's data value, so that faces are drawn in one flat color
+    CFDshownMesh shownMesh;
+    //Triangles and line pairs are indices into the corners, which are numbered as shownMesh.faceIndices
+    GLsizei fillIndexCount = 0;
+    GLsizei edgeIndexCount = 0;
+
+    QOpenGLShaderProgram * meshProgram = nullptr;
+    QOpenGLVertexArrayObject fillVAO;
+    QOpenGLVertexArrayObject edgeVAO;
+    QOpenGLBuffer cornerVertexBuffer;
+    QOpenGLBuffer fillValueBuffer;
+    QOpenGLBuffer fillIndexBuffer;
+    QOpenGLBuffer edgeIndexBuffer;
+    bool buffersStale = true;
+    bool valuesStale = true;
+
+    //Each color map is one row of the texture, the fragment shader looks up the color for each data value
+    GLuint colorMapTexture = 0;
+    CFDcolorMap currentColorMap = CFDcolorMap::BLUE_RED;
+    bool useLogScale = false;
+    QMetaObject::Connection contextConnection;
+
+    static const int VERTEX_ATTRIB = 0;
+    static const int VALUE_ATTRIB = 1;
+    static const int COLOR_MAP_WIDTH = 256;
+    static const int COLOR_MAP_COUNT = 3;
+
     virtual void recomputePerspecMat() = 0;
     virtual void recomputeViewModelMat() = 0;
 };
@@ -44,6 +44,11 @@ bool CFDglCanvas2D::loadMeshData(QByteArray * rawPointFile, QByteArray * rawFace
     return loadRawMeshData(rawPointFile, rawFaceFile, rawOwnerFile);
 }
 
+bool CFDglCanvas2D::loadParsedMeshData(CFDparsedList * pointData, CFDparsedList * faceData, CFDparsedList * ownerData)
+{
+    return takeParsedMeshData(pointData, faceData, ownerData);
+}
+
 void CFDglCanvas2D::mousePressEvent(QMouseEvent *event)
 {
     lastXmousePos = event->x();
@@ -95,90 +100,15 @@ void CFDglCanvas2D::paintGL()
 {
     if (!readyToDisplay) return;
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glLoadMatrixf(projMat.data());
-
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glLoadMatrixf(viewModelMat.data());
-
     glClear(GL_COLOR_BUFFER_BIT);
 
-    if (dataList.isEmpty())
-    {
-        glColor3f(0.0, 0.0, 0.0);
-        glBegin(GL_LINES);
-
-        for (auto faceItr = faceList.cbegin(); faceItr != faceList.cend(); faceItr++)
-        {
-            QList<int> aFace = (*faceItr);
-            bool allZ0 = isAllZ0(aFace);
-
-            if (allZ0)
-            {
-                glVertex3f(static_cast<GLfloat>(pointList.at(aFace.last()).at(0)),
-                           static_cast<GLfloat>(pointList.at(aFace.last()).at(1)),0.0);
-                glVertex3f(static_cast<GLfloat>(pointList.at(aFace.first()).at(0)),
-                           static_cast<GLfloat>(pointList.at(aFace.first()).at(1)),0.0);
-
-                for (int ind = 1; ind < aFace.size(); ind++)
-                {
-                    glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(0)),
-                               static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(1)),0.0);
-                    glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(0)),
-                               static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(1)),0.0);
-                }
-            }
-        }
-        glEnd();
-        return;
-    }
+    //Without data, only the mesh lines are drawn
+    drawMeshBuffers(projMat * viewModelMat, !dataList.empty(), dataList.empty());
+}
 
-    int indexVal = -1;
-    for (auto faceItr = faceList.cbegin(); faceItr != faceList.cend(); faceItr++)
-    {
-        indexVal++;
-        QList<int> aFace = (*faceItr);
-        bool allZ0 = isAllZ0(aFace);
-
-        if (allZ0)
-        {
-            double rawData = dataList.at(ownerList.at(indexVal)); //TODO: Probably should check bounds
-
-            double dataVal = (rawData - lowDataVal) / (highDataVal - lowDataVal);
-
-            glBegin(GL_POLYGON);
-            double redVal = 1.0;
-            double greenVal = 0.0;
-            double blueVal = 1.0;
-
-            if (dataVal > 1.0) dataVal = 1.0;
-            else if (dataVal < 0.0) dataVal = 0.0;
-
-            if (dataVal > 0.5)
-            {
-                blueVal = 0.3 + 0.7 * ((1.0 - dataVal) / 0.5);
-                greenVal = 0.3 + 0.7 * ((1.0 - dataVal) / 0.5);
-            }
-            else
-            {
-                redVal = 0.3 + 0.7 * (dataVal / 0.5);
-                greenVal = 0.3 + 0.7 * (dataVal / 0.5);
-            }
-
-            glColor3f(static_cast<GLfloat>(redVal),
-                      static_cast<GLfloat>(greenVal),
-                      static_cast<GLfloat>(blueVal));
-
-            for (int ind = 0; ind < aFace.size(); ind++)
-            {
-                glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(0)),
-                           static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(1)),0.0);
-            }
-            glEnd();
-        }
-    }
+bool CFDglCanvas2D::isFaceShown(int faceIndex)
+{
+    return isAllZ0(faceIndex);
 }
 
 void CFDglCanvas2D::recomputePerspecMat()
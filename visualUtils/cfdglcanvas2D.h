@@ -45,6 +45,7 @@ public:
     ~CFDglCanvas2D();
 
     bool loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile);
+    bool loadParsedMeshData(CFDparsedList * pointData, CFDparsedList * faceData, CFDparsedList * ownerData);
 
 protected:
     virtual void mousePressEvent(QMouseEvent *event);
@@ -53,6 +54,7 @@ protected:
     virtual void wheelEvent(QWheelEvent *event);
 
     virtual void paintGL();
+    virtual bool isFaceShown(int faceIndex);
 
 private:
     constexpr static const double ZOOMFACTOR2D = 650.0;
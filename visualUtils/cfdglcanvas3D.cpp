@@ -43,61 +43,44 @@ bool CFDglCanvas3D::loadMeshData(QByteArray * rawPointFile, QByteArray * rawFace
 {
     if (!loadRawMeshData(rawPointFile, rawFaceFile, rawOwnerFile)) return false;
 
-    double highz = pointList.at(0).at(2);
-    double lowz = pointList.at(0).at(2);
+    computeCenterZ();
+    return true;
+}
 
-    for (auto itr = pointList.cbegin(); itr != pointList.cend(); itr++)
-    {
-        double zVal = (*itr).at(2);
+bool CFDglCanvas3D::loadParsedMeshData(CFDparsedList * pointData, CFDparsedList * faceData, CFDparsedList * ownerData)
+{
+    if (!takeParsedMeshData(pointData, faceData, ownerData)) return false;
 
-        if (zVal > highz) highz = zVal;
-        if (zVal < lowz) lowz = zVal;
-    }
+    computeCenterZ();
+    return true;
+}
 
-    centerz = lowz + (highz - lowz)/2.0;
+bool CFDglCanvas3D::loadPatchMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawBoundaryFile, QString patchName)
+{
+    if (!loadRawPatchData(rawPointFile, rawFaceFile, rawBoundaryFile, patchName)) return false;
 
+    computeCenterZ();
     return true;
 }
 
+void CFDglCanvas3D::computeCenterZ()
+{
+    //Note: The z range is found with the model bounds
+    centerz = modelLowZ + (modelHighZ - modelLowZ)/2.0;
+}
+
 void CFDglCanvas3D::paintGL()
 {
     if (!readyToDisplay) return;
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glLoadMatrixf(projMat.data());
-
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glLoadMatrixf(viewModelMat.data());
-
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glColor3f(0.0, 0.0, 0.0);
-    glBegin(GL_LINES);
-
-    for (auto faceItr = faceList.cbegin(); faceItr != faceList.cend(); faceItr++)
-    {
-        QList<int> aFace = (*faceItr);
-
-        glVertex3f(static_cast<GLfloat>(pointList.at(aFace.last()).at(0)),
-                   static_cast<GLfloat>(pointList.at(aFace.last()).at(1)),
-                   static_cast<GLfloat>(pointList.at(aFace.last()).at(2)));
-        glVertex3f(static_cast<GLfloat>(pointList.at(aFace.first()).at(0)),
-                   static_cast<GLfloat>(pointList.at(aFace.first()).at(1)),
-                   static_cast<GLfloat>(pointList.at(aFace.first()).at(2)));
-
-        for (int ind = 1; ind < aFace.size(); ind++)
-        {
-            glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(0)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(1)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(2)));
-            glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(0)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(1)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(2)));
-        }
-    }
-    glEnd();
+    drawMeshBuffers(projMat * viewModelMat, !dataList.empty(), true);
+}
+
+bool CFDglCanvas3D::isFaceShown(int)
+{
+    return true;
 }
 
 void CFDglCanvas3D::recomputePerspecMat()
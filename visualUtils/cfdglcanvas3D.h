@@ -45,6 +45,8 @@ public:
     ~CFDglCanvas3D();
 
     bool loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile);
+    bool loadParsedMeshData(CFDparsedList * pointData, CFDparsedList * faceData, CFDparsedList * ownerData);
+    bool loadPatchMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawBoundaryFile, QString patchName);
 
 protected:
     //virtual void mousePressEvent(QMouseEvent *event);
@@ -53,11 +55,14 @@ protected:
     //virtual void wheelEvent(QWheelEvent *event);
 
     virtual void paintGL();
+    virtual bool isFaceShown(int faceIndex);
 
 private:
     virtual void recomputePerspecMat();
     virtual void recomputeViewModelMat();
 
+    void computeCenterZ();
+
     QMatrix4x4 projMat;
     QMatrix4x4 viewModelMat;
 
@@ -0,0 +1,112 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdhistogramlegend.h"
+
+#include "cfdglcanvas.h"
+#include "cfdfieldstats.h"
+
+#include <QPainter>
+
+#include <cmath>
+
+CFDhistogramLegend::CFDhistogramLegend(CFDglCanvas * theCanvas, QWidget *parent) : QWidget(parent)
+{
+    myCanvas = theCanvas;
+    setMinimumHeight(60);
+}
+
+CFDhistogramLegend::~CFDhistogramLegend() {}
+
+void CFDhistogramLegend::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+
+    const CFDfieldStats &theStats = myCanvas->getFieldStats();
+    if (theStats.isEmpty()) return;
+
+    int textHeight = painter.fontMetrics().height();
+    QRectF barArea(0, 0, width(), height() - textHeight);
+    if ((barArea.width() < 1.0) || (barArea.height() < 1.0)) return;
+
+    //The stats bins are summed into fewer bars for display
+    const std::vector<qint64> &binCounts = theStats.getBins();
+    int binsPerBar = CFDfieldStats::BIN_COUNT / SHOWN_BAR_COUNT;
+    std::vector<qint64> barCounts(SHOWN_BAR_COUNT, 0);
+    qint64 highCount = 0;
+    for (int ind = 0; ind < SHOWN_BAR_COUNT; ind++)
+    {
+        for (int binInd = ind * binsPerBar; binInd < (ind + 1) * binsPerBar; binInd++)
+        {
+            barCounts[ind] += binCounts[static_cast<size_t>(binInd)];
+        }
+        highCount = qMax(highCount, barCounts[ind]);
+    }
+
+    double lowVal = theStats.getMin();
+    double highVal = theStats.getMax();
+    double barWidth = barArea.width() / SHOWN_BAR_COUNT;
+    double logHighCount = log(1.0 + highCount);
+
+    painter.setPen(Qt::NoPen);
+    for (int ind = 0; ind < SHOWN_BAR_COUNT; ind++)
+    {
+        if (barCounts[ind] == 0) continue;
+
+        double barHeight = barArea.height() * log(1.0 + barCounts[ind]) / logHighCount;
+        double barCenter = lowVal + (highVal - lowVal) * (ind + 0.5) / SHOWN_BAR_COUNT;
+
+        painter.setBrush(myCanvas->getValueColor(barCenter));
+        painter.drawRect(QRectF(barArea.left() + ind * barWidth, barArea.bottom() - barHeight, barWidth, barHeight));
+    }
+
+    //Lines mark the ends of the color range
+    if (highVal > lowVal)
+    {
+        painter.setPen(Qt::black);
+        for (double rangeEnd : {myCanvas->getColorRangeLow(), myCanvas->getColorRangeHigh()})
+        {
+            if ((rangeEnd < lowVal) || (rangeEnd > highVal)) continue;
+            double lineX = barArea.left() + barArea.width() * (rangeEnd - lowVal) / (highVal - lowVal);
+            painter.drawLine(QPointF(lineX, barArea.top()), QPointF(lineX, barArea.bottom()));
+        }
+    }
+
+    painter.setPen(Qt::black);
+    QRectF textArea(0, barArea.bottom(), width(), textHeight);
+    painter.drawText(textArea, Qt::AlignLeft | Qt::AlignVCenter, QString::number(lowVal, 'g', 6));
+    painter.drawText(textArea, Qt::AlignRight | Qt::AlignVCenter, QString::number(highVal, 'g', 6));
+}
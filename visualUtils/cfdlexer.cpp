@@ -0,0 +1,239 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdlexer.h"
+
+CFDlexer::CFDlexer(const QByteArray * rawInput)
+{
+    myInput = rawInput;
+}
+
+bool CFDlexer::lexify()
+{
+    tokenList.clear();
+    if (myInput == nullptr) return false;
+
+    //Comments are skipped by the tokenizer
+    CFDtokenizer theTokenizer(this);
+    theTokenizer.feed(myInput->constData(), myInput->size());
+    return theTokenizer.finish();
+}
+
+int CFDlexer::getTokenCount() const
+{
+    return static_cast<int>(tokenList.size());
+}
+
+CFDlexType CFDlexer::getKind(int index) const
+{
+    return static_cast<CFDlexType>(tokenList[index].kind);
+}
+
+QByteArray CFDlexer::getStringVal(int index) const
+{
+    const CFDlexToken &aToken = tokenList[index];
+    return QByteArray(myInput->constData() + aToken.offset, aToken.length);
+}
+
+int CFDlexer::getIntVal(int index, bool * ok) const
+{
+    const CFDlexToken &aToken = tokenList[index];
+    if (getKind(index) != CFDlexType::WORD)
+    {
+        if (ok != nullptr) *ok = false;
+        return 0;
+    }
+    return QByteArray::fromRawData(myInput->constData() + aToken.offset, aToken.length).toInt(ok);
+}
+
+double CFDlexer::getFloatVal(int index, bool * ok) const
+{
+    const CFDlexToken &aToken = tokenList[index];
+    if (getKind(index) != CFDlexType::WORD)
+    {
+        if (ok != nullptr) *ok = false;
+        return 0.0;
+    }
+    return QByteArray::fromRawData(myInput->constData() + aToken.offset, aToken.length).toDouble(ok);
+}
+
+const char * CFDlexer::getTokenData(int index) const
+{
+    return myInput->constData() + tokenList[index].offset;
+}
+
+int CFDlexer::getTokenLength(int index) const
+{
+    return static_cast<int>(tokenList[index].length);
+}
+
+int CFDlexer::findLargestList() const
+{
+    int ret = -1;
+    int refSize = -1;
+
+    int index = skipSizePrefix(0);
+    while (index < getTokenCount())
+    {
+        if (getKind(index) == CFDlexType::OPEN_PAREN)
+        {
+            bool sizeOK = false;
+            int listSize = getListSize(index, &sizeOK);
+            if (sizeOK && (listSize > refSize))
+            {
+                ret = index;
+                refSize = listSize;
+            }
+        }
+        index = getNextEntry(index);
+    }
+
+    return ret;
+}
+
+int CFDlexer::getListEnd(int openIndex) const
+{
+    if ((openIndex < 0) || (openIndex >= getTokenCount())) return -1;
+    if (getKind(openIndex) != CFDlexType::OPEN_PAREN) return -1;
+
+    int nowDepth = 0;
+    for (int index = openIndex; index < getTokenCount(); index++)
+    {
+        CFDlexType aKind = getKind(index);
+        if ((aKind == CFDlexType::OPEN_PAREN) || (aKind == CFDlexType::OPEN_BRACE))
+        {
+            nowDepth++;
+        }
+        else if ((aKind == CFDlexType::CLOSE_PAREN) || (aKind == CFDlexType::CLOSE_BRACE))
+        {
+            nowDepth--;
+            if (nowDepth == 0)
+            {
+                if (aKind != CFDlexType::CLOSE_PAREN) return -1;
+                return index;
+            }
+        }
+    }
+    return -1;
+}
+
+int CFDlexer::getListSize(int openIndex, bool * ok) const
+{
+    if (ok != nullptr) *ok = false;
+
+    int endIndex = getListEnd(openIndex);
+    if (endIndex == -1) return 0;
+
+    int ret = 0;
+    for (int index = getFirstEntry(openIndex); index < endIndex; index = getNextEntry(index))
+    {
+        ret++;
+    }
+
+    if (isSizePrefix(openIndex - 1))
+    {
+        if (getIntVal(openIndex - 1) != ret) return ret;
+    }
+
+    if (ok != nullptr) *ok = true;
+    return ret;
+}
+
+int CFDlexer::getFirstEntry(int openIndex) const
+{
+    return skipSizePrefix(openIndex + 1);
+}
+
+int CFDlexer::getNextEntry(int index) const
+{
+    CFDlexType aKind = getKind(index);
+
+    if ((aKind == CFDlexType::OPEN_PAREN) || (aKind == CFDlexType::OPEN_BRACE))
+    {
+        int nowDepth = 0;
+        for (int endIndex = index; endIndex < getTokenCount(); endIndex++)
+        {
+            CFDlexType endKind = getKind(endIndex);
+            if ((endKind == CFDlexType::OPEN_PAREN) || (endKind == CFDlexType::OPEN_BRACE))
+            {
+                nowDepth++;
+            }
+            else if ((endKind == CFDlexType::CLOSE_PAREN) || (endKind == CFDlexType::CLOSE_BRACE))
+            {
+                nowDepth--;
+                if (nowDepth == 0)
+                {
+                    return skipSizePrefix(endIndex + 1);
+                }
+            }
+        }
+        return getTokenCount();
+    }
+
+    return skipSizePrefix(index + 1);
+}
+
+void CFDlexer::receiveToken(CFDlexType kind, qint64 offset, const char * text, int length)
+{
+    Q_UNUSED(text);
+    addToken(static_cast<int>(offset), length, kind);
+}
+
+void CFDlexer::addToken(int offset, int length, CFDlexType kind)
+{
+    CFDlexToken newToken;
+    newToken.offset = static_cast<quint32>(offset);
+    newToken.length = static_cast<quint32>(length);
+    newToken.kind = static_cast<quint32>(kind);
+    tokenList.push_back(newToken);
+}
+
+bool CFDlexer::isSizePrefix(int index) const
+{
+    //A size prefix is an int directly before a list: N ( ... )
+    if ((index < 0) || (index + 1 >= getTokenCount())) return false;
+    if (getKind(index) != CFDlexType::WORD) return false;
+    if (getKind(index + 1) != CFDlexType::OPEN_PAREN) return false;
+
+    bool isInt = false;
+    getIntVal(index, &isInt);
+    return isInt;
+}
+
+int CFDlexer::skipSizePrefix(int index) const
+{
+    if (isSizePrefix(index)) return index + 1;
+    return index;
+}
@@ -0,0 +1,90 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDLEXER_H
+#define CFDLEXER_H
+
+#include <QByteArray>
+
+#include "cfdtokenizer.h"
+
+#include <vector>
+
+//Note: The lexer does not copy its input. Tokens are offset/length records
+//into the original buffer, which must outlive the lexer.
+//Numeric values are only converted when asked for.
+
+struct CFDlexToken
+{
+    quint32 offset;
+    quint32 length : 29;
+    quint32 kind : 3;
+};
+
+class CFDlexer : private CFDtokenSink
+{
+public:
+    explicit CFDlexer(const QByteArray * rawInput);
+
+    bool lexify();
+
+    int getTokenCount() const;
+    CFDlexType getKind(int index) const;
+    QByteArray getStringVal(int index) const;
+    int getIntVal(int index, bool * ok = nullptr) const;
+    double getFloatVal(int index, bool * ok = nullptr) const;
+
+    //Raw view of a token, valid as long as the input is
+    const char * getTokenData(int index) const;
+    int getTokenLength(int index) const;
+
+    //Lists are referred to by the index of their opening paren
+    int findLargestList() const;
+    int getListEnd(int openIndex) const;
+    int getListSize(int openIndex, bool * ok = nullptr) const;
+    int getFirstEntry(int openIndex) const;
+    int getNextEntry(int index) const;
+    bool isSizePrefix(int index) const;
+
+private:
+    void receiveToken(CFDlexType kind, qint64 offset, const char * text, int length) override;
+    void addToken(int offset, int length, CFDlexType kind);
+    int skipSizePrefix(int index) const;
+
+    const QByteArray * myInput;
+    std::vector<CFDlexToken> tokenList;
+};
+
+#endif // CFDLEXER_H
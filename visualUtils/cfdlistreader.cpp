@@ -0,0 +1,1077 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdlistreader.h"
+
+#include "cfdnumberparser.h"
+
+#include <QtEndian>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+//Lists at least this long are read in parallel
+const qint64 PARALLEL_LIST_BYTES = 8 * 1024 * 1024;
+const qint64 MIN_CHUNK_BYTES = 1024 * 1024;
+
+struct CFDlistChunk
+{
+    const char * startPos = nullptr;
+    const char * stopPos = nullptr;
+    const char * endPos = nullptr;
+    bool readOk = false;
+
+    std::vector<double> doubleVals;
+    std::vector<int> labelVals;
+    std::vector<int> faceOffsets;
+    CFDlistOutput output;
+
+    int entryBase = 0;
+    size_t doubleBase = 0;
+    size_t labelBase = 0;
+};
+
+CFDlistReader::CFDlistReader(const QByteArray * rawInput)
+{
+    myInput = rawInput;
+    if (rawInput == nullptr) return;
+
+    myStart = rawInput->constData();
+    myPos = myStart;
+    myEnd = myStart + rawInput->size();
+}
+
+bool CFDlistReader::readVectorList(std::vector<double> * values)
+{
+    values->clear();
+    if (!readHeader()) return false;
+    if (!findNextList()) return false;
+
+    return readVectorBody(values, "Point list does not contain points");
+}
+
+bool CFDlistReader::readFaceList(std::vector<int> * faceOffsets, std::vector<int> * faceIndices)
+{
+    faceOffsets->clear();
+    faceIndices->clear();
+    if (!readHeader()) return false;
+    if (!findNextList()) return false;
+
+    if (myFormat.className == "faceCompactList")
+    {
+        return readCompactFaceBody(faceOffsets, faceIndices);
+    }
+    return readFaceBody(faceOffsets, faceIndices);
+}
+
+bool CFDlistReader::readFaceRange(int firstFace, int faceCount, std::vector<int> * faceOffsets, std::vector<int> * faceIndices)
+{
+    faceOffsets->clear();
+    faceIndices->clear();
+    if ((firstFace < 0) || (faceCount < 0)) return readFailure("Face range is not valid");
+    if (!readHeader()) return false;
+    if (!findNextList()) return false;
+
+    if (myFormat.className == "faceCompactList")
+    {
+        return readCompactFaceRange(firstFace, faceCount, faceOffsets, faceIndices);
+    }
+
+    int listSize = -1;
+    bool isUniform = false;
+    if (!beginList(&listSize, &isUniform)) return false;
+    if (isUniform)
+    {
+        return readFailure("Face list does not contain faces");
+    }
+    if ((listSize != -1) && (static_cast<qint64>(firstFace) + faceCount > listSize))
+    {
+        return readFailure("Face range is past the end of the face list");
+    }
+
+    //Faces before the range are only skipped over
+    for (int ind = 0; ind < firstFace; ind++)
+    {
+        if (!skipFace()) return readFailure("Face list does not contain faces");
+    }
+
+    faceOffsets->push_back(0);
+    CFDlistOutput listOutput;
+    listOutput.labelVals = faceIndices;
+    listOutput.faceOffsets = faceOffsets;
+    for (int ind = 0; ind < faceCount; ind++)
+    {
+        if (!readEntry(CFDlistKind::FACE, &listOutput, "Face list does not contain faces")) return false;
+    }
+    return true;
+}
+
+bool CFDlistReader::readLabelList(std::vector<int> * values)
+{
+    values->clear();
+    if (!readHeader()) return false;
+    if (!findNextList()) return false;
+
+    return readLabelBody(values, "Label list does not contain ints");
+}
+
+bool CFDlistReader::readScalarField(std::vector<double> * values)
+{
+    values->clear();
+    if (!findInternalField("List<scalar>")) return false;
+
+    return readScalarBody(values, "Data list does not contain floats");
+}
+
+bool CFDlistReader::readVectorField(std::vector<double> * values)
+{
+    values->clear();
+    if (!findInternalField("List<vector>")) return false;
+
+    return readVectorBody(values, "Data list does not contain float arrays");
+}
+
+bool CFDlistReader::readScalarPatch(const QByteArray &patchName, int patchSize, std::vector<double> * values)
+{
+    values->clear();
+    CFDfieldEntry patchValue;
+    if (!findPatchValue(patchName, "List<scalar>", &patchValue)) return false;
+
+    if (patchValue.kind == CFDfieldKind::UNIFORM)
+    {
+        if (patchValue.uniformValue.size() != 1) return readFailure("Patch value is not a scalar");
+        values->assign(static_cast<size_t>(patchSize), patchValue.uniformValue[0]);
+        return true;
+    }
+
+    if (!readScalarBody(values, "Data list does not contain floats")) return false;
+    if (values->size() != static_cast<size_t>(patchSize))
+    {
+        return readFailure("Patch data does not match patch size");
+    }
+    return true;
+}
+
+bool CFDlistReader::readVectorPatch(const QByteArray &patchName, int patchSize, std::vector<double> * values)
+{
+    values->clear();
+    CFDfieldEntry patchValue;
+    if (!findPatchValue(patchName, "List<vector>", &patchValue)) return false;
+
+    if (patchValue.kind == CFDfieldKind::UNIFORM)
+    {
+        if (patchValue.uniformValue.size() != 3) return readFailure("Patch value is not a vector");
+        values->reserve(3 * static_cast<size_t>(patchSize));
+        for (int ind = 0; ind < patchSize; ind++)
+        {
+            values->insert(values->end(), patchValue.uniformValue.begin(), patchValue.uniformValue.end());
+        }
+        return true;
+    }
+
+    if (!readVectorBody(values, "Data list does not contain float arrays")) return false;
+    if (values->size() != 3 * static_cast<size_t>(patchSize))
+    {
+        return readFailure("Patch data does not match patch size");
+    }
+    return true;
+}
+
+CFDfoamFormat CFDlistReader::getFormat()
+{
+    return myFormat;
+}
+
+QString CFDlistReader::getReadError()
+{
+    return readError;
+}
+
+bool CFDlistReader::readHeader()
+{
+    myPos = myStart;
+    if (myPos == nullptr) return readFailure("Unable to read file");
+
+    CFDfoamDict headerDict(myInput);
+    if (!headerDict.readHeader()) return readFailure(headerDict.getReadError());
+
+    myFormat = headerDict.getFormat();
+    myPos = myStart + headerDict.getHeaderEnd();
+    return true;
+}
+
+bool CFDlistReader::findNextList()
+{
+    //Mesh files are a FoamFile header, followed by a list: N ( ... )
+    //faceCompactList files have two lists, one after the other
+    if (myPos == nullptr) return readFailure("Unable to read mesh data files");
+
+    while (true)
+    {
+        skipSpace();
+        if (myPos >= myEnd) return readFailure("Unable to locate mesh data in files");
+
+        char aLetter = *myPos;
+        if (aLetter == '(')
+        {
+            return true;
+        }
+        if (aLetter == '{')
+        {
+            if (!skipGroup()) return readFailure("Unable to read mesh data files");
+            continue;
+        }
+        if ((aLetter == ')') || (aLetter == '}'))
+        {
+            return readFailure("Unable to read mesh data files");
+        }
+        if (aLetter == ';')
+        {
+            myPos++;
+            continue;
+        }
+
+        const char * wordStart = myPos;
+        QByteArray aWord = readWord();
+        bool isInt = false;
+        aWord.toInt(&isInt);
+        if (!isInt) continue;
+
+        skipSpace();
+        if ((myPos < myEnd) && ((*myPos == '(') || (*myPos == '{')))
+        {
+            myPos = wordStart;
+            return true;
+        }
+    }
+}
+
+bool CFDlistReader::findInternalField(const char * listType)
+{
+    //The field's dictionary is read first, so that large boundaryField lists
+    //can never be mistaken for the data, and the list is gone to directly
+    if (myStart == nullptr) return readFailure("Unable to read data file");
+
+    CFDfoamDict fieldDict(myInput);
+    if (!fieldDict.readDict()) return readFailure(fieldDict.getReadError());
+    myFormat = fieldDict.getFormat();
+
+    CFDfieldEntry internalField = fieldDict.getInternalField();
+    if (internalField.kind == CFDfieldKind::MISSING)
+    {
+        return readFailure("Unable to locate data in data file");
+    }
+    if (internalField.kind == CFDfieldKind::UNIFORM)
+    {
+        return readFailure("Data file has a uniform internal field");
+    }
+    if (internalField.listType != listType)
+    {
+        return readFailure("Data list is not of the expected type");
+    }
+
+    myPos = myStart + internalField.listStart;
+    return true;
+}
+
+bool CFDlistReader::findPatchValue(const QByteArray &patchName, const char * listType, CFDfieldEntry * patchValue)
+{
+    if (myStart == nullptr) return readFailure("Unable to read data file");
+
+    CFDfoamDict fieldDict(myInput);
+    if (!fieldDict.readDict()) return readFailure(fieldDict.getReadError());
+    myFormat = fieldDict.getFormat();
+
+    for (const CFDpatchField &aPatch : fieldDict.getBoundaryField())
+    {
+        if (aPatch.patchName != patchName) continue;
+
+        *patchValue = aPatch.value;
+        if (patchValue->kind == CFDfieldKind::MISSING)
+        {
+            return readFailure("Patch has no stored values");
+        }
+        if (patchValue->kind == CFDfieldKind::NONUNIFORM)
+        {
+            if (patchValue->listType != listType)
+            {
+                return readFailure("Data list is not of the expected type");
+            }
+            myPos = myStart + patchValue->listStart;
+        }
+        return true;
+    }
+
+    return readFailure("Patch not found in data file");
+}
+
+bool CFDlistReader::beginList(int * listSize, bool * isUniform)
+{
+    *listSize = -1;
+    *isUniform = false;
+
+    skipSpace();
+    if ((myPos < myEnd) && (*myPos != '('))
+    {
+        if (!readInt(listSize) || (*listSize < 0))
+        {
+            return readFailure("Unable to read list size");
+        }
+    }
+
+    skipSpace();
+    if (myPos >= myEnd)
+    {
+        return readFailure("List is not closed");
+    }
+
+    //Note: for binary lists, the data starts right after the paren
+    if (*myPos == '(')
+    {
+        myPos++;
+        if (myFormat.isBinary && (*listSize == -1))
+        {
+            return readFailure("Binary list has no size");
+        }
+        return true;
+    }
+
+    //Lists of identical entries can be written as N{value}
+    if ((*myPos == '{') && (*listSize != -1))
+    {
+        myPos++;
+        *isUniform = true;
+        return true;
+    }
+
+    return readFailure("Unable to locate list data");
+}
+
+bool CFDlistReader::endList(int listSize, int foundSize)
+{
+    if (myPos >= myEnd)
+    {
+        return readFailure("List is not closed");
+    }
+    myPos++;
+
+    if ((listSize != -1) && (listSize != foundSize))
+    {
+        return readFailure("List size does not match its header");
+    }
+    return true;
+}
+
+bool CFDlistReader::readVectorBody(std::vector<double> * values, const char * errorText)
+{
+    int listSize = -1;
+    bool isUniform = false;
+    if (!beginList(&listSize, &isUniform)) return false;
+    if (listSize > 0) values->reserve(3 * static_cast<size_t>(listSize));
+
+    if (isUniform)
+    {
+        double aVector[3];
+        if (myFormat.isBinary)
+        {
+            std::vector<double> rawVector;
+            if (!readBinaryScalars(3, &rawVector)) return readFailure(errorText);
+            std::copy(rawVector.begin(), rawVector.end(), aVector);
+        }
+        else if (!readVector(aVector))
+        {
+            return readFailure(errorText);
+        }
+        if (!expectChar('}')) return readFailure("List is not closed");
+
+        for (int ind = 0; ind < listSize; ind++)
+        {
+            values->insert(values->end(), aVector, aVector + 3);
+        }
+        return true;
+    }
+
+    if (myFormat.isBinary)
+    {
+        if (!readBinaryScalars(3 * listSize, values)) return readFailure(errorText);
+        if (!expectChar(')')) return readFailure("List is not closed");
+        return true;
+    }
+
+    CFDlistOutput listOutput;
+    listOutput.doubleVals = values;
+    return readEntryList(CFDlistKind::VECTOR, listSize, &listOutput, errorText);
+}
+
+bool CFDlistReader::readScalarBody(std::vector<double> * values, const char * errorText)
+{
+    int listSize = -1;
+    bool isUniform = false;
+    if (!beginList(&listSize, &isUniform)) return false;
+    if (listSize > 0) values->reserve(static_cast<size_t>(listSize));
+
+    if (isUniform)
+    {
+        double aValue;
+        if (myFormat.isBinary)
+        {
+            std::vector<double> rawValue;
+            if (!readBinaryScalars(1, &rawValue)) return readFailure(errorText);
+            aValue = rawValue.front();
+        }
+        else if (!readDouble(&aValue))
+        {
+            return readFailure(errorText);
+        }
+        if (!expectChar('}')) return readFailure("List is not closed");
+
+        values->assign(static_cast<size_t>(listSize), aValue);
+        return true;
+    }
+
+    if (myFormat.isBinary)
+    {
+        if (!readBinaryScalars(listSize, values)) return readFailure(errorText);
+        if (!expectChar(')')) return readFailure("List is not closed");
+        return true;
+    }
+
+    CFDlistOutput listOutput;
+    listOutput.doubleVals = values;
+    return readEntryList(CFDlistKind::SCALAR, listSize, &listOutput, errorText);
+}
+
+bool CFDlistReader::readLabelBody(std::vector<int> * values, const char * errorText)
+{
+    int listSize = -1;
+    bool isUniform = false;
+    if (!beginList(&listSize, &isUniform)) return false;
+    if (listSize > 0) values->reserve(static_cast<size_t>(listSize));
+
+    if (isUniform)
+    {
+        int aLabel;
+        if (myFormat.isBinary)
+        {
+            std::vector<int> rawLabel;
+            if (!readBinaryLabels(1, &rawLabel)) return readFailure(errorText);
+            aLabel = rawLabel.front();
+        }
+        else if (!readInt(&aLabel))
+        {
+            return readFailure(errorText);
+        }
+        if (!expectChar('}')) return readFailure("List is not closed");
+
+        values->assign(static_cast<size_t>(listSize), aLabel);
+        return true;
+    }
+
+    if (myFormat.isBinary)
+    {
+        if (!readBinaryLabels(listSize, values)) return readFailure(errorText);
+        if (!expectChar(')')) return readFailure("List is not closed");
+        return true;
+    }
+
+    CFDlistOutput listOutput;
+    listOutput.labelVals = values;
+    return readEntryList(CFDlistKind::LABEL, listSize, &listOutput, errorText);
+}
+
+bool CFDlistReader::readFaceBody(std::vector<int> * faceOffsets, std::vector<int> * faceIndices)
+{
+    int listSize = -1;
+    bool isUniform = false;
+    if (!beginList(&listSize, &isUniform)) return false;
+    if (isUniform)
+    {
+        return readFailure("Face list does not contain faces");
+    }
+    if (listSize > 0)
+    {
+        //Most faces are quads, so this is usually close
+        faceOffsets->reserve(static_cast<size_t>(listSize) + 1);
+        faceIndices->reserve(4 * static_cast<size_t>(listSize));
+    }
+    faceOffsets->push_back(0);
+
+    CFDlistOutput listOutput;
+    listOutput.labelVals = faceIndices;
+    listOutput.faceOffsets = faceOffsets;
+    return readEntryList(CFDlistKind::FACE, listSize, &listOutput, "Face list does not contain faces");
+}
+
+bool CFDlistReader::readCompactFaceBody(std::vector<int> * faceOffsets, std::vector<int> * faceIndices)
+{
+    //faceCompactList is already CSR: a list of offsets, then a list of point indices
+    if (!readLabelBody(faceOffsets, "Face offset list does not contain ints")) return false;
+    if (!findNextList()) return false;
+    if (!readLabelBody(faceIndices, "Face list does not contain ints")) return false;
+
+    if (faceOffsets->empty() || (faceOffsets->front() != 0) ||
+            (faceOffsets->back() != static_cast<int>(faceIndices->size())))
+    {
+        return readFailure("Face offset list does not match face list");
+    }
+
+    for (size_t ind = 1; ind < faceOffsets->size(); ind++)
+    {
+        if ((*faceOffsets)[ind] <= (*faceOffsets)[ind - 1])
+        {
+            return readFailure("Face list does not contain faces");
+        }
+    }
+    return true;
+}
+
+bool CFDlistReader::readEntryList(CFDlistKind kind, int listSize, CFDlistOutput * output, const char * errorText)
+{
+    //Binary faceLists also come here, but cannot be split at line breaks
+    const char * bodyStart = myPos;
+    if (!myFormat.isBinary && ((myEnd - bodyStart) >= PARALLEL_LIST_BYTES) && (QThread::idealThreadCount() > 1))
+    {
+        if (readParallelList(kind, listSize, output)) return true;
+
+        //Lists which cannot be split cleanly are read again in order, which also gives the error
+        myPos = bodyStart;
+        output->entryCount = 0;
+        if (output->doubleVals != nullptr) output->doubleVals->clear();
+        if (output->labelVals != nullptr) output->labelVals->clear();
+        if (output->faceOffsets != nullptr) output->faceOffsets->assign(1, 0);
+    }
+
+    if (!readEntries(kind, myEnd, output, errorText)) return false;
+    return endList(listSize, output->entryCount);
+}
+
+bool CFDlistReader::readParallelList(CFDlistKind kind, int listSize, CFDlistOutput * output)
+{
+    //Big lists are written one entry per line, so each piece starts at the first entry of a line.
+    //A piece ends where the next one starts, any entry running past that means the split was bad.
+    const char * bodyStart = myPos;
+    qint64 bodyBytes = myEnd - bodyStart;
+    int chunkCount = qMin(QThread::idealThreadCount() * 4, static_cast<int>(bodyBytes / MIN_CHUNK_BYTES));
+
+    std::vector<CFDlistChunk> chunkList(static_cast<size_t>(chunkCount));
+    const char * chunkStart = bodyStart;
+    for (int ind = 0; ind < chunkCount; ind++)
+    {
+        CFDlistChunk & aChunk = chunkList[static_cast<size_t>(ind)];
+        aChunk.startPos = chunkStart;
+        aChunk.stopPos = myEnd;
+
+        if (ind < chunkCount - 1)
+        {
+            const char * splitPos = bodyStart + bodyBytes * (ind + 1) / chunkCount;
+            if (splitPos < chunkStart) splitPos = chunkStart;
+            const void * lineEnd = memchr(splitPos, '\n', static_cast<size_t>(myEnd - splitPos));
+            if (lineEnd != nullptr)
+            {
+                myPos = static_cast<const char *>(lineEnd) + 1;
+                skipSpace();
+                aChunk.stopPos = myPos;
+            }
+        }
+        chunkStart = aChunk.stopPos;
+
+        if (output->doubleVals != nullptr) aChunk.output.doubleVals = &aChunk.doubleVals;
+        if (output->labelVals != nullptr) aChunk.output.labelVals = &aChunk.labelVals;
+        if (output->faceOffsets != nullptr) aChunk.output.faceOffsets = &aChunk.faceOffsets;
+
+        //Pre-size by this piece's share of the list
+        if (listSize > 0)
+        {
+            size_t entryGuess = static_cast<size_t>(listSize * (aChunk.stopPos - aChunk.startPos) / bodyBytes) + 1;
+            if (kind == CFDlistKind::VECTOR) aChunk.doubleVals.reserve(3 * entryGuess);
+            else if (kind == CFDlistKind::SCALAR) aChunk.doubleVals.reserve(entryGuess);
+            else if (kind == CFDlistKind::LABEL) aChunk.labelVals.reserve(entryGuess);
+            else
+            {
+                aChunk.labelVals.reserve(4 * entryGuess);
+                aChunk.faceOffsets.reserve(entryGuess);
+            }
+        }
+    }
+    myPos = bodyStart;
+
+    QtConcurrent::blockingMap(chunkList, [this, kind](CFDlistChunk & aChunk)
+    {
+        CFDlistReader chunkReader(*this);
+        chunkReader.myPos = aChunk.startPos;
+        aChunk.readOk = chunkReader.readEntries(kind, aChunk.stopPos, &aChunk.output, "");
+        aChunk.endPos = chunkReader.myPos;
+    });
+
+    //The list ends in the first piece which stopped at a ')'
+    int totalCount = 0;
+    size_t doubleCount = 0;
+    size_t labelCount = 0;
+    int lastChunk = -1;
+    for (int ind = 0; ind < chunkCount; ind++)
+    {
+        CFDlistChunk & aChunk = chunkList[static_cast<size_t>(ind)];
+        if (!aChunk.readOk) return false;
+
+        aChunk.entryBase = totalCount;
+        aChunk.doubleBase = doubleCount;
+        aChunk.labelBase = labelCount;
+        totalCount += aChunk.output.entryCount;
+        doubleCount += aChunk.doubleVals.size();
+        labelCount += aChunk.labelVals.size();
+
+        if (aChunk.endPos < aChunk.stopPos)
+        {
+            lastChunk = ind;
+            break;
+        }
+        if (aChunk.endPos != aChunk.stopPos) return false;
+    }
+    if (lastChunk == -1) return false;
+    if ((listSize != -1) && (listSize != totalCount)) return false;
+
+    chunkList.resize(static_cast<size_t>(lastChunk) + 1);
+    if (output->doubleVals != nullptr) output->doubleVals->resize(doubleCount);
+    if (output->labelVals != nullptr) output->labelVals->resize(labelCount);
+    if (output->faceOffsets != nullptr) output->faceOffsets->resize(static_cast<size_t>(totalCount) + 1);
+
+    QtConcurrent::blockingMap(chunkList, [output](CFDlistChunk & aChunk)
+    {
+        if (output->doubleVals != nullptr)
+        {
+            std::copy(aChunk.doubleVals.begin(), aChunk.doubleVals.end(),
+                      output->doubleVals->begin() + static_cast<qint64>(aChunk.doubleBase));
+        }
+        if (output->labelVals != nullptr)
+        {
+            std::copy(aChunk.labelVals.begin(), aChunk.labelVals.end(),
+                      output->labelVals->begin() + static_cast<qint64>(aChunk.labelBase));
+        }
+        if (output->faceOffsets != nullptr)
+        {
+            int * offsetPtr = output->faceOffsets->data() + 1 + aChunk.entryBase;
+            for (size_t ind = 0; ind < aChunk.faceOffsets.size(); ind++)
+            {
+                offsetPtr[ind] = aChunk.faceOffsets[ind] + static_cast<int>(aChunk.labelBase);
+            }
+        }
+    });
+
+    output->entryCount = totalCount;
+    myPos = chunkList.back().endPos + 1;
+    return true;
+}
+
+bool CFDlistReader::readEntries(CFDlistKind kind, const char * stopPos, CFDlistOutput * output, const char * errorText)
+{
+    skipSpace();
+    while ((myPos < stopPos) && (*myPos != ')'))
+    {
+        if (!readEntry(kind, output, errorText)) return false;
+        output->entryCount++;
+        skipSpace();
+    }
+    return true;
+}
+
+bool CFDlistReader::readEntry(CFDlistKind kind, CFDlistOutput * output, const char * errorText)
+{
+    if (kind == CFDlistKind::LABEL)
+    {
+        int aLabel;
+        if (!readInt(&aLabel)) return readFailure(errorText);
+        output->labelVals->push_back(aLabel);
+        return true;
+    }
+
+    if (kind == CFDlistKind::SCALAR)
+    {
+        double aValue;
+        if (!readDouble(&aValue)) return readFailure(errorText);
+        output->doubleVals->push_back(aValue);
+        return true;
+    }
+
+    if (kind == CFDlistKind::VECTOR)
+    {
+        double aVector[3];
+        if (!readVector(aVector)) return readFailure(errorText);
+        output->doubleVals->insert(output->doubleVals->end(), aVector, aVector + 3);
+        return true;
+    }
+
+    //Note: in binary faceList files, each face is still written as n(...)
+    int faceSize = 0;
+    if (!readInt(&faceSize) || (faceSize < 1) || !expectChar('('))
+    {
+        return readFailure(errorText);
+    }
+
+    std::vector<int> * faceIndices = output->labelVals;
+    if (myFormat.isBinary)
+    {
+        if (!readBinaryLabels(faceSize, faceIndices))
+        {
+            return readFailure("Face list does not contain ints");
+        }
+    }
+    else
+    {
+        for (int ind = 0; ind < faceSize; ind++)
+        {
+            int pointIndex;
+            if (!readInt(&pointIndex))
+            {
+                return readFailure("Face list does not contain ints");
+            }
+            faceIndices->push_back(pointIndex);
+        }
+    }
+
+    if (!expectChar(')'))
+    {
+        return readFailure(errorText);
+    }
+    output->faceOffsets->push_back(static_cast<int>(faceIndices->size()));
+    return true;
+}
+
+bool CFDlistReader::readCompactFaceRange(int firstFace, int faceCount, std::vector<int> * faceOffsets, std::vector<int> * faceIndices)
+{
+    //The offsets list is read whole, and gives where the range is in the index list
+    std::vector<int> allOffsets;
+    if (!readLabelBody(&allOffsets, "Face offset list does not contain ints")) return false;
+    if (static_cast<qint64>(firstFace) + faceCount + 1 > static_cast<qint64>(allOffsets.size()))
+    {
+        return readFailure("Face range is past the end of the face list");
+    }
+
+    int firstIndex = allOffsets[static_cast<size_t>(firstFace)];
+    int indexCount = allOffsets[static_cast<size_t>(firstFace + faceCount)] - firstIndex;
+    if ((firstIndex < 0) || (indexCount < 0))
+    {
+        return readFailure("Face offset list does not match face list");
+    }
+
+    if (!findNextList()) return false;
+    int listSize = -1;
+    bool isUniform = false;
+    if (!beginList(&listSize, &isUniform)) return false;
+    if (isUniform || ((listSize != -1) && (static_cast<qint64>(firstIndex) + indexCount > listSize)))
+    {
+        return readFailure("Face offset list does not match face list");
+    }
+
+    if (myFormat.isBinary)
+    {
+        if ((myEnd - myPos) / myFormat.labelSize < firstIndex) return readFailure("Face list does not contain ints");
+        myPos += static_cast<qint64>(firstIndex) * myFormat.labelSize;
+        if (!readBinaryLabels(indexCount, faceIndices)) return readFailure("Face list does not contain ints");
+    }
+    else
+    {
+        for (int ind = 0; ind < firstIndex; ind++)
+        {
+            skipSpace();
+            const char * wordEnd = CFDnumberParser::findTokenEnd(myPos, myEnd);
+            if (wordEnd == myPos) return readFailure("Face list does not contain ints");
+            myPos = wordEnd;
+        }
+
+        faceIndices->reserve(static_cast<size_t>(indexCount));
+        for (int ind = 0; ind < indexCount; ind++)
+        {
+            int pointIndex;
+            if (!readInt(&pointIndex)) return readFailure("Face list does not contain ints");
+            faceIndices->push_back(pointIndex);
+        }
+    }
+
+    faceOffsets->reserve(static_cast<size_t>(faceCount) + 1);
+    for (int ind = 0; ind <= faceCount; ind++)
+    {
+        faceOffsets->push_back(allOffsets[static_cast<size_t>(firstFace + ind)] - firstIndex);
+        if ((ind > 0) && ((*faceOffsets)[static_cast<size_t>(ind)] <= (*faceOffsets)[static_cast<size_t>(ind - 1)]))
+        {
+            return readFailure("Face list does not contain faces");
+        }
+    }
+    return true;
+}
+
+bool CFDlistReader::skipFace()
+{
+    int faceSize = 0;
+    if (!readInt(&faceSize) || (faceSize < 1) || !expectChar('(')) return false;
+
+    if (myFormat.isBinary)
+    {
+        if ((myEnd - myPos) / myFormat.labelSize < faceSize) return false;
+        myPos += static_cast<qint64>(faceSize) * myFormat.labelSize;
+        return expectChar(')');
+    }
+
+    const void * closePos = memchr(myPos, ')', static_cast<size_t>(myEnd - myPos));
+    if (closePos == nullptr) return false;
+    myPos = static_cast<const char *>(closePos) + 1;
+    return true;
+}
+
+bool CFDlistReader::readBinaryScalars(int count, std::vector<double> * values)
+{
+    if (count < 0) return false;
+    int scalarSize = myFormat.scalarSize;
+    if ((scalarSize != 4) && (scalarSize != 8)) return false;
+
+    size_t byteCount = static_cast<size_t>(count) * static_cast<size_t>(scalarSize);
+    if (static_cast<size_t>(myEnd - myPos) < byteCount) return false;
+
+    size_t oldSize = values->size();
+    values->resize(oldSize + static_cast<size_t>(count));
+    double * destPtr = values->data() + oldSize;
+    const char * srcPtr = myPos;
+
+    bool hostLittleEndian = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+
+    if ((scalarSize == 8) && (myFormat.isLittleEndian == hostLittleEndian))
+    {
+        memcpy(destPtr, srcPtr, byteCount);
+    }
+    else if (scalarSize == 8)
+    {
+        for (int ind = 0; ind < count; ind++, srcPtr += 8)
+        {
+            quint64 rawBits = myFormat.isLittleEndian ? qFromLittleEndian<quint64>(srcPtr) :
+                                                        qFromBigEndian<quint64>(srcPtr);
+            memcpy(&destPtr[ind], &rawBits, 8);
+        }
+    }
+    else
+    {
+        for (int ind = 0; ind < count; ind++, srcPtr += 4)
+        {
+            quint32 rawBits = myFormat.isLittleEndian ? qFromLittleEndian<quint32>(srcPtr) :
+                                                        qFromBigEndian<quint32>(srcPtr);
+            float rawFloat;
+            memcpy(&rawFloat, &rawBits, 4);
+            destPtr[ind] = static_cast<double>(rawFloat);
+        }
+    }
+
+    myPos += byteCount;
+    return true;
+}
+
+bool CFDlistReader::readBinaryLabels(int count, std::vector<int> * values)
+{
+    if (count < 0) return false;
+    int labelSize = myFormat.labelSize;
+    if ((labelSize != 4) && (labelSize != 8)) return false;
+
+    size_t byteCount = static_cast<size_t>(count) * static_cast<size_t>(labelSize);
+    if (static_cast<size_t>(myEnd - myPos) < byteCount) return false;
+
+    size_t oldSize = values->size();
+    values->resize(oldSize + static_cast<size_t>(count));
+    int * destPtr = values->data() + oldSize;
+    const char * srcPtr = myPos;
+
+    bool hostLittleEndian = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+
+    if ((labelSize == 4) && (myFormat.isLittleEndian == hostLittleEndian))
+    {
+        memcpy(destPtr, srcPtr, byteCount);
+    }
+    else if (labelSize == 4)
+    {
+        for (int ind = 0; ind < count; ind++, srcPtr += 4)
+        {
+            destPtr[ind] = myFormat.isLittleEndian ? qFromLittleEndian<qint32>(srcPtr) :
+                                                     qFromBigEndian<qint32>(srcPtr);
+        }
+    }
+    else
+    {
+        //64 bit labels are narrowed, meshes this program can display fit in an int
+        for (int ind = 0; ind < count; ind++, srcPtr += 8)
+        {
+            qint64 rawLabel = myFormat.isLittleEndian ? qFromLittleEndian<qint64>(srcPtr) :
+                                                        qFromBigEndian<qint64>(srcPtr);
+            if ((rawLabel > INT_MAX) || (rawLabel < INT_MIN)) return false;
+            destPtr[ind] = static_cast<int>(rawLabel);
+        }
+    }
+
+    myPos += byteCount;
+    return true;
+}
+
+bool CFDlistReader::readInt(int * value)
+{
+    skipSpace();
+
+    const char * wordEnd = CFDnumberParser::findTokenEnd(myPos, myEnd);
+    qint64 result;
+    if (!CFDnumberParser::parseLabel(myPos, wordEnd, &result)) return false;
+    if ((result > INT_MAX) || (result < INT_MIN)) return false;
+
+    myPos = wordEnd;
+    *value = static_cast<int>(result);
+    return true;
+}
+
+bool CFDlistReader::readDouble(double * value)
+{
+    skipSpace();
+
+    const char * wordEnd = CFDnumberParser::findTokenEnd(myPos, myEnd);
+    if (!CFDnumberParser::parseDouble(myPos, wordEnd, value)) return false;
+
+    myPos = wordEnd;
+    return true;
+}
+
+bool CFDlistReader::readVector(double * value)
+{
+    if (!expectChar('(')) return false;
+    if (!readDouble(&value[0])) return false;
+    if (!readDouble(&value[1])) return false;
+    if (!readDouble(&value[2])) return false;
+    return expectChar(')');
+}
+
+bool CFDlistReader::expectChar(char expected)
+{
+    skipSpace();
+    if ((myPos >= myEnd) || (*myPos != expected)) return false;
+    myPos++;
+    return true;
+}
+
+QByteArray CFDlistReader::readWord()
+{
+    //Quoted strings are returned without their quotes
+    if ((myPos < myEnd) && (*myPos == '"'))
+    {
+        const char * wordStart = myPos + 1;
+        const void * quoteEnd = memchr(wordStart, '"', static_cast<size_t>(myEnd - wordStart));
+        if (quoteEnd == nullptr)
+        {
+            myPos = myEnd;
+            return QByteArray();
+        }
+        myPos = static_cast<const char *>(quoteEnd) + 1;
+        return QByteArray::fromRawData(wordStart, static_cast<int>(myPos - 1 - wordStart));
+    }
+
+    const char * wordStart = myPos;
+    while ((myPos < myEnd) && !isDelimiter(*myPos))
+    {
+        if ((*myPos == '/') && (myPos + 1 < myEnd) &&
+                ((myPos[1] == '/') || (myPos[1] == '*'))) break;
+        myPos++;
+    }
+    return QByteArray::fromRawData(wordStart, static_cast<int>(myPos - wordStart));
+}
+
+bool CFDlistReader::skipGroup()
+{
+    int nowDepth = 0;
+    while (myPos < myEnd)
+    {
+        char aLetter = *myPos;
+        if ((aLetter == '(') || (aLetter == '{'))
+        {
+            nowDepth++;
+        }
+        else if ((aLetter == ')') || (aLetter == '}'))
+        {
+            nowDepth--;
+            if (nowDepth == 0)
+            {
+                myPos++;
+                return true;
+            }
+        }
+        myPos++;
+        skipSpace();
+    }
+    return false;
+}
+
+void CFDlistReader::skipSpace()
+{
+    //Comments can be //
+    /* or have the multiline format */
+    while (myPos < myEnd)
+    {
+        myPos = CFDnumberParser::skipSpace(myPos, myEnd);
+        if (myPos >= myEnd) return;
+
+        char aLetter = *myPos;
+        if ((aLetter == '/') && (myPos + 1 < myEnd) && (myPos[1] == '/'))
+        {
+            const void * lineEnd = memchr(myPos, '\n', static_cast<size_t>(myEnd - myPos));
+            myPos = (lineEnd == nullptr) ? myEnd : static_cast<const char *>(lineEnd);
+            continue;
+        }
+        if ((aLetter == '/') && (myPos + 1 < myEnd) && (myPos[1] == '*'))
+        {
+            const char * searchPos = myPos + 2;
+            while ((searchPos + 1 < myEnd) && !((searchPos[0] == '*') && (searchPos[1] == '/'))) searchPos++;
+            myPos = (searchPos + 1 < myEnd) ? searchPos + 2 : myEnd;
+            continue;
+        }
+        return;
+    }
+}
+
+bool CFDlistReader::isDelimiter(char aLetter)
+{
+    if (std::isspace(static_cast<unsigned char>(aLetter))) return true;
+    if ((aLetter == '(') || (aLetter == ')')) return true;
+    if ((aLetter == '{') || (aLetter == '}')) return true;
+    if (aLetter == ';') return true;
+    return false;
+}
+
+bool CFDlistReader::readFailure(QString errorText)
+{
+    readError = errorText;
+    return false;
+}
@@ -0,0 +1,138 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDLISTREADER_H
+#define CFDLISTREADER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "cfdfoamdict.h"
+
+#include <vector>
+
+//Reads the main data list of polyMesh and field files directly
+//into contiguous arrays, without building a token tree.
+//Faces are stored CSR-style: the points of face n are
+//faceIndices[faceOffsets[n]] to faceIndices[faceOffsets[n+1] - 1]
+
+//Both ASCII and binary (writeFormat binary) files are read,
+//the format is taken from the FoamFile header by CFDfoamDict
+
+//Large ASCII lists are split at line breaks and read on several threads
+//Each piece fills its own CFDlistOutput, which are then joined in order
+
+enum class CFDlistKind {LABEL, SCALAR, VECTOR, FACE};
+
+struct CFDlistOutput
+{
+    std::vector<double> * doubleVals = nullptr;
+    std::vector<int> * labelVals = nullptr;
+    std::vector<int> * faceOffsets = nullptr;
+    int entryCount = 0;
+};
+
+class CFDlistReader
+{
+public:
+    explicit CFDlistReader(const QByteArray * rawInput);
+
+    //For vectorField/pointField and labelList mesh files
+    //Faces may be either faceList or faceCompactList
+    bool readVectorList(std::vector<double> * values);
+    bool readFaceList(std::vector<int> * faceOffsets, std::vector<int> * faceIndices);
+    bool readLabelList(std::vector<int> * values);
+
+    //Reads only faces firstFace to firstFace + faceCount - 1, ex: one boundary patch
+    bool readFaceRange(int firstFace, int faceCount, std::vector<int> * faceOffsets, std::vector<int> * faceIndices);
+
+    //For the internalField of volScalarField/volVectorField files
+    bool readScalarField(std::vector<double> * values);
+    bool readVectorField(std::vector<double> * values);
+
+    //For the value of one boundaryField patch, uniform values are repeated patchSize times
+    bool readScalarPatch(const QByteArray &patchName, int patchSize, std::vector<double> * values);
+    bool readVectorPatch(const QByteArray &patchName, int patchSize, std::vector<double> * values);
+
+    CFDfoamFormat getFormat();
+    QString getReadError();
+
+private:
+    bool readHeader();
+
+    bool findNextList();
+    bool findInternalField(const char * listType);
+    bool findPatchValue(const QByteArray &patchName, const char * listType, CFDfieldEntry * patchValue);
+    bool beginList(int * listSize, bool * isUniform);
+    bool endList(int listSize, int foundSize);
+
+    bool readVectorBody(std::vector<double> * values, const char * errorText);
+    bool readScalarBody(std::vector<double> * values, const char * errorText);
+    bool readLabelBody(std::vector<int> * values, const char * errorText);
+    bool readFaceBody(std::vector<int> * faceOffsets, std::vector<int> * faceIndices);
+    bool readCompactFaceBody(std::vector<int> * faceOffsets, std::vector<int> * faceIndices);
+    bool readCompactFaceRange(int firstFace, int faceCount, std::vector<int> * faceOffsets, std::vector<int> * faceIndices);
+    bool skipFace();
+
+    bool readEntryList(CFDlistKind kind, int listSize, CFDlistOutput * output, const char * errorText);
+    bool readParallelList(CFDlistKind kind, int listSize, CFDlistOutput * output);
+    bool readEntries(CFDlistKind kind, const char * stopPos, CFDlistOutput * output, const char * errorText);
+    bool readEntry(CFDlistKind kind, CFDlistOutput * output, const char * errorText);
+
+    bool readBinaryScalars(int count, std::vector<double> * values);
+    bool readBinaryLabels(int count, std::vector<int> * values);
+
+    bool readInt(int * value);
+    bool readDouble(double * value);
+    bool readVector(double * value);
+    bool expectChar(char expected);
+
+    QByteArray readWord();
+    bool skipGroup();
+    void skipSpace();
+
+    bool isDelimiter(char aLetter);
+    bool readFailure(QString errorText);
+
+    const QByteArray * myInput = nullptr;
+    const char * myStart = nullptr;
+    const char * myPos = nullptr;
+    const char * myEnd = nullptr;
+
+    CFDfoamFormat myFormat;
+    QString readError;
+};
+
+#endif // CFDLISTREADER_H
@@ -0,0 +1,189 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdlocalfile.h"
+
+#include <QFileInfo>
+
+#include <climits>
+
+#ifdef Q_OS_UNIX
+    #include <sys/mman.h>
+#endif
+
+//Largest file which a QByteArray can view, with room for its header
+static const qint64 MAX_VIEW_LEN = INT_MAX - 64;
+
+CFDlocalFile::CFDlocalFile(QString fileName) : myFile(fileName)
+{
+    myFileName = fileName;
+}
+
+CFDlocalFile::~CFDlocalFile()
+{
+    //The view must be gone before the mapping is
+    myRawData.clear();
+    if (mappedData != nullptr)
+    {
+        myFile.unmap(mappedData);
+    }
+}
+
+QString CFDlocalFile::findVariant(QString fileName)
+{
+    for (QString aVariant : CFDcodecList::getFileVariants(fileName))
+    {
+        QFileInfo variantInfo(aVariant);
+        if (variantInfo.exists() && variantInfo.isFile()) return aVariant;
+    }
+    return QString();
+}
+
+bool CFDlocalFile::openFile()
+{
+    if (fileOpen) return true;
+
+    if (!myFile.open(QIODevice::ReadOnly))
+    {
+        return openFailure("Unable to open file");
+    }
+
+    qint64 fileSize = myFile.size();
+    if (fileSize > MAX_VIEW_LEN)
+    {
+        myFile.close();
+        return openFailure("File is too large to read");
+    }
+
+    //Note: an empty file cannot be mapped, and does not need to be
+    if (fileSize > 0)
+    {
+        mappedData = myFile.map(0, fileSize);
+    }
+    if (mappedData != nullptr)
+    {
+#ifdef Q_OS_UNIX
+        //The parsers read from start to end, so the kernel can read ahead
+        posix_madvise(mappedData, static_cast<size_t>(fileSize), POSIX_MADV_SEQUENTIAL);
+#endif
+        myRawData = QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData), static_cast<int>(fileSize));
+    }
+    else if (fileSize > 0)
+    {
+        //Some file systems cannot be mapped, the file is then read as before
+        myRawData = myFile.readAll();
+        if (myRawData.size() != fileSize)
+        {
+            myFile.close();
+            return openFailure("Unable to read file");
+        }
+    }
+    //The mapping stays valid once the file is closed
+    myFile.close();
+
+    myCodec = CFDcodecList::getCodecForFile(myFileName, myRawData);
+    if (myCodec->getCodecName() == "gzip")
+    {
+        myBlockIndex = DeCompressWrapper::readGziFile(myFileName);
+    }
+    fileOpen = true;
+    return true;
+}
+
+bool CFDlocalFile::isOpen()
+{
+    return fileOpen;
+}
+
+bool CFDlocalFile::isMapped()
+{
+    return (mappedData != nullptr);
+}
+
+QString CFDlocalFile::getFileName()
+{
+    return myFileName;
+}
+
+QString CFDlocalFile::getOpenError()
+{
+    return openError;
+}
+
+const QByteArray &CFDlocalFile::getRawData()
+{
+    return myRawData;
+}
+
+const CFDcodec * CFDlocalFile::getCodec()
+{
+    return myCodec;
+}
+
+QByteArray * CFDlocalFile::decodeFile()
+{
+    if (!fileOpen) return nullptr;
+
+    //The buffer may outlive this object, so is never a view of the mapping
+    if (myCodec->getSuffix().isEmpty())
+    {
+        return new QByteArray(myRawData.constData(), myRawData.size());
+    }
+
+    QByteArray foundIndex = myBlockIndex;
+    QByteArray * ret = myCodec->decodeAllIndexed(myRawData, &foundIndex);
+    if (ret != nullptr) keepBlockIndex(foundIndex);
+    return ret;
+}
+
+const QByteArray &CFDlocalFile::getBlockIndex()
+{
+    return myBlockIndex;
+}
+
+void CFDlocalFile::keepBlockIndex(const QByteArray &newIndex)
+{
+    if (newIndex.isEmpty() || (newIndex == myBlockIndex)) return;
+
+    //Note: the folder may not be writable, the index is then found again next time
+    myBlockIndex = newIndex;
+    DeCompressWrapper::writeGziFile(myFileName, myBlockIndex);
+}
+
+bool CFDlocalFile::openFailure(QString errorText)
+{
+    openError = errorText;
+    return false;
+}
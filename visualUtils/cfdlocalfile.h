@@ -0,0 +1,98 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDLOCALFILE_H
+#define CFDLOCALFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "cfdcodec.h"
+
+//A result file on the local disk, ex: in a case folder pulled down with downloadCase.
+//The file is memory mapped, so opening it costs page faults, not a copy, and getRawData
+//is a view of the mapping which can be given straight to the parsers. Compressed files
+//are mapped the same way, and are streamed through their codec by CFDparsePipeline.
+//For gzip files, the index of their blocks is kept next to them (see DeCompressWrapper),
+//so that every read after the first inflates the blocks in parallel.
+
+class CFDlocalFile
+{
+public:
+    explicit CFDlocalFile(QString fileName);
+    ~CFDlocalFile();
+
+    //The first variant of the file which exists, see CFDcodecList::getFileVariants
+    //Returns an empty string if there is none
+    static QString findVariant(QString fileName);
+
+    bool openFile();
+    bool isOpen();
+    bool isMapped();
+    QString getFileName();
+    QString getOpenError();
+
+    //Valid until this object is deleted, copies of it share the mapping.
+    //Note: The data must not be changed, that would copy the whole file.
+    const QByteArray &getRawData();
+    const CFDcodec * getCodec();
+
+    //The uncompressed file in a new buffer, which is not tied to this object,
+    //or nullptr if it could not be decoded
+    QByteArray * decodeFile();
+
+    //The block index read with the file, for CFDcodec::decodeToSinkIndexed, or empty
+    const QByteArray &getBlockIndex();
+    //An index found while decoding is written next to the file, if it is new
+    void keepBlockIndex(const QByteArray &newIndex);
+
+private:
+    Q_DISABLE_COPY(CFDlocalFile)
+
+    bool openFailure(QString errorText);
+
+    QString myFileName;
+    QFile myFile;
+    uchar * mappedData = nullptr;
+    bool fileOpen = false;
+    QString openError;
+
+    QByteArray myRawData;
+    const CFDcodec * myCodec = nullptr;
+    QByteArray myBlockIndex;
+};
+
+#endif // CFDLOCALFILE_H
@@ -0,0 +1,327 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdlz4frame.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+static const quint32 LZ4_FRAME_MAGIC = 0x184D2204;
+static const quint32 LZ4_SKIPPABLE_MAGIC = 0x184D2A50;
+static const quint32 LZ4_SKIPPABLE_MASK = 0xFFFFFFF0;
+//Blocks may refer back this far into the blocks before them
+static const int LZ4_WINDOW_LEN = 65536;
+static const int LZ4_MIN_MATCH = 4;
+
+//xxHash32, which LZ4 uses for its checksums, see: https://github.com/Cyan4973/xxHash
+class CFDxxHash32
+{
+public:
+    void addData(const uchar * data, qint64 length)
+    {
+        totalLength += length;
+        if (bufferUsed > 0)
+        {
+            while ((bufferUsed < 16) && (length > 0))
+            {
+                stripeBuffer[bufferUsed++] = *data++;
+                length--;
+            }
+            if (bufferUsed < 16) return;
+            addStripe(stripeBuffer);
+            bufferUsed = 0;
+        }
+        for (; length >= 16; data += 16, length -= 16)
+        {
+            addStripe(data);
+        }
+        memcpy(stripeBuffer, data, static_cast<size_t>(length));
+        bufferUsed = static_cast<int>(length);
+    }
+
+    quint32 getHash() const
+    {
+        quint32 hashVal = PRIME5;
+        if (totalLength >= 16)
+        {
+            hashVal = rotateLeft(accList[0], 1) + rotateLeft(accList[1], 7) +
+                    rotateLeft(accList[2], 12) + rotateLeft(accList[3], 18);
+        }
+        hashVal += static_cast<quint32>(totalLength);
+
+        int dataPos = 0;
+        for (; dataPos + 4 <= bufferUsed; dataPos += 4)
+        {
+            hashVal += qFromLittleEndian<quint32>(stripeBuffer + dataPos) * PRIME3;
+            hashVal = rotateLeft(hashVal, 17) * PRIME4;
+        }
+        for (; dataPos < bufferUsed; dataPos++)
+        {
+            hashVal += stripeBuffer[dataPos] * PRIME5;
+            hashVal = rotateLeft(hashVal, 11) * PRIME1;
+        }
+
+        hashVal ^= hashVal >> 15;
+        hashVal *= PRIME2;
+        hashVal ^= hashVal >> 13;
+        hashVal *= PRIME3;
+        hashVal ^= hashVal >> 16;
+        return hashVal;
+    }
+
+    static quint32 hashOf(const uchar * data, qint64 length)
+    {
+        CFDxxHash32 aHash;
+        aHash.addData(data, length);
+        return aHash.getHash();
+    }
+
+private:
+    static quint32 rotateLeft(quint32 aVal, int bits)
+    {
+        return (aVal << bits) | (aVal >> (32 - bits));
+    }
+
+    void addStripe(const uchar * stripe)
+    {
+        for (int ind = 0; ind < 4; ind++)
+        {
+            accList[ind] += qFromLittleEndian<quint32>(stripe + 4 * ind) * PRIME2;
+            accList[ind] = rotateLeft(accList[ind], 13) * PRIME1;
+        }
+    }
+
+    static const quint32 PRIME1 = 2654435761U;
+    static const quint32 PRIME2 = 2246822519U;
+    static const quint32 PRIME3 = 3266489917U;
+    static const quint32 PRIME4 = 668265263U;
+    static const quint32 PRIME5 = 374761393U;
+
+    //Note: the seed is always 0 for LZ4
+    quint32 accList[4] = {PRIME1 + PRIME2, PRIME2, 0, 0U - PRIME1};
+    uchar stripeBuffer[16];
+    int bufferUsed = 0;
+    qint64 totalLength = 0;
+};
+
+bool CFDlz4Frame::decodeToSink(const QByteArray &encodedData, DeCompressSink * outputSink, int chunkLength)
+{
+    const uchar * inputData = reinterpret_cast<const uchar *>(encodedData.constData());
+    qint64 inputLength = encodedData.size();
+    qint64 inputPos = 0;
+    bool frameRead = false;
+
+    //Output is decoded after the window kept from the blocks before
+    QByteArray outputBuffer;
+
+    while (inputPos < inputLength)
+    {
+        if (inputLength - inputPos < 4) return false;
+        quint32 frameMagic = qFromLittleEndian<quint32>(inputData + inputPos);
+        inputPos += 4;
+
+        if ((frameMagic & LZ4_SKIPPABLE_MASK) == LZ4_SKIPPABLE_MAGIC)
+        {
+            if (inputLength - inputPos < 4) return false;
+            qint64 skipLength = qFromLittleEndian<quint32>(inputData + inputPos);
+            inputPos += 4;
+            if (inputLength - inputPos < skipLength) return false;
+            inputPos += skipLength;
+            continue;
+        }
+        if (frameMagic != LZ4_FRAME_MAGIC) return false;
+
+        //The frame descriptor: flags, block size, optional content size and dictionary ID, then its checksum
+        if (inputLength - inputPos < 3) return false;
+        const uchar * descriptor = inputData + inputPos;
+        uchar frameFlags = descriptor[0];
+        uchar blockFlags = descriptor[1];
+        if (((frameFlags >> 6) != 1) || ((frameFlags & 0x02) != 0) || ((blockFlags & 0x8F) != 0)) return false;
+        if ((frameFlags & 0x01) != 0) return false;
+
+        bool blocksLinked = ((frameFlags & 0x20) == 0);
+        bool hasBlockChecksum = ((frameFlags & 0x10) != 0);
+        bool hasContentSize = ((frameFlags & 0x08) != 0);
+        bool hasContentChecksum = ((frameFlags & 0x04) != 0);
+        int sizeCode = (blockFlags >> 4) & 0x07;
+        if (sizeCode < 4) return false;
+        int maxBlockLength = 1 << (8 + 2 * sizeCode);
+
+        qint64 descriptorLength = 2 + (hasContentSize ? 8 : 0);
+        if (inputLength - inputPos < descriptorLength + 1) return false;
+        if (((CFDxxHash32::hashOf(descriptor, descriptorLength) >> 8) & 0xFF) != descriptor[descriptorLength]) return false;
+        inputPos += descriptorLength + 1;
+
+        outputBuffer.resize(LZ4_WINDOW_LEN + maxBlockLength);
+        char * outputData = outputBuffer.data();
+        int windowUsed = 0;
+        CFDxxHash32 contentHash;
+
+        while (true)
+        {
+            if (inputLength - inputPos < 4) return false;
+            quint32 blockHeader = qFromLittleEndian<quint32>(inputData + inputPos);
+            inputPos += 4;
+            if (blockHeader == 0) break;
+
+            bool isStored = ((blockHeader & 0x80000000U) != 0);
+            qint64 blockLength = blockHeader & 0x7FFFFFFFU;
+            if ((blockLength > maxBlockLength) || (inputLength - inputPos < blockLength + (hasBlockChecksum ? 4 : 0))) return false;
+
+            const uchar * blockData = inputData + inputPos;
+            inputPos += blockLength;
+            if (hasBlockChecksum)
+            {
+                if (CFDxxHash32::hashOf(blockData, blockLength) != qFromLittleEndian<quint32>(inputData + inputPos)) return false;
+                inputPos += 4;
+            }
+
+            //Note: unlinked blocks cannot refer to the window, so it is not kept
+            int blockStart = blocksLinked ? windowUsed : 0;
+            int blockEnd = blockStart;
+            if (isStored)
+            {
+                memcpy(outputData + blockStart, blockData, static_cast<size_t>(blockLength));
+                blockEnd += static_cast<int>(blockLength);
+            }
+            else if (!decodeBlock(blockData, static_cast<int>(blockLength), outputData, blockStart,
+                                  blockStart + maxBlockLength, &blockEnd))
+            {
+                return false;
+            }
+
+            if (hasContentChecksum)
+            {
+                contentHash.addData(reinterpret_cast<const uchar *>(outputData + blockStart), blockEnd - blockStart);
+            }
+            for (int outputPos = blockStart; outputPos < blockEnd; outputPos += chunkLength)
+            {
+                int thisLength = qMin(chunkLength, blockEnd - outputPos);
+                if (!outputSink->receiveChunk(outputData + outputPos, thisLength)) return false;
+            }
+
+            if (blocksLinked)
+            {
+                windowUsed = qMin(blockEnd, LZ4_WINDOW_LEN);
+                memmove(outputData, outputData + blockEnd - windowUsed, static_cast<size_t>(windowUsed));
+            }
+        }
+
+        if (hasContentChecksum)
+        {
+            if (inputLength - inputPos < 4) return false;
+            if (contentHash.getHash() != qFromLittleEndian<quint32>(inputData + inputPos)) return false;
+            inputPos += 4;
+        }
+        frameRead = true;
+    }
+
+    return frameRead;
+}
+
+qint64 CFDlz4Frame::getContentSize(const QByteArray &encodedData)
+{
+    const uchar * inputData = reinterpret_cast<const uchar *>(encodedData.constData());
+    if (encodedData.size() < 14) return 0;
+    if (qFromLittleEndian<quint32>(inputData) != LZ4_FRAME_MAGIC) return 0;
+    if ((inputData[4] & 0x08) == 0) return 0;
+    return static_cast<qint64>(qFromLittleEndian<quint64>(inputData + 6));
+}
+
+bool CFDlz4Frame::decodeBlock(const uchar * input, int inputLength, char * output, int outputStart, int outputLimit, int * outputEnd)
+{
+    const uchar * inputEnd = input + inputLength;
+    int outputPos = outputStart;
+
+    //Each sequence is a token, literals, then a match, except the last, which has only literals
+    while (input < inputEnd)
+    {
+        uchar aToken = *input++;
+
+        qint64 literalLength = aToken >> 4;
+        if (literalLength == 15)
+        {
+            uchar moreLength = 255;
+            while ((moreLength == 255) && (input < inputEnd))
+            {
+                moreLength = *input++;
+                literalLength += moreLength;
+            }
+        }
+        if ((literalLength > inputEnd - input) || (literalLength > outputLimit - outputPos)) return false;
+        memcpy(output + outputPos, input, static_cast<size_t>(literalLength));
+        input += literalLength;
+        outputPos += static_cast<int>(literalLength);
+        if (input == inputEnd) break;
+
+        if (inputEnd - input < 2) return false;
+        int matchOffset = qFromLittleEndian<quint16>(input);
+        input += 2;
+        if ((matchOffset == 0) || (matchOffset > outputPos)) return false;
+
+        qint64 matchLength = aToken & 0x0F;
+        if (matchLength == 15)
+        {
+            uchar moreLength = 255;
+            while ((moreLength == 255) && (input < inputEnd))
+            {
+                moreLength = *input++;
+                matchLength += moreLength;
+            }
+        }
+        matchLength += LZ4_MIN_MATCH;
+        if (matchLength > outputLimit - outputPos) return false;
+
+        //Note: the match may overlap the output it makes, so it is copied forward in pieces
+        char * matchFrom = output + outputPos - matchOffset;
+        char * matchTo = output + outputPos;
+        if (matchOffset >= matchLength)
+        {
+            memcpy(matchTo, matchFrom, static_cast<size_t>(matchLength));
+        }
+        else
+        {
+            for (qint64 ind = 0; ind < matchLength; ind++)
+            {
+                matchTo[ind] = matchFrom[ind];
+            }
+        }
+        outputPos += static_cast<int>(matchLength);
+    }
+
+    *outputEnd = outputPos;
+    return true;
+}
@@ -0,0 +1,173 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdmeshsidecar.h"
+#include "cfdlocalfile.h"
+
+#include <QSaveFile>
+
+#ifdef Q_OS_WIN
+    #include <QtZlib/zlib.h>
+#else
+    #include <zlib.h>
+#endif
+
+#include <cstring>
+
+//Change this when the parsed lists change in meaning, so older files are not used
+static const quint32 SIDECAR_VERSION = 2;
+static const char SIDECAR_MAGIC[8] = {'C', 'W', 'E', 'M', 'E', 'S', 'H', '\0'};
+static const quint32 SIDECAR_BYTE_ORDER = 0x01020304;
+
+//zlib takes lengths as uInt, so the checksum is found in pieces
+static const qint64 CHECKSUM_PIECE_LEN = 1024 * 1024 * 1024;
+
+//Note: 64 bytes, so the lists after it are aligned
+struct CFDsidecarHeader
+{
+    char magic[8];
+    quint32 byteOrder;
+    quint32 version;
+    quint32 target;
+    quint32 checksum;
+    quint64 doubleCount;
+    quint64 labelCount;
+    quint64 offsetCount;
+    quint64 reserved[2];
+};
+
+static quint32 addToChecksum(quint32 checksum, const void * data, qint64 length)
+{
+    const Bytef * dataPos = static_cast<const Bytef *>(data);
+    while (length > 0)
+    {
+        qint64 pieceLength = qMin(length, CHECKSUM_PIECE_LEN);
+        checksum = static_cast<quint32>(crc32(checksum, dataPos, static_cast<uInt>(pieceLength)));
+        dataPos += pieceLength;
+        length -= pieceLength;
+    }
+    return checksum;
+}
+
+template <typename T>
+static qint64 getByteCount(const std::vector<T> &aList)
+{
+    return static_cast<qint64>(aList.size() * sizeof(T));
+}
+
+static quint32 getListChecksum(const CFDparsedList &parsedList)
+{
+    quint32 checksum = static_cast<quint32>(crc32(0, nullptr, 0));
+    checksum = addToChecksum(checksum, parsedList.doubleVals.data(), getByteCount(parsedList.doubleVals));
+    checksum = addToChecksum(checksum, parsedList.labelVals.data(), getByteCount(parsedList.labelVals));
+    checksum = addToChecksum(checksum, parsedList.faceOffsets.data(), getByteCount(parsedList.faceOffsets));
+    return checksum;
+}
+
+bool CFDmeshSidecar::writeSidecar(QString fileName, CFDparseTarget target, const CFDparsedList &parsedList)
+{
+    if (!parsedList.readOK) return false;
+
+    CFDsidecarHeader fileHeader;
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    memcpy(fileHeader.magic, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC));
+    fileHeader.byteOrder = SIDECAR_BYTE_ORDER;
+    fileHeader.version = SIDECAR_VERSION;
+    fileHeader.target = static_cast<quint32>(target);
+    fileHeader.checksum = getListChecksum(parsedList);
+    fileHeader.doubleCount = parsedList.doubleVals.size();
+    fileHeader.labelCount = parsedList.labelVals.size();
+    fileHeader.offsetCount = parsedList.faceOffsets.size();
+
+    //Note: the file is only replaced once fully written
+    QSaveFile sidecarFile(fileName);
+    if (!sidecarFile.open(QIODevice::WriteOnly)) return false;
+
+    bool writeOK = (sidecarFile.write(reinterpret_cast<const char *>(&fileHeader), sizeof(fileHeader)) == sizeof(fileHeader));
+    qint64 doubleBytes = getByteCount(parsedList.doubleVals);
+    writeOK = writeOK && (sidecarFile.write(reinterpret_cast<const char *>(parsedList.doubleVals.data()), doubleBytes) == doubleBytes);
+    for (const std::vector<int> * aList : {&parsedList.labelVals, &parsedList.faceOffsets})
+    {
+        qint64 byteCount = getByteCount(*aList);
+        writeOK = writeOK && (sidecarFile.write(reinterpret_cast<const char *>(aList->data()), byteCount) == byteCount);
+    }
+
+    //Note: an uncommitted file is thrown away
+    return writeOK && sidecarFile.commit();
+}
+
+bool CFDmeshSidecar::readSidecar(QString fileName, CFDparseTarget target, CFDparsedList * parsedList)
+{
+    CFDlocalFile sidecarFile(fileName);
+    if (!sidecarFile.openFile()) return false;
+
+    const QByteArray &rawData = sidecarFile.getRawData();
+    if (rawData.size() < static_cast<int>(sizeof(CFDsidecarHeader))) return false;
+
+    CFDsidecarHeader fileHeader;
+    memcpy(&fileHeader, rawData.constData(), sizeof(fileHeader));
+    if (memcmp(fileHeader.magic, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC)) != 0) return false;
+    if ((fileHeader.byteOrder != SIDECAR_BYTE_ORDER) || (fileHeader.version != SIDECAR_VERSION)) return false;
+    if (fileHeader.target != static_cast<quint32>(target)) return false;
+
+    //Each count is checked first, so that the total cannot overflow
+    quint64 fileLength = static_cast<quint64>(rawData.size());
+    for (quint64 aCount : {fileHeader.doubleCount, fileHeader.labelCount, fileHeader.offsetCount})
+    {
+        if (aCount > fileLength) return false;
+    }
+    quint64 expectedLength = sizeof(fileHeader) + sizeof(double) * fileHeader.doubleCount +
+            sizeof(int) * (fileHeader.labelCount + fileHeader.offsetCount);
+    if (expectedLength != fileLength) return false;
+
+    //The lists are one after another, so their checksum is that of the rest of the file
+    const char * listPos = rawData.constData() + sizeof(fileHeader);
+    quint32 checksum = addToChecksum(static_cast<quint32>(crc32(0, nullptr, 0)), listPos,
+                                     static_cast<qint64>(fileLength - sizeof(fileHeader)));
+    if (checksum != fileHeader.checksum) return false;
+
+    const double * doubleStart = reinterpret_cast<const double *>(listPos);
+    const int * labelStart = reinterpret_cast<const int *>(doubleStart + fileHeader.doubleCount);
+    const int * offsetStart = labelStart + fileHeader.labelCount;
+
+    CFDparsedList newList;
+    newList.doubleVals.assign(doubleStart, doubleStart + fileHeader.doubleCount);
+    newList.labelVals.assign(labelStart, labelStart + fileHeader.labelCount);
+    newList.faceOffsets.assign(offsetStart, offsetStart + fileHeader.offsetCount);
+
+    newList.readOK = true;
+    *parsedList = std::move(newList);
+    return true;
+}
@@ -0,0 +1,388 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdnumberparser.h"
+
+#include <QByteArray>
+#include <QtAlgorithms>
+#include <QtEndian>
+
+#include <cfloat>
+
+//The SIMD paths are compiled for their own instruction set only, and are picked
+//when the program starts, so the rest of the program runs on any x86 machine
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define CFD_NUMBER_X86_SIMD
+    #define CFD_TARGET_SSE42 __attribute__((target("sse4.2")))
+    #define CFD_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #include <immintrin.h>
+    #define CFD_NUMBER_X86_SIMD
+    //Note: MSVC allows any intrinsic without /arch flags
+    #define CFD_TARGET_SSE42
+    #define CFD_TARGET_AVX2
+#endif
+
+//The exact fast path needs each double operation to be rounded once,
+//which is not the case with x87 extended precision
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+    #define CFD_NUMBER_FAST_DOUBLE
+#endif
+
+namespace {
+
+inline bool isSpaceChar(char aLetter)
+{
+    return (aLetter == ' ') || ((aLetter >= '\t') && (aLetter <= '\r'));
+}
+
+inline bool isDelimChar(char aLetter)
+{
+    if (isSpaceChar(aLetter)) return true;
+    return (aLetter == '(') || (aLetter == ')') || (aLetter == '{') ||
+            (aLetter == '}') || (aLetter == ';');
+}
+
+inline bool isDigitChar(char aLetter)
+{
+    return (aLetter >= '0') && (aLetter <= '9');
+}
+
+#if defined(CFD_NUMBER_X86_SIMD)
+enum class CFDsimdLevel {SCALAR, SSE42, AVX2};
+
+CFDsimdLevel detectSimdLevel()
+{
+#if defined(_MSC_VER)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    int maxLeaf = cpuInfo[0];
+    if (maxLeaf < 1) return CFDsimdLevel::SCALAR;
+
+    __cpuid(cpuInfo, 1);
+    bool hasSse42 = ((cpuInfo[2] & (1 << 20)) != 0);
+    //AVX registers must also be saved by the OS
+    bool hasAvx = ((cpuInfo[2] & (1 << 27)) != 0) && ((cpuInfo[2] & (1 << 28)) != 0) &&
+            ((_xgetbv(0) & 6) == 6);
+    bool hasAvx2 = false;
+    if (hasAvx && (maxLeaf >= 7))
+    {
+        __cpuidex(cpuInfo, 7, 0);
+        hasAvx2 = ((cpuInfo[1] & (1 << 5)) != 0);
+    }
+#else
+    __builtin_cpu_init();
+    bool hasSse42 = __builtin_cpu_supports("sse4.2");
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    if (hasAvx2) return CFDsimdLevel::AVX2;
+    if (hasSse42) return CFDsimdLevel::SSE42;
+    return CFDsimdLevel::SCALAR;
+}
+
+//Note: zero before static initialization, which is the scalar path
+const CFDsimdLevel SIMD_LEVEL = detectSimdLevel();
+
+CFD_TARGET_AVX2 inline __m256i spaceMask(__m256i chunk)
+{
+    //Whitespace is ' ' or the range '\t' to '\r'
+    __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8('\t'));
+    __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi8(shifted, _mm256_set1_epi8(-1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8(5), shifted));
+    return _mm256_or_si256(inRange, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')));
+}
+
+const char SPACE_SET[16] = {' ', '\t', '\n', '\v', '\f', '\r'};
+const int SPACE_SET_LEN = 6;
+const char DELIM_SET[16] = {' ', '\t', '\n', '\v', '\f', '\r', '(', ')', '{', '}', ';'};
+const int DELIM_SET_LEN = 11;
+
+//Each returns the position reached, the rest is checked one letter at a time
+CFD_TARGET_AVX2 const char * skipSpaceAvx2(const char * pos, const char * end)
+{
+    while (pos + 32 <= end)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pos));
+        quint32 notSpace = ~static_cast<quint32>(_mm256_movemask_epi8(spaceMask(chunk)));
+        if (notSpace != 0) return pos + qCountTrailingZeroBits(notSpace);
+        pos += 32;
+    }
+    return pos;
+}
+
+CFD_TARGET_SSE42 const char * skipSpaceSse42(const char * pos, const char * end)
+{
+    const __m128i spaceSet = _mm_loadu_si128(reinterpret_cast<const __m128i *>(SPACE_SET));
+    while (pos + 16 <= end)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+        int index = _mm_cmpestri(spaceSet, SPACE_SET_LEN, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY);
+        if (index < 16) return pos + index;
+        pos += 16;
+    }
+    return pos;
+}
+
+CFD_TARGET_AVX2 const char * findTokenEndAvx2(const char * pos, const char * end)
+{
+    while (pos + 32 <= end)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pos));
+        __m256i delims = spaceMask(chunk);
+        delims = _mm256_or_si256(delims, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('(')));
+        delims = _mm256_or_si256(delims, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(')')));
+        delims = _mm256_or_si256(delims, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('{')));
+        delims = _mm256_or_si256(delims, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('}')));
+        delims = _mm256_or_si256(delims, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(';')));
+        quint32 found = static_cast<quint32>(_mm256_movemask_epi8(delims));
+        if (found != 0) return pos + qCountTrailingZeroBits(found);
+        pos += 32;
+    }
+    return pos;
+}
+
+CFD_TARGET_SSE42 const char * findTokenEndSse42(const char * pos, const char * end)
+{
+    const __m128i delimSet = _mm_loadu_si128(reinterpret_cast<const __m128i *>(DELIM_SET));
+    while (pos + 16 <= end)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+        int index = _mm_cmpestri(delimSet, DELIM_SET_LEN, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY);
+        if (index < 16) return pos + index;
+        pos += 16;
+    }
+    return pos;
+}
+#endif
+
+//Eight ASCII digits at once, see: Lemire, "Number parsing at a gigabyte per second"
+inline bool loadEightDigits(const char * pos, quint64 * chunk)
+{
+    *chunk = qFromLittleEndian<quint64>(pos);
+    return (((*chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((*chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+}
+
+inline quint32 parseEightDigits(quint64 chunk)
+{
+    const quint64 mask = 0x000000FF000000FFULL;
+    const quint64 mul1 = 0x000F424000000064ULL;
+    const quint64 mul2 = 0x0000271000000001ULL;
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return static_cast<quint32>(chunk);
+}
+
+const double EXACT_POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                              1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+                              1e20, 1e21, 1e22};
+const int MAX_EXACT_POW10 = 22;
+const quint64 MAX_EXACT_MANTISSA = (1ULL << 53);
+const int MAX_MANTISSA_DIGITS = 19;
+
+bool parseDoubleFallback(const char * start, const char * end, double * value)
+{
+    bool isNum = false;
+    *value = QByteArray::fromRawData(start, static_cast<int>(end - start)).toDouble(&isNum);
+    return isNum;
+}
+
+}
+
+const char * CFDnumberParser::skipSpace(const char * pos, const char * end)
+{
+    //Most runs are a single space or newline, check that before going wide
+    if ((pos < end) && !isSpaceChar(*pos)) return pos;
+
+#if defined(CFD_NUMBER_X86_SIMD)
+    if (SIMD_LEVEL == CFDsimdLevel::AVX2) pos = skipSpaceAvx2(pos, end);
+    else if (SIMD_LEVEL == CFDsimdLevel::SSE42) pos = skipSpaceSse42(pos, end);
+#endif
+
+    while ((pos < end) && isSpaceChar(*pos)) pos++;
+    return pos;
+}
+
+const char * CFDnumberParser::findTokenEnd(const char * pos, const char * end)
+{
+#if defined(CFD_NUMBER_X86_SIMD)
+    if (SIMD_LEVEL == CFDsimdLevel::AVX2) pos = findTokenEndAvx2(pos, end);
+    else if (SIMD_LEVEL == CFDsimdLevel::SSE42) pos = findTokenEndSse42(pos, end);
+#endif
+
+    while ((pos < end) && !isDelimChar(*pos)) pos++;
+    return pos;
+}
+
+bool CFDnumberParser::parseLabel(const char * start, const char * end, qint64 * value)
+{
+    const char * pos = start;
+    bool isNegative = false;
+    if ((pos < end) && ((*pos == '-') || (*pos == '+')))
+    {
+        isNegative = (*pos == '-');
+        pos++;
+    }
+    if ((pos >= end) || (end - pos > 18)) return false;
+
+    quint64 result = 0;
+    quint64 chunk;
+    while ((pos + 8 <= end) && loadEightDigits(pos, &chunk))
+    {
+        result = result * 100000000ULL + parseEightDigits(chunk);
+        pos += 8;
+    }
+    while ((pos < end) && isDigitChar(*pos))
+    {
+        result = result * 10 + static_cast<quint64>(*pos - '0');
+        pos++;
+    }
+    if (pos != end) return false;
+
+    *value = isNegative ? -static_cast<qint64>(result) : static_cast<qint64>(result);
+    return true;
+}
+
+bool CFDnumberParser::parseDouble(const char * start, const char * end, double * value)
+{
+    const char * pos = start;
+    bool isNegative = false;
+    if ((pos < end) && ((*pos == '-') || (*pos == '+')))
+    {
+        isNegative = (*pos == '-');
+        pos++;
+    }
+
+    quint64 mantissa = 0;
+    quint64 chunk;
+
+    const char * intStart = pos;
+    while ((pos + 8 <= end) && loadEightDigits(pos, &chunk))
+    {
+        mantissa = mantissa * 100000000ULL + parseEightDigits(chunk);
+        pos += 8;
+    }
+    while ((pos < end) && isDigitChar(*pos))
+    {
+        mantissa = mantissa * 10 + static_cast<quint64>(*pos - '0');
+        pos++;
+    }
+    int digitCount = static_cast<int>(pos - intStart);
+
+    int exponent = 0;
+    if ((pos < end) && (*pos == '.'))
+    {
+        pos++;
+        const char * fracStart = pos;
+        while ((pos + 8 <= end) && loadEightDigits(pos, &chunk))
+        {
+            mantissa = mantissa * 100000000ULL + parseEightDigits(chunk);
+            pos += 8;
+        }
+        while ((pos < end) && isDigitChar(*pos))
+        {
+            mantissa = mantissa * 10 + static_cast<quint64>(*pos - '0');
+            pos++;
+        }
+        exponent = -static_cast<int>(pos - fracStart);
+        digitCount -= exponent;
+    }
+
+    //Anything unusual (nan, inf, very long mantissas) is left to the fallback
+    if ((digitCount == 0) || (digitCount > MAX_MANTISSA_DIGITS))
+    {
+        return parseDoubleFallback(start, end, value);
+    }
+
+    if ((pos < end) && ((*pos == 'e') || (*pos == 'E')))
+    {
+        pos++;
+        bool expNegative = false;
+        if ((pos < end) && ((*pos == '-') || (*pos == '+')))
+        {
+            expNegative = (*pos == '-');
+            pos++;
+        }
+        if ((pos >= end) || !isDigitChar(*pos)) return false;
+
+        int expVal = 0;
+        while ((pos < end) && isDigitChar(*pos))
+        {
+            if (expVal < 100000) expVal = expVal * 10 + (*pos - '0');
+            pos++;
+        }
+        exponent += expNegative ? -expVal : expVal;
+    }
+
+    if (pos != end) return false;
+
+    if (mantissa == 0)
+    {
+        *value = isNegative ? -0.0 : 0.0;
+        return true;
+    }
+
+#if defined(CFD_NUMBER_FAST_DOUBLE)
+    if ((mantissa <= MAX_EXACT_MANTISSA) &&
+            (exponent >= -MAX_EXACT_POW10) && (exponent <= MAX_EXACT_POW10))
+    {
+        //Both the mantissa and the power of ten are exact doubles,
+        //so one multiply or divide gives the correctly rounded result
+        double result = static_cast<double>(mantissa);
+        if (exponent < 0) result /= EXACT_POW10[-exponent];
+        else result *= EXACT_POW10[exponent];
+        *value = isNegative ? -result : result;
+        return true;
+    }
+#endif
+
+    return parseDoubleFallback(start, end, value);
+}
+
+const char * CFDnumberParser::getSimdMode()
+{
+#if defined(CFD_NUMBER_X86_SIMD)
+    if (SIMD_LEVEL == CFDsimdLevel::AVX2) return "AVX2";
+    if (SIMD_LEVEL == CFDsimdLevel::SSE42) return "SSE4.2";
+#endif
+    return "scalar";
+}
@@ -0,0 +1,61 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDNUMBERPARSER_H
+#define CFDNUMBERPARSER_H
+
+#include <QtGlobal>
+
+//Number scanning for OpenFOAM ASCII lists
+//Token boundaries are found with AVX2 or SSE4.2 if the CPU has them, checked at startup,
+//otherwise a scalar fallback is used. Doubles are parsed to round-trip accuracy:
+//a fast exact path handles typical values, anything else goes through QByteArray::toDouble
+
+class CFDnumberParser
+{
+public:
+    //Returns the first non-whitespace position, or end
+    static const char * skipSpace(const char * pos, const char * end);
+    //Returns the first whitespace, paren, brace or semicolon, or end
+    static const char * findTokenEnd(const char * pos, const char * end);
+
+    //The whole of [start, end) must be the number
+    static bool parseLabel(const char * start, const char * end, qint64 * value);
+    static bool parseDouble(const char * start, const char * end, double * value);
+
+    static const char * getSimdMode();
+};
+
+#endif // CFDNUMBERPARSER_H
@@ -0,0 +1,290 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdparsepipeline.h"
+
+#include "cfdfoamdict.h"
+#include "cfdlistreader.h"
+
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#include <climits>
+
+//Inflated text is passed on in pieces of this size, with at most this many waiting
+static const int PIPELINE_CHUNK_LEN = 1024 * 1024;
+static const int PIPELINE_MAX_QUEUED = 8;
+
+//The header is looked for in at most this much text
+static const int PIPELINE_HEADER_LIMIT = 64 * 1024;
+
+//Inflation has its own threads, so a parse waiting on it can never hold the thread it needs
+static QThreadPool * getInflatePool()
+{
+    static QThreadPool inflatePool;
+    return &inflatePool;
+}
+
+CFDparsePipeline::CFDparsePipeline(const QByteArray &rawFile, CFDparseTarget target)
+{
+    myRawFile = rawFile;
+    myCodec = CFDcodecList::getCodecForData(rawFile);
+    expectedBytes = myCodec->getSizeHint(rawFile);
+    myTarget = target;
+
+    myOutput.doubleVals = &myResult.doubleVals;
+    myOutput.labelVals = &myResult.labelVals;
+    myOutput.faceOffsets = &myResult.faceOffsets;
+}
+
+CFDparsePipeline::~CFDparsePipeline()
+{
+    cancel();
+    inflateJob.waitForFinished();
+}
+
+bool CFDparsePipeline::run()
+{
+    myResult = CFDparsedList();
+    inflateJob = QtConcurrent::run(getInflatePool(), [this]() { inflateAll(); });
+
+    QByteArray aChunk;
+    while (takeChunk(&aChunk))
+    {
+        if (!headerRead)
+        {
+            headerText.append(aChunk);
+            beginParse(false);
+            continue;
+        }
+        parseChunk(aChunk);
+    }
+
+    //Note: the parse may have stopped the input early, once it had its list
+    stopInput();
+    inflateJob.waitForFinished();
+
+    QMutexLocker queueLocker(&queueLock);
+    if (wasCancelled) return readFailure("Loading was cancelled");
+    bool inflateDone = inflateOK;
+    queueLocker.unlock();
+
+    if (!headerRead) beginParse(true);
+    if (myParser && (myParser->isDone() || myParser->hasFailed())) return finishParse();
+    if (!inflateDone) return readFailure("Unable to decompress file");
+    return finishParse();
+}
+
+void CFDparsePipeline::cancel()
+{
+    QMutexLocker queueLocker(&queueLock);
+    wasCancelled = true;
+    inputStopped = true;
+    queueNotFull.wakeAll();
+    queueNotEmpty.wakeAll();
+}
+
+bool CFDparsePipeline::isCancelled()
+{
+    QMutexLocker queueLocker(&queueLock);
+    return wasCancelled;
+}
+
+qint64 CFDparsePipeline::getBytesRead()
+{
+    QMutexLocker queueLocker(&queueLock);
+    return bytesRead;
+}
+
+qint64 CFDparsePipeline::getExpectedBytes()
+{
+    return expectedBytes;
+}
+
+CFDparsedList * CFDparsePipeline::getResult()
+{
+    return &myResult;
+}
+
+void CFDparsePipeline::setBlockIndex(const QByteArray &gziData)
+{
+    myBlockIndex = gziData;
+}
+
+QByteArray CFDparsePipeline::getBlockIndex()
+{
+    return myBlockIndex;
+}
+
+bool CFDparsePipeline::receiveChunk(const char * data, int length)
+{
+    QMutexLocker queueLocker(&queueLock);
+    while ((chunkQueue.size() >= PIPELINE_MAX_QUEUED) && !inputStopped)
+    {
+        queueNotFull.wait(&queueLock);
+    }
+    if (inputStopped) return false;
+
+    chunkQueue.enqueue(QByteArray(data, length));
+    queueNotEmpty.wakeOne();
+    return true;
+}
+
+void CFDparsePipeline::inflateAll()
+{
+    bool resultOK = myCodec->decodeToSinkIndexed(myRawFile, this, PIPELINE_CHUNK_LEN, &myBlockIndex);
+
+    QMutexLocker queueLocker(&queueLock);
+    inputDone = true;
+    inflateOK = resultOK;
+    queueNotEmpty.wakeAll();
+}
+
+bool CFDparsePipeline::takeChunk(QByteArray * chunk)
+{
+    QMutexLocker queueLocker(&queueLock);
+    while (chunkQueue.isEmpty() && !inputDone && !inputStopped)
+    {
+        queueNotEmpty.wait(&queueLock);
+    }
+    if (inputStopped || chunkQueue.isEmpty()) return false;
+
+    *chunk = chunkQueue.dequeue();
+    bytesRead += chunk->size();
+    queueNotFull.wakeOne();
+    return true;
+}
+
+void CFDparsePipeline::stopInput()
+{
+    QMutexLocker queueLocker(&queueLock);
+    inputStopped = true;
+    chunkQueue.clear();
+    queueNotFull.wakeAll();
+}
+
+bool CFDparsePipeline::beginParse(bool atEnd)
+{
+    CFDfoamDict headerReader(&headerText);
+    bool headerOK = headerReader.readHeader();
+    if (!headerOK && !atEnd && (headerText.size() < PIPELINE_HEADER_LIMIT))
+    {
+        return false;
+    }
+    headerRead = true;
+
+    //Binary, or unreadable, files are read whole, so that CFDlistReader gives the error
+    CFDfoamFormat fileFormat = headerReader.getFormat();
+    if (!headerOK || fileFormat.isBinary)
+    {
+        if (expectedBytes > headerText.size()) wholeFile.reserve(static_cast<int>(qMin<qint64>(expectedBytes, INT_MAX - 64)));
+        wholeFile.append(headerText);
+        headerText.clear();
+        return true;
+    }
+
+    CFDlistKind listKind = CFDlistKind::VECTOR;
+    if (myTarget == CFDparseTarget::FACES) listKind = CFDlistKind::FACE;
+    else if (myTarget == CFDparseTarget::LABELS) listKind = CFDlistKind::LABEL;
+    else if (myTarget == CFDparseTarget::SCALAR_FIELD) listKind = CFDlistKind::SCALAR;
+    bool isField = (myTarget == CFDparseTarget::SCALAR_FIELD) || (myTarget == CFDparseTarget::VECTOR_FIELD);
+    bool isCompact = (fileFormat.className == "faceCompactList");
+
+    myParser.reset(new CFDstreamParser(listKind, isField, isCompact, &myOutput));
+    myTokenizer.reset(new CFDtokenizer(myParser.get()));
+
+    qint64 headerEnd = headerReader.getHeaderEnd();
+    QByteArray restText = headerText.mid(static_cast<int>(headerEnd));
+    headerText.clear();
+    parseChunk(restText);
+    return true;
+}
+
+void CFDparsePipeline::parseChunk(const QByteArray &chunk)
+{
+    if (!myParser)
+    {
+        wholeFile.append(chunk);
+        return;
+    }
+
+    myTokenizer->feed(chunk.constData(), chunk.size());
+
+    //Once the list is read, or cannot be, the rest of the file is not needed
+    if (myParser->isDone() || myParser->hasFailed())
+    {
+        stopInput();
+    }
+}
+
+bool CFDparsePipeline::finishParse()
+{
+    if (!myParser) return readWholeFile();
+
+    if (!myParser->isDone())
+    {
+        myTokenizer->finish();
+        if (!myParser->finish()) return readFailure(myParser->getReadError());
+    }
+
+    myResult.readOK = true;
+    return true;
+}
+
+bool CFDparsePipeline::readWholeFile()
+{
+    CFDlistReader fileReader(&wholeFile);
+    bool readOK = false;
+
+    if (myTarget == CFDparseTarget::POINTS) readOK = fileReader.readVectorList(&myResult.doubleVals);
+    else if (myTarget == CFDparseTarget::FACES) readOK = fileReader.readFaceList(&myResult.faceOffsets, &myResult.labelVals);
+    else if (myTarget == CFDparseTarget::LABELS) readOK = fileReader.readLabelList(&myResult.labelVals);
+    else if (myTarget == CFDparseTarget::SCALAR_FIELD) readOK = fileReader.readScalarField(&myResult.doubleVals);
+    else readOK = fileReader.readVectorField(&myResult.doubleVals);
+
+    //The inflated file is no longer needed
+    QByteArray().swap(wholeFile);
+
+    if (!readOK) return readFailure(fileReader.getReadError());
+    myResult.readOK = true;
+    return true;
+}
+
+bool CFDparsePipeline::readFailure(QString errorText)
+{
+    myResult.readOK = false;
+    myResult.readError = errorText;
+    return false;
+}
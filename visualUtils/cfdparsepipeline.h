@@ -0,0 +1,144 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDPARSEPIPELINE_H
+#define CFDPARSEPIPELINE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFuture>
+
+#include <memory>
+#include <vector>
+
+#include "cfdcodec.h"
+#include "cfdtokenizer.h"
+#include "cfdstreamparser.h"
+
+//Reads one result file, decoding it on one thread while parsing it on another.
+//Inflated text is passed in fixed size chunks through a bounded queue, so the whole
+//inflated file is not held in memory, except for binary files, which are read whole.
+
+enum class CFDparseTarget
+{
+    POINTS,
+    FACES,
+    LABELS,
+    SCALAR_FIELD,
+    VECTOR_FIELD
+};
+
+struct CFDparsedList
+{
+    //Faces are faceOffsets and labelVals, as in CFDlistReader::readFaceList
+    std::vector<double> doubleVals;
+    std::vector<int> labelVals;
+    std::vector<int> faceOffsets;
+
+    bool readOK = false;
+    QString readError;
+};
+
+class CFDparsePipeline : private DeCompressSink
+{
+public:
+    //The codec is found from the start of the file, see CFDcodecList
+    CFDparsePipeline(const QByteArray &rawFile, CFDparseTarget target);
+    ~CFDparsePipeline();
+
+    //Blocks until the file is read, the calling thread does the parsing
+    bool run();
+    //May be called from any thread, run then stops as soon as it can
+    void cancel();
+    bool isCancelled();
+    //May be called from any thread while run is going, for showing progress.
+    //The expected size is 0 if the codec cannot tell it.
+    qint64 getBytesRead();
+    qint64 getExpectedBytes();
+
+    CFDparsedList * getResult();
+
+    //A block index of the file from an earlier read, see CFDcodec::decodeToSinkIndexed,
+    //set before run. Once run returns, it is the index found, if the whole file was read.
+    void setBlockIndex(const QByteArray &gziData);
+    QByteArray getBlockIndex();
+
+private:
+    Q_DISABLE_COPY(CFDparsePipeline)
+
+    virtual bool receiveChunk(const char * data, int length);
+    void inflateAll();
+    bool takeChunk(QByteArray * chunk);
+    void stopInput();
+
+    bool beginParse(bool atEnd);
+    void parseChunk(const QByteArray &chunk);
+    bool finishParse();
+    bool readWholeFile();
+    bool readFailure(QString errorText);
+
+    QByteArray myRawFile;
+    const CFDcodec * myCodec = nullptr;
+    qint64 expectedBytes = 0;
+    QByteArray myBlockIndex;
+    CFDparseTarget myTarget;
+    CFDparsedList myResult;
+    CFDlistOutput myOutput;
+
+    //Shared by both threads, guarded by queueLock
+    QMutex queueLock;
+    QWaitCondition queueNotFull;
+    QWaitCondition queueNotEmpty;
+    QQueue<QByteArray> chunkQueue;
+    bool inputDone = false;
+    bool inputStopped = false;
+    bool inflateOK = false;
+    bool wasCancelled = false;
+    qint64 bytesRead = 0;
+
+    QFuture<void> inflateJob;
+
+    //Text before the list is kept until the file header is read
+    bool headerRead = false;
+    QByteArray headerText;
+    QByteArray wholeFile;
+    std::unique_ptr<CFDstreamParser> myParser;
+    std::unique_ptr<CFDtokenizer> myTokenizer;
+};
+
+#endif // CFDPARSEPIPELINE_H
@@ -0,0 +1,53 @@
+# Parsing of OpenFOAM result files
+# Shared by the main program and the benchmarks, which have no Agave connection
+
+# Large lists are read on several threads
+QT += concurrent
+
+!win32 {
+    LIBS += -lz
+}
+win32 {
+    LIBS += Psapi.lib
+}
+
+# zstd results are read with the zstd decoder built in, lz4 with CFDlz4Frame
+include($$PWD/thirdParty/zstd/zstd.pri)
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/cfdarena.cpp \
+    $$PWD/cfdtoken.cpp \
+    $$PWD/cfdtokenizer.cpp \
+    $$PWD/cfdlexer.cpp \
+    $$PWD/cfdfoamdict.cpp \
+    $$PWD/cfdlistreader.cpp \
+    $$PWD/cfdnumberparser.cpp \
+    $$PWD/cfdstreamparser.cpp \
+    $$PWD/cfdparsepipeline.cpp \
+    $$PWD/cfdcodec.cpp \
+    $$PWD/cfdlz4frame.cpp \
+    $$PWD/cfdlocalfile.cpp \
+    $$PWD/cfdmeshsidecar.cpp \
+    $$PWD/cfdmemoryuse.cpp \
+    $$PWD/cfdfieldstats.cpp \
+    $$PWD/decompresswrapper.cpp
+
+HEADERS += \
+    $$PWD/cfdarena.h \
+    $$PWD/cfdtoken.h \
+    $$PWD/cfdtokenizer.h \
+    $$PWD/cfdlexer.h \
+    $$PWD/cfdfoamdict.h \
+    $$PWD/cfdlistreader.h \
+    $$PWD/cfdnumberparser.h \
+    $$PWD/cfdstreamparser.h \
+    $$PWD/cfdparsepipeline.h \
+    $$PWD/cfdcodec.h \
+    $$PWD/cfdlz4frame.h \
+    $$PWD/cfdlocalfile.h \
+    $$PWD/cfdmeshsidecar.h \
+    $$PWD/cfdmemoryuse.h \
+    $$PWD/cfdfieldstats.h \
+    $$PWD/decompresswrapper.h
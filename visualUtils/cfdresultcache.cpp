@@ -0,0 +1,197 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdresultcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+QMutex CFDresultCache::cacheLock;
+qint64 CFDresultCache::maxBytes = 2048LL * 1024 * 1024;
+
+QString CFDresultCache::lookupFile(QString remotePath, qint64 remoteSize)
+{
+    QMutexLocker cacheLocker(&cacheLock);
+    if ((maxBytes <= 0) || (remoteSize <= 0)) return QString();
+
+    QFile keyFile(getKeyFileName(remotePath, remoteSize));
+    if (!keyFile.open(QIODevice::ReadOnly)) return QString();
+    QString contentHash = QString::fromLatin1(keyFile.readAll().trimmed());
+    keyFile.close();
+
+    //The stored file may have been removed to make room
+    QString storedName = getCacheFolder() + "/blobs/" + contentHash;
+    QFile storedFile(storedName);
+    if (contentHash.isEmpty() || (storedFile.size() != remoteSize))
+    {
+        keyFile.remove();
+        return QString();
+    }
+
+    markUsed(storedName);
+    return storedName;
+}
+
+bool CFDresultCache::storeFile(QString remotePath, qint64 remoteSize, QByteArray fileData)
+{
+    qint64 sizeLimit = getMaxBytes();
+    if ((sizeLimit <= 0) || (remoteSize <= 0) || (fileData.size() != remoteSize)) return false;
+    if (fileData.size() > sizeLimit) return false;
+
+    QString contentHash = QString::fromLatin1(QCryptographicHash::hash(fileData, QCryptographicHash::Sha1).toHex());
+    QString blobFolder = getCacheFolder() + "/blobs";
+    QString keyFolder = getCacheFolder() + "/keys";
+    if (!QDir().mkpath(blobFolder) || !QDir().mkpath(keyFolder)) return false;
+
+    //Note: files are only replaced once fully written, so a reader never sees part of one.
+    //The large write is not done holding the lock, so that lookups are not held up.
+    QString storedName = blobFolder + "/" + contentHash;
+    if (QFileInfo(storedName).size() != fileData.size())
+    {
+        QSaveFile storedFile(storedName);
+        if (!storedFile.open(QIODevice::WriteOnly)) return false;
+        if (storedFile.write(fileData) != fileData.size()) return false;
+        if (!storedFile.commit()) return false;
+    }
+
+    QMutexLocker cacheLocker(&cacheLock);
+    QSaveFile keyFile(getKeyFileName(remotePath, remoteSize));
+    if (!keyFile.open(QIODevice::WriteOnly)) return false;
+    keyFile.write(contentHash.toLatin1());
+    if (!keyFile.commit()) return false;
+
+    removeOldFiles();
+    return true;
+}
+
+QString CFDresultCache::getSidecarName(QString remotePath, qint64 remoteSize, QString parseKind)
+{
+    if ((getMaxBytes() <= 0) || (remoteSize <= 0)) return QString();
+
+    QString sidecarFolder = getCacheFolder() + "/meshes";
+    if (!QDir().mkpath(sidecarFolder)) return QString();
+
+    QByteArray keyText = remotePath.toUtf8() + "\n" + QByteArray::number(remoteSize) + "\n" + parseKind.toUtf8();
+    QString keyHash = QString::fromLatin1(QCryptographicHash::hash(keyText, QCryptographicHash::Sha1).toHex());
+    return sidecarFolder + "/" + keyHash + ".cwemesh";
+}
+
+bool CFDresultCache::useSidecar(QString sidecarName)
+{
+    QMutexLocker cacheLocker(&cacheLock);
+    if (!QFileInfo(sidecarName).exists()) return false;
+
+    markUsed(sidecarName);
+    return true;
+}
+
+void CFDresultCache::trimCache()
+{
+    QMutexLocker cacheLocker(&cacheLock);
+    removeOldFiles();
+}
+
+void CFDresultCache::setMaxBytes(qint64 newMax)
+{
+    QMutexLocker cacheLocker(&cacheLock);
+    maxBytes = newMax;
+}
+
+qint64 CFDresultCache::getMaxBytes()
+{
+    QMutexLocker cacheLocker(&cacheLock);
+    return maxBytes;
+}
+
+QString CFDresultCache::getCacheFolder()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results";
+}
+
+QString CFDresultCache::getKeyFileName(QString remotePath, qint64 remoteSize)
+{
+    QByteArray keyText = remotePath.toUtf8() + "\n" + QByteArray::number(remoteSize);
+    QString keyHash = QString::fromLatin1(QCryptographicHash::hash(keyText, QCryptographicHash::Sha1).toHex());
+    return getCacheFolder() + "/keys/" + keyHash;
+}
+
+void CFDresultCache::markUsed(QString fileName)
+{
+    //The modified time is the time of last use, for choosing what to remove
+    QFile usedFile(fileName);
+    if (usedFile.open(QIODevice::ReadWrite))
+    {
+        usedFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        usedFile.close();
+    }
+}
+
+void CFDresultCache::removeOldFiles()
+{
+    //Note: only names of a whole hash, not files part way through being written
+    QString hashName(40, QChar('?'));
+    QFileInfoList storedFiles = QDir(getCacheFolder() + "/blobs").entryInfoList({hashName, hashName + ".gzi"}, QDir::Files);
+    storedFiles.append(QDir(getCacheFolder() + "/meshes").entryInfoList({hashName + ".cwemesh"}, QDir::Files));
+
+    //Oldest first
+    std::sort(storedFiles.begin(), storedFiles.end(), [](const QFileInfo &file1, const QFileInfo &file2)
+    {
+        return file1.lastModified() < file2.lastModified();
+    });
+
+    qint64 totalBytes = 0;
+    for (const QFileInfo &aFile : storedFiles)
+    {
+        totalBytes += aFile.size();
+    }
+
+    //Note: keys of removed files are cleared when next looked up
+    for (const QFileInfo &aFile : storedFiles)
+    {
+        if (totalBytes <= maxBytes) break;
+        qint64 fileBytes = aFile.size();
+        if (QFile::remove(aFile.absoluteFilePath()))
+        {
+            totalBytes -= fileBytes;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDRESULTCACHE_H
+#define CFDRESULTCACHE_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+//Keeps downloaded result files on the local disk, so reopening a result is a local read.
+//Files are stored by the hash of their contents, so a mesh shared by several cases is
+//kept once. Each remote path and size points to one stored file. The size, from the
+//folder listing, is how a changed remote file is noticed.
+//Parsed lists (see CFDmeshSidecar) and gzip block indexes (see CFDlocalFile) are kept here as well,
+//and count towards the same limit.
+//When the cache is over its size limit, the files used longest ago are removed.
+
+class CFDresultCache
+{
+public:
+    //Returns the local copy of the file, or an empty string if there is none
+    static QString lookupFile(QString remotePath, qint64 remoteSize);
+    //May be called from any thread
+    static bool storeFile(QString remotePath, qint64 remoteSize, QByteArray fileData);
+
+    //The sidecar for one way of parsing a file, parseKind tells these apart.
+    //Returns an empty string if the cache is off.
+    static QString getSidecarName(QString remotePath, qint64 remoteSize, QString parseKind);
+    //Returns false if there is no such sidecar
+    static bool useSidecar(QString sidecarName);
+    //Removes the files used longest ago, if the cache is over its limit
+    static void trimCache();
+
+    //A limit of 0 turns the cache off
+    static void setMaxBytes(qint64 newMax);
+    static qint64 getMaxBytes();
+    static QString getCacheFolder();
+
+private:
+    static QString getKeyFileName(QString remotePath, qint64 remoteSize);
+    static void markUsed(QString fileName);
+    static void removeOldFiles();
+
+    static QMutex cacheLock;
+    static qint64 maxBytes;
+};
+
+#endif // CFDRESULTCACHE_H
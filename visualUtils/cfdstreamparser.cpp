@@ -0,0 +1,423 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdstreamparser.h"
+
+#include "cfdnumberparser.h"
+
+#include <climits>
+
+CFDstreamParser::CFDstreamParser(CFDlistKind kind, bool isField, bool isCompact, CFDlistOutput * output)
+{
+    myKind = kind;
+    compactFaces = isCompact && (kind == CFDlistKind::FACE);
+    myOutput = output;
+    myState = isField ? CFDstreamState::FIND_FIELD : CFDstreamState::FIND_LIST;
+
+    if (compactFaces)
+    {
+        //The offsets list comes first, and is read as labels
+        myKind = CFDlistKind::LABEL;
+        myErrorText = "Face offset list does not contain ints";
+    }
+    else if (kind == CFDlistKind::LABEL) myErrorText = "Label list does not contain ints";
+    else if (kind == CFDlistKind::FACE) myErrorText = "Face list does not contain faces";
+    else if (kind == CFDlistKind::SCALAR) myErrorText = "Data list does not contain floats";
+    else if (isField) myErrorText = "Data list does not contain float arrays";
+    else myErrorText = "Point list does not contain points";
+}
+
+void CFDstreamParser::receiveToken(CFDlexType kind, qint64, const char * text, int length)
+{
+    switch (myState)
+    {
+    case CFDstreamState::FIND_FIELD:
+        if ((kind == CFDlexType::OPEN_PAREN) || (kind == CFDlexType::OPEN_BRACE)) outerDepth++;
+        else if ((kind == CFDlexType::CLOSE_PAREN) || (kind == CFDlexType::CLOSE_BRACE)) outerDepth--;
+        else if ((outerDepth == 0) && (QByteArray::fromRawData(text, length) == "internalField"))
+        {
+            myState = CFDstreamState::FIELD_KIND;
+        }
+        return;
+
+    case CFDstreamState::FIELD_KIND:
+    {
+        QByteArray fieldKind = QByteArray::fromRawData(text, length);
+        if ((kind == CFDlexType::WORD) && (fieldKind == "nonuniform"))
+        {
+            myState = CFDstreamState::FIELD_TYPE;
+        }
+        else if ((kind == CFDlexType::WORD) && (fieldKind == "uniform"))
+        {
+            readFailure("Data file has a uniform internal field");
+        }
+        else
+        {
+            readFailure("Unable to locate data in data file");
+        }
+        return;
+    }
+
+    case CFDstreamState::FIELD_TYPE:
+    {
+        const char * listType = (myKind == CFDlistKind::VECTOR) ? "List<vector>" : "List<scalar>";
+        if ((kind != CFDlexType::WORD) || (QByteArray::fromRawData(text, length) != listType))
+        {
+            readFailure("Data list is not of the expected type");
+            return;
+        }
+        myState = CFDstreamState::FIND_LIST;
+        return;
+    }
+
+    case CFDstreamState::FIND_LIST:
+        if (kind == CFDlexType::WORD)
+        {
+            qint64 aSize;
+            if (CFDnumberParser::parseLabel(text, text + length, &aSize) && (aSize >= 0) && (aSize <= INT_MAX))
+            {
+                pendingSize = aSize;
+            }
+            else
+            {
+                pendingSize = -1;
+            }
+            return;
+        }
+
+        listSize = pendingSize;
+        pendingSize = -1;
+        entryCount = 0;
+        entryParts = 0;
+        faceSize = 0;
+        inEntry = false;
+        if (kind == CFDlexType::OPEN_PAREN)
+        {
+            myState = CFDstreamState::IN_LIST;
+            if (listSize > 0) reserveForList();
+            if ((myKind == CFDlistKind::FACE) && myOutput->faceOffsets->empty())
+            {
+                myOutput->faceOffsets->push_back(0);
+            }
+            return;
+        }
+
+        //Lists of identical entries can be written as N{value}
+        if ((kind == CFDlexType::OPEN_BRACE) && (listSize != -1) && (myKind != CFDlistKind::FACE))
+        {
+            myState = CFDstreamState::IN_UNIFORM;
+            return;
+        }
+        readFailure("Unable to locate list data");
+        return;
+
+    case CFDstreamState::IN_LIST:
+        receiveListToken(kind, text, length);
+        return;
+
+    case CFDstreamState::IN_UNIFORM:
+        receiveUniformToken(kind, text, length);
+        return;
+
+    case CFDstreamState::DONE:
+    case CFDstreamState::FAILED:
+        return;
+    }
+}
+
+bool CFDstreamParser::finish()
+{
+    if (myState == CFDstreamState::DONE) return true;
+    if (myState == CFDstreamState::FAILED) return false;
+
+    if ((myState == CFDstreamState::IN_LIST) || (myState == CFDstreamState::IN_UNIFORM))
+    {
+        readFailure("List is not closed");
+    }
+    else if (myState == CFDstreamState::FIND_FIELD)
+    {
+        readFailure("Unable to locate data in data file");
+    }
+    else
+    {
+        readFailure("Unable to locate list data");
+    }
+    return false;
+}
+
+bool CFDstreamParser::isDone() const
+{
+    return (myState == CFDstreamState::DONE);
+}
+
+bool CFDstreamParser::hasFailed() const
+{
+    return (myState == CFDstreamState::FAILED);
+}
+
+QString CFDstreamParser::getReadError() const
+{
+    return readError;
+}
+
+void CFDstreamParser::receiveListToken(CFDlexType kind, const char * text, int length)
+{
+    if (kind == CFDlexType::WORD)
+    {
+        if (!readEntryWord(text, length)) readFailure(myErrorText);
+        return;
+    }
+
+    if (kind == CFDlexType::OPEN_PAREN)
+    {
+        //Vectors and faces are the only entries in parens
+        bool canOpen = (myKind == CFDlistKind::VECTOR) ? !inEntry :
+                       ((myKind == CFDlistKind::FACE) && !inEntry && (faceSize > 0));
+        if (!canOpen)
+        {
+            readFailure(myErrorText);
+            return;
+        }
+        inEntry = true;
+        entryParts = 0;
+        return;
+    }
+
+    if (kind != CFDlexType::CLOSE_PAREN)
+    {
+        readFailure(myErrorText);
+        return;
+    }
+
+    if (!inEntry)
+    {
+        if ((myKind == CFDlistKind::FACE) && (faceSize > 0))
+        {
+            readFailure(myErrorText);
+            return;
+        }
+        endList();
+        return;
+    }
+
+    inEntry = false;
+    if (myKind == CFDlistKind::VECTOR)
+    {
+        if (entryParts != 3)
+        {
+            readFailure(myErrorText);
+            return;
+        }
+        myOutput->doubleVals->insert(myOutput->doubleVals->end(), entryVals, entryVals + 3);
+    }
+    else
+    {
+        if (entryParts != faceSize)
+        {
+            readFailure(myErrorText);
+            return;
+        }
+        myOutput->faceOffsets->push_back(static_cast<int>(myOutput->labelVals->size()));
+        faceSize = 0;
+    }
+    entryCount++;
+}
+
+void CFDstreamParser::receiveUniformToken(CFDlexType kind, const char * text, int length)
+{
+    if (kind == CFDlexType::WORD)
+    {
+        if (!readEntryWord(text, length)) readFailure(myErrorText);
+        return;
+    }
+
+    if ((kind == CFDlexType::OPEN_PAREN) && (myKind == CFDlistKind::VECTOR) && !inEntry && (entryParts == 0))
+    {
+        inEntry = true;
+        return;
+    }
+    if ((kind == CFDlexType::CLOSE_PAREN) && inEntry && (entryParts == 3))
+    {
+        inEntry = false;
+        return;
+    }
+    if ((kind != CFDlexType::CLOSE_BRACE) || inEntry)
+    {
+        readFailure(myErrorText);
+        return;
+    }
+
+    //readEntryWord has already added the value once
+    size_t valueCount = (myKind == CFDlistKind::VECTOR) ? 3 : 1;
+    bool hasValue = (myKind == CFDlistKind::VECTOR) ? (entryParts == 3) : (entryCount == 1);
+    if (!hasValue)
+    {
+        readFailure(myErrorText);
+        return;
+    }
+
+    if (myKind == CFDlistKind::LABEL)
+    {
+        myOutput->labelVals->assign(static_cast<size_t>(listSize), myOutput->labelVals->back());
+    }
+    else
+    {
+        std::vector<double> aValue(entryVals, entryVals + valueCount);
+        myOutput->doubleVals->clear();
+        myOutput->doubleVals->reserve(valueCount * static_cast<size_t>(listSize));
+        for (qint64 ind = 0; ind < listSize; ind++)
+        {
+            myOutput->doubleVals->insert(myOutput->doubleVals->end(), aValue.begin(), aValue.end());
+        }
+    }
+    entryCount = static_cast<int>(listSize);
+    endList();
+}
+
+bool CFDstreamParser::readEntryWord(const char * text, int length)
+{
+    const char * textEnd = text + length;
+    bool isUniform = (myState == CFDstreamState::IN_UNIFORM);
+
+    if (myKind == CFDlistKind::LABEL)
+    {
+        qint64 aLabel;
+        if (isUniform && (entryCount != 0)) return false;
+        if (!CFDnumberParser::parseLabel(text, textEnd, &aLabel)) return false;
+        if ((aLabel > INT_MAX) || (aLabel < INT_MIN)) return false;
+        myOutput->labelVals->push_back(static_cast<int>(aLabel));
+        entryCount++;
+        return true;
+    }
+
+    if (myKind == CFDlistKind::SCALAR)
+    {
+        double aValue;
+        if (isUniform && (entryCount != 0)) return false;
+        if (!CFDnumberParser::parseDouble(text, textEnd, &aValue)) return false;
+        if (isUniform)
+        {
+            entryVals[0] = aValue;
+            entryCount++;
+            return true;
+        }
+        myOutput->doubleVals->push_back(aValue);
+        entryCount++;
+        return true;
+    }
+
+    if (myKind == CFDlistKind::VECTOR)
+    {
+        if (!inEntry || (entryParts >= 3)) return false;
+        return CFDnumberParser::parseDouble(text, textEnd, &entryVals[entryParts++]);
+    }
+
+    //Faces are a size, then the point indices in parens
+    qint64 aLabel;
+    if (!CFDnumberParser::parseLabel(text, textEnd, &aLabel)) return false;
+    if (!inEntry)
+    {
+        if ((faceSize != 0) || (aLabel < 1) || (aLabel > INT_MAX)) return false;
+        faceSize = static_cast<int>(aLabel);
+        return true;
+    }
+    if ((entryParts >= faceSize) || (aLabel > INT_MAX) || (aLabel < INT_MIN)) return false;
+    myOutput->labelVals->push_back(static_cast<int>(aLabel));
+    entryParts++;
+    return true;
+}
+
+void CFDstreamParser::reserveForList()
+{
+    size_t entryTotal = static_cast<size_t>(listSize);
+    if (myKind == CFDlistKind::LABEL) myOutput->labelVals->reserve(entryTotal);
+    else if (myKind == CFDlistKind::SCALAR) myOutput->doubleVals->reserve(entryTotal);
+    else if (myKind == CFDlistKind::VECTOR) myOutput->doubleVals->reserve(3 * entryTotal);
+    else
+    {
+        //Most faces are quads, so this is usually close
+        myOutput->faceOffsets->reserve(entryTotal + 1);
+        myOutput->labelVals->reserve(4 * entryTotal);
+    }
+}
+
+void CFDstreamParser::endList()
+{
+    if ((listSize != -1) && (listSize != entryCount))
+    {
+        readFailure("List size does not match its header");
+        return;
+    }
+
+    if (!compactFaces)
+    {
+        myState = CFDstreamState::DONE;
+        return;
+    }
+
+    if (!readingIndices)
+    {
+        //The offsets list is done, the point indices are next
+        readingIndices = true;
+        myOutput->faceOffsets->swap(*myOutput->labelVals);
+        myOutput->labelVals->clear();
+        myErrorText = "Face list does not contain ints";
+        myState = CFDstreamState::FIND_LIST;
+        return;
+    }
+
+    std::vector<int> & faceOffsets = *myOutput->faceOffsets;
+    if (faceOffsets.empty() || (faceOffsets.front() != 0) ||
+            (faceOffsets.back() != static_cast<int>(myOutput->labelVals->size())))
+    {
+        readFailure("Face offset list does not match face list");
+        return;
+    }
+    for (size_t ind = 1; ind < faceOffsets.size(); ind++)
+    {
+        if (faceOffsets[ind] <= faceOffsets[ind - 1])
+        {
+            readFailure("Face list does not contain faces");
+            return;
+        }
+    }
+    myState = CFDstreamState::DONE;
+}
+
+void CFDstreamParser::readFailure(QString errorText)
+{
+    readError = errorText;
+    myState = CFDstreamState::FAILED;
+}
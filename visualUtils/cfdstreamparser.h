@@ -0,0 +1,110 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDSTREAMPARSER_H
+#define CFDSTREAMPARSER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+#include "cfdtokenizer.h"
+#include "cfdlistreader.h"
+
+//Reads one ASCII list from a stream of tokens, so the file text need not all be in memory at once.
+//This is for the text after the FoamFile header, which is read first with CFDfoamDict.
+//Binary files cannot be tokenized, and are read whole with CFDlistReader.
+
+enum class CFDstreamState
+{
+    FIND_FIELD,
+    FIELD_KIND,
+    FIELD_TYPE,
+    FIND_LIST,
+    IN_LIST,
+    IN_UNIFORM,
+    DONE,
+    FAILED
+};
+
+class CFDstreamParser : public CFDtokenSink
+{
+public:
+    //If isField, the internalField list is read, otherwise the first list in the file
+    //For faceCompactList files, give FACE with isCompact, the two lists are read as one
+    CFDstreamParser(CFDlistKind kind, bool isField, bool isCompact, CFDlistOutput * output);
+
+    virtual void receiveToken(CFDlexType kind, qint64 offset, const char * text, int length);
+
+    //Returns false if the list was not found, or not complete
+    bool finish();
+
+    bool isDone() const;
+    bool hasFailed() const;
+    QString getReadError() const;
+
+private:
+    void receiveListToken(CFDlexType kind, const char * text, int length);
+    void receiveUniformToken(CFDlexType kind, const char * text, int length);
+    bool readEntryWord(const char * text, int length);
+    void reserveForList();
+    void endList();
+    void readFailure(QString errorText);
+
+    CFDlistKind myKind;
+    bool compactFaces;
+    CFDlistOutput * myOutput;
+    CFDstreamState myState;
+    const char * myErrorText;
+
+    //Brackets are counted outside of lists, to find internalField at the top level
+    int outerDepth = 0;
+
+    qint64 pendingSize = -1;
+    qint64 listSize = -1;
+    int entryCount = 0;
+    bool inEntry = false;
+    bool readingIndices = false;
+
+    //Parts of the current entry
+    double entryVals[3];
+    int entryParts = 0;
+    int faceSize = 0;
+
+    QString readError;
+};
+
+#endif // CFDSTREAMPARSER_H
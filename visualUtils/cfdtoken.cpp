@@ -35,27 +35,54 @@
 
 #include "cfdtoken.h"
 
-CFDtoken::CFDtoken()
+#include "cfdlexer.h"
+#include "cfdnumberparser.h"
+
+#include <climits>
+#include <vector>
+
+CFDtokenSpan::CFDtokenSpan(CFDtoken * first, int count)
+{
+    myFirst = first;
+    myCount = count;
+}
+
+CFDtoken * CFDtokenSpan::begin() const
+{
+    return myFirst;
+}
+
+CFDtoken * CFDtokenSpan::end() const
+{
+    return myFirst + myCount;
+}
+
+int CFDtokenSpan::size() const
+{
+    return myCount;
+}
+
+bool CFDtokenSpan::isEmpty() const
 {
-    nullfiyContent();
+    return (myCount == 0);
 }
 
-CFDtoken::~CFDtoken()
+CFDtoken & CFDtokenSpan::operator[](int index) const
 {
-    nullfiyContent();
+    return myFirst[index];
 }
 
-CFDtokenType CFDtoken::getType()
+CFDtokenType CFDtoken::getType() const
 {
     return myType;
 }
 
-int CFDtoken::getIntVal()
+int CFDtoken::getIntVal() const
 {
     return myInt;
 }
 
-double CFDtoken::getFloatVal()
+double CFDtoken::getFloatVal() const
 {
     if (myType == CFDtokenType::INT)
     {
@@ -64,7 +91,7 @@ double CFDtoken::getFloatVal()
     return myFloat;
 }
 
-QByteArray CFDtoken::getStringVal()
+QByteArray CFDtoken::getStringVal() const
 {
     if (myType == CFDtokenType::INT)
     {
@@ -74,382 +101,191 @@ QByteArray CFDtoken::getStringVal()
     {
         return QByteArray::number(myFloat);
     }
-    return myString;
+    return QByteArray(myString, myStringLen);
 }
 
-QLinkedList<CFDtoken *> CFDtoken::getChildList()
+CFDtokenSpan CFDtoken::getChildList() const
 {
-    return childList;
+    return CFDtokenSpan(myChildren, myChildCount);
 }
 
-int CFDtoken::getChildSize()
+int CFDtoken::getChildSize() const
 {
-    return childList.size();
+    return myChildCount;
+}
+
+CFDtoken * CFDtoken::getParent() const
+{
+    return myParent;
 }
 
-CFDtoken * CFDtoken::getLargestChildArray()
+CFDtoken * CFDtoken::getLargestChildArray() const
 {
     CFDtoken * ret = nullptr;
     int refSize = -1;
-    for (auto itr = childList.begin(); itr != childList.end(); itr++)
+    for (CFDtoken & aChild : getChildList())
     {
-        if ((*itr)->getType() == CFDtokenType::DATA_ARRAY)
+        if (aChild.getType() == CFDtokenType::DATA_ARRAY)
         {
-            if ((*itr)->getChildSize() > refSize)
+            if (aChild.getChildSize() > refSize)
             {
-                ret = (*itr);
+                ret = &aChild;
+                refSize = aChild.getChildSize();
             }
         }
     }
     return ret;
 }
 
-CFDtoken * CFDtoken::getParent()
+void CFDtoken::setString(const char * newString, int stringLen)
 {
-    return myParent;
-}
-
-QByteArray * CFDtoken::stripCFDcomments(QByteArray * rawInput)
-{
-    //Comments can be //
-    /* or have the multiline format */
+    myType = CFDtokenType::STRING;
+    myString = newString;
+    myStringLen = stringLen;
 
-    while (rawInput->contains("/*"))
+    const char * stringEnd = newString + stringLen;
+    qint64 intVal;
+    if (CFDnumberParser::parseLabel(newString, stringEnd, &intVal) &&
+            (intVal <= INT_MAX) && (intVal >= INT_MIN))
     {
-        int startComment = rawInput->indexOf("/*");
-        int endComment = rawInput->indexOf("*/", startComment);
-        if (endComment != -1)
-        {
-            int commentLen = endComment - startComment + 2;
-            rawInput->remove(startComment,commentLen);
-        }
+        myType = CFDtokenType::INT;
+        myInt = static_cast<int>(intVal);
+        return;
     }
 
-    while (rawInput->contains("//"))
+    if (CFDnumberParser::parseDouble(newString, stringEnd, &myFloat))
     {
-        int startComment = rawInput->indexOf("//");
-        int endComment = rawInput->indexOf("\n", startComment);
-        if (endComment != -1)
-        {
-            int commentLen = endComment - startComment;
-            rawInput->remove(startComment,commentLen);
-        }
+        myType = CFDtokenType::FLOAT;
     }
-    return rawInput;
 }
 
-CFDtoken * CFDtoken::lexifyString(QByteArray * rawInput)
-{
-    bool withinToken = false;
-
-    rawInput = stripCFDcomments(rawInput);
+CFDtokenTree::CFDtokenTree() {}
 
-    CFDtoken * ret = new CFDtoken();
-
-    QByteArray oneToken;
-
-    for (auto itr = rawInput->cbegin(); itr != rawInput->cend(); itr++)
+bool CFDtokenTree::lexifyString(const QByteArray * rawInput)
+{
+    clear();
+    if (rawInput == nullptr) return false;
+
+    //Sharing the input keeps the token strings valid, without copying them
+    myInput = *rawInput;
+    CFDlexer theLexer(&myInput);
+    if (!theLexer.lexify()) return false;
+
+    //First, we perform {} and () matching
+    int tokenCount = theLexer.getTokenCount();
+    std::vector<int> matchList(static_cast<size_t>(tokenCount), -1);
+    std::vector<int> openStack;
+    for (int ind = 0; ind < tokenCount; ind++)
     {
-        char aLetter = (*itr);
-
-        if (std::isspace(aLetter))
+        CFDlexType aKind = theLexer.getKind(ind);
+        if ((aKind == CFDlexType::OPEN_PAREN) || (aKind == CFDlexType::OPEN_BRACE))
         {
-            if (withinToken)
-            {
-                CFDtoken * tmp = new CFDtoken();
-                tmp->setString(oneToken);
-                ret->addChild(tmp);
-                oneToken.clear();
-
-                withinToken = false;
-            }
+            openStack.push_back(ind);
         }
-        else if ((aLetter == '(') || (aLetter == ')') || (aLetter == '{') || (aLetter == '}'))
+        else if ((aKind == CFDlexType::CLOSE_PAREN) || (aKind == CFDlexType::CLOSE_BRACE))
         {
-            if (withinToken)
-            {
-                CFDtoken * tmp = new CFDtoken();
-                tmp->setString(oneToken);
-                ret->addChild(tmp);
-                oneToken.clear();
+            if (openStack.empty()) return false;
+            int openIndex = openStack.back();
+            openStack.pop_back();
 
-                withinToken = false;
-            }
-            CFDtoken * tmp = new CFDtoken();
-            tmp->myType = CFDtokenType::SPECIAL_CHAR;
-            tmp->specialChar = aLetter;
-            ret->addChild(tmp);
-        }
-        else
-        {
-            if (!withinToken)
-            {
-                oneToken.clear();
-                withinToken = true;
-            }
-            oneToken.append(aLetter);
+            CFDlexType openKind = theLexer.getKind(openIndex);
+            if ((openKind == CFDlexType::OPEN_PAREN) != (aKind == CFDlexType::CLOSE_PAREN)) return false;
+            matchList[static_cast<size_t>(openIndex)] = ind;
         }
     }
+    if (!openStack.empty()) return false;
 
-    if (withinToken)
-    {
-        CFDtoken * tmp = new CFDtoken();
-        tmp->setString(oneToken);
-        ret->addChild(tmp);
-    }
-
-    return ret;
-}
+    myArena.reserve(static_cast<size_t>(tokenCount + 1) * sizeof(CFDtoken));
+    myRoot = myArena.allocateArray<CFDtoken>(1);
+    myRoot->myType = CFDtokenType::TREE_NODE;
 
-bool CFDtoken::parseTokenStream(CFDtoken * rootToken)
-{
-    //First, we perform {} and () matching to create data subnodes
-    if (collapseParenTokens(rootToken) == false)
+    //Then each node's children are counted and placed together.
+    //Bracketed children are queued and filled in the same way.
+    struct PendingNode
     {
-        return false;
-    }
-
-    //Note: if we need to implement further parsing: Put it here
-
-    return true;
-}
-
-QLinkedList<CFDtoken *>::iterator CFDtoken::insertParentToken(
-        CFDtoken * rootToken,
-        QLinkedList<CFDtoken *>::iterator start,
-        QLinkedList<CFDtoken *>::iterator end)
-{
-    if ((*start)->getParent() != (*end)->getParent())
-    {
-        return rootToken->childList.end();
-    }
-    if ((*start)->getParent() != rootToken)
-    {
-        return rootToken->childList.end();
-    }
-
-    CFDtoken * tmpNode = (*start);
-    start = rootToken->childList.erase(start);
-    delete tmpNode;
-
-    tmpNode = (*end);
-    end = rootToken->childList.erase(end);
-    delete tmpNode;
-
-    QLinkedList<CFDtoken *>::iterator workPtr = start;
-    CFDtoken * newTreeNode = new CFDtoken();
-    newTreeNode->setParent(rootToken);
-
-    while (workPtr != end)
-    {
-        newTreeNode->addChild(*workPtr);
-        workPtr = rootToken->childList.erase(workPtr);
-    }
-    end = rootToken->childList.insert(end,newTreeNode);
-
-    return end;
-}
-
-bool CFDtoken::collapseParenTokens(CFDtoken * rootToken)
-{
-    bool atFirstNode = true;
-    bool foundOne = true;
-
-    QLinkedList<CFDtoken *>::iterator startItr = rootToken->childList.begin();
-    QLinkedList<CFDtoken *>::iterator endItr = startItr;
-
-    while (foundOne)
+        CFDtoken * node;
+        int firstToken;
+        int endToken;
+        int expectedSize;
+    };
+    std::vector<PendingNode> workList;
+    workList.push_back({myRoot, 0, tokenCount, -1});
+
+    while (!workList.empty())
     {
-        foundOne = false;
-        bool expectDataArray = false;
+        PendingNode aNode = workList.back();
+        workList.pop_back();
 
-        while (startItr != rootToken->childList.end() &&
-               !(*startItr)->isParenToken())
+        int childCount = 0;
+        int dictCount = 0;
+        for (int ind = aNode.firstToken; ind < aNode.endToken; ind++)
         {
-            startItr++;
-            atFirstNode = false; //Note: Can move this if it slows things too much
+            if (theLexer.isSizePrefix(ind)) continue;
+            childCount++;
+            if (theLexer.getKind(ind) == CFDlexType::OPEN_BRACE) dictCount++;
+            if (matchList[static_cast<size_t>(ind)] != -1) ind = matchList[static_cast<size_t>(ind)];
         }
 
-        if (startItr == rootToken->childList.end())
-        {
-            return true;
-        }
-
-        endItr = startItr;
-        char startParen = (*startItr)->specialChar;
-        if ((startParen == '}') || (startParen == ')'))
+        //Lists of dictionaries, such as polyMesh/boundary, count each name { ... } pair once
+        if ((aNode.expectedSize != -1) && (aNode.expectedSize != childCount) &&
+                !((aNode.expectedSize == dictCount) && (childCount == 2 * dictCount)))
         {
+            clear();
             return false;
         }
-        int nowDepth = 1;
 
-        endItr++;
-        while ((endItr != rootToken->childList.end()) && (foundOne == false))
+        CFDtoken * aChild = myArena.allocateArray<CFDtoken>(static_cast<size_t>(childCount));
+        aNode.node->myChildren = aChild;
+        aNode.node->myChildCount = childCount;
+
+        int expectedSize = -1;
+        for (int ind = aNode.firstToken; ind < aNode.endToken; ind++)
         {
-            if ((*endItr)->isParenToken())
+            //The N in N ( ... ) is checked against the list, rather than kept
+            if (theLexer.isSizePrefix(ind))
             {
-                char endParen = (*endItr)->specialChar;
-
-                if ((endParen == '{') || (endParen == '('))
-                {
-                    nowDepth++;
-                }
-
-                if ((endParen == '}') || (endParen == ')'))
-                {
-                    nowDepth--;
-                    if (nowDepth < 0)
-                    {
-                        return false;
-                    }
-
-                    if (nowDepth == 0)
-                    {
-                        if ((startParen == '{') && (endParen == '}'))
-                        {
-                            foundOne = true;
-                        }
-                        else if ((startParen == '(') && (endParen == ')'))
-                        {
-                            foundOne = true;
-                            expectDataArray = true;
-                        }
-                    }
-                }
+                expectedSize = theLexer.getIntVal(ind);
+                continue;
             }
-            if (foundOne == false)
+
+            aChild->myParent = aNode.node;
+            CFDlexType aKind = theLexer.getKind(ind);
+            if (aKind == CFDlexType::WORD)
             {
-                endItr++;
+                aChild->setString(theLexer.getTokenData(ind), theLexer.getTokenLength(ind));
             }
-        }
-
-        if (endItr == rootToken->childList.end())
-        {
-            return false;
-        }
-
-        startItr = insertParentToken(rootToken,startItr,endItr);
-
-        if (!collapseParenTokens(*startItr))
-        {
-            return false;
-        }
-
-        if (expectDataArray)
-        {
-            (*startItr)->setAsDataArray();
-
-            if (!atFirstNode)
+            else
             {
-                QLinkedList<CFDtoken *>::iterator beforeItr = startItr;
-                beforeItr--;
-
-                if ((*beforeItr)->getType() == CFDtokenType::INT)
+                int closeIndex = matchList[static_cast<size_t>(ind)];
+                if (aKind == CFDlexType::OPEN_PAREN)
+                {
+                    aChild->myType = CFDtokenType::DATA_ARRAY;
+                    workList.push_back({aChild, ind + 1, closeIndex, expectedSize});
+                }
+                else
                 {
-                    CFDtoken * expectedIntNode = (*beforeItr);
-                    rootToken->childList.erase(beforeItr);
-                    int numInArray = expectedIntNode->getIntVal();
-                    delete expectedIntNode;
-
-                    if (numInArray != (*startItr)->getChildSize())
-                    {
-                        return false;
-                    }
+                    aChild->myType = CFDtokenType::TREE_NODE;
+                    workList.push_back({aChild, ind + 1, closeIndex, -1});
                 }
+                ind = closeIndex;
             }
-        }
-    }
-    return false;
-}
 
-bool CFDtoken::isParenToken()
-{
-    if (myType != CFDtokenType::SPECIAL_CHAR)
-    {
-        return false;
-    }
-    if (specialChar == '(') return true;
-    if (specialChar == ')') return true;
-    if (specialChar == '{') return true;
-    if (specialChar == '}') return true;
-
-    return false;
-}
-
-void CFDtoken::nullfiyContent()
-{
-    myType = CFDtokenType::INVALID;
-    myString.clear();
-    myInt = 0;
-    myFloat = 0.0;
-
-    while (!childList.isEmpty())
-    {
-        CFDtoken * aChild = childList.takeLast();
-        delete aChild;
-    }
-}
-
-void CFDtoken::setInt(int newVal)
-{
-    nullfiyContent();
-    myType = CFDtokenType::INT;
-    myInt = newVal;
-}
-
-void CFDtoken::setFloat(double newVal)
-{
-    nullfiyContent();
-    myType = CFDtokenType::FLOAT;
-    myFloat = newVal;
-}
-
-void CFDtoken::setString(QByteArray newVal)
-{
-    nullfiyContent();
-    myType = CFDtokenType::STRING;
-    myString = newVal;
-
-    bool okCheck;
-    myInt = myString.toInt(&okCheck);
-
-    if (okCheck)
-    {
-        myType = CFDtokenType::INT;
-        return;
-    }
-
-    myFloat = myString.toDouble(&okCheck);
-
-    if (okCheck)
-    {
-        myType = CFDtokenType::FLOAT;
+            expectedSize = -1;
+            aChild++;
+        }
     }
-}
 
-void CFDtoken::addChild(CFDtoken * newChild)
-{
-    if ((myType != CFDtokenType::TREE_NODE) &&
-            (myType != CFDtokenType::DATA_ARRAY))
-    {
-        nullfiyContent();
-        myType = CFDtokenType::TREE_NODE;
-    }
-    newChild->setParent(this);
-    childList.append(newChild);
+    return true;
 }
 
-void CFDtoken::setAsDataArray()
+CFDtoken * CFDtokenTree::getRoot()
 {
-    if ((myType != CFDtokenType::TREE_NODE) &&
-            (myType != CFDtokenType::DATA_ARRAY))
-    {
-        nullfiyContent();
-    }
-    myType = CFDtokenType::DATA_ARRAY;
+    return myRoot;
 }
 
-void CFDtoken::setParent(CFDtoken * newParent)
+void CFDtokenTree::clear()
 {
-    myParent = newParent;
+    myArena.reset();
+    myRoot = nullptr;
+    myInput.clear();
 }
@@ -37,15 +37,16 @@
 #define CFDTOKEN_H
 
 #include <QByteArray>
-#include <QLinkedList>
 
-#include <cctype>
+#include "cfdarena.h"
 
 //Note: this is not a complete parser,
 //but has the framework if anyone wants to complete it later
 
-//TODO Note: Int and float types might be vulnerable to overflow,
-//check the setString function if you wish to change this
+//Tokens live in the arena of the CFDtokenTree which made them,
+//and are all freed together when the tree is cleared or deleted.
+//The children of a token are stored next to each other,
+//so getChildList() is a view which can be walked without copying.
 
 enum class CFDtokenType
 {
@@ -58,53 +59,75 @@ enum class CFDtokenType
     SPECIAL_CHAR
 };
 
-class CFDtoken
+class CFDtoken;
+
+class CFDtokenSpan
 {
 public:
-    CFDtoken();
-    ~CFDtoken();
+    CFDtokenSpan(CFDtoken * first, int count);
 
-    CFDtokenType getType();
-    int getIntVal();
-    double getFloatVal();
-    QByteArray getStringVal();
-    QLinkedList<CFDtoken *> getChildList();
-    int getChildSize();
-    CFDtoken * getParent();
+    CFDtoken * begin() const;
+    CFDtoken * end() const;
+    int size() const;
+    bool isEmpty() const;
+    CFDtoken & operator[](int index) const;
+
+private:
+    CFDtoken * myFirst;
+    int myCount;
+};
 
-    CFDtoken * getLargestChildArray();
+class CFDtoken
+{
+public:
+    CFDtokenType getType() const;
+    int getIntVal() const;
+    double getFloatVal() const;
+    QByteArray getStringVal() const;
+    CFDtokenSpan getChildList() const;
+    int getChildSize() const;
+    CFDtoken * getParent() const;
 
-    static QByteArray * stripCFDcomments(QByteArray * rawInput);
-    static CFDtoken * lexifyString(QByteArray * rawInput);
-    static bool parseTokenStream(CFDtoken * rootToken);
+    CFDtoken * getLargestChildArray() const;
 
 private:
-    void nullfiyContent();
+    friend class CFDtokenTree;
+    friend class CFDarena;
+    CFDtoken() = default;
 
-    void setInt(int newVal);
-    void setFloat(double newVal);
-    void setString(QByteArray newVal);
-    void addChild(CFDtoken * newChild);
-    void setAsDataArray();
-    void setParent(CFDtoken * newParent);
+    void setString(const char * newString, int stringLen);
 
-    static bool collapseParenTokens(CFDtoken * rootToken);
-    static QLinkedList<CFDtoken *>::iterator insertParentToken(
-            CFDtoken * rootToken,
-            QLinkedList<CFDtoken *>::iterator start,
-            QLinkedList<CFDtoken *>::iterator end);
+    CFDtokenType myType = CFDtokenType::INVALID;
 
-    bool isParenToken();
+    CFDtoken * myParent = nullptr;
+    CFDtoken * myChildren = nullptr;
+    int myChildCount = 0;
+
+    //Points into the input held by the tree
+    const char * myString = nullptr;
+    int myStringLen = 0;
+    int myInt = 0;
+    double myFloat = 0.0;
+};
+
+class CFDtokenTree
+{
+public:
+    CFDtokenTree();
 
-    CFDtokenType myType;
+    //Returns false if the brackets do not match, a comment is not closed,
+    //or a list does not have the size given before it
+    bool lexifyString(const QByteArray * rawInput);
 
-    CFDtoken * myParent = nullptr;
-    QLinkedList<CFDtoken *> childList;
-    QByteArray myString;
-    int myInt;
-    double myFloat;
+    CFDtoken * getRoot();
+    void clear();
+
+private:
+    Q_DISABLE_COPY(CFDtokenTree)
 
-    char specialChar;
+    QByteArray myInput;
+    CFDarena myArena;
+    CFDtoken * myRoot = nullptr;
 };
 
 #endif // CFDTOKEN_H
@@ -0,0 +1,263 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "cfdtokenizer.h"
+
+#include <cstring>
+
+namespace {
+
+enum CFDcharClass : quint8
+{
+    WORD_CHAR,
+    SPACE_CHAR,
+    BRACKET_CHAR,
+    SLASH_CHAR
+};
+
+struct CFDcharTable
+{
+    CFDcharTable()
+    {
+        memset(charClass, WORD_CHAR, sizeof(charClass));
+        for (unsigned char aLetter : {' ', '\t', '\n', '\v', '\f', '\r'})
+        {
+            charClass[aLetter] = SPACE_CHAR;
+        }
+        for (unsigned char aLetter : {'(', ')', '{', '}'})
+        {
+            charClass[aLetter] = BRACKET_CHAR;
+        }
+        charClass[static_cast<unsigned char>('/')] = SLASH_CHAR;
+    }
+
+    quint8 charClass[256];
+};
+
+const CFDcharTable CHAR_TABLE;
+
+inline quint8 getCharClass(char aLetter)
+{
+    return CHAR_TABLE.charClass[static_cast<unsigned char>(aLetter)];
+}
+
+}
+
+CFDtokenizer::CFDtokenizer(CFDtokenSink * tokenSink)
+{
+    mySink = tokenSink;
+}
+
+void CFDtokenizer::feed(const char * data, int length)
+{
+    if ((data == nullptr) || (length <= 0)) return;
+
+    //Anything carried over from the last piece continues at the start of this one
+    wordStart = 0;
+    int ind = 0;
+
+    while (ind < length)
+    {
+        switch (myState)
+        {
+        case CFDtokenizerState::BETWEEN:
+        {
+            char aLetter = data[ind];
+            quint8 aClass = getCharClass(aLetter);
+            if (aClass == BRACKET_CHAR)
+            {
+                CFDlexType aKind = CFDlexType::CLOSE_BRACE;
+                if (aLetter == '(') aKind = CFDlexType::OPEN_PAREN;
+                else if (aLetter == ')') aKind = CFDlexType::CLOSE_PAREN;
+                else if (aLetter == '{') aKind = CFDlexType::OPEN_BRACE;
+                mySink->receiveToken(aKind, streamPos + ind, data + ind, 1);
+            }
+            else if (aClass == SLASH_CHAR)
+            {
+                slashInWord = false;
+                myState = CFDtokenizerState::SLASH;
+            }
+            else if (aClass == WORD_CHAR)
+            {
+                wordOffset = streamPos + ind;
+                wordStart = ind;
+                myState = CFDtokenizerState::WORD;
+            }
+            ind++;
+            break;
+        }
+        case CFDtokenizerState::WORD:
+        {
+            while ((ind < length) && (getCharClass(data[ind]) == WORD_CHAR)) ind++;
+            if (ind >= length) break;
+
+            if (data[ind] == '/')
+            {
+                slashInWord = true;
+                myState = CFDtokenizerState::SLASH;
+                ind++;
+                break;
+            }
+            endWord(data, ind);
+            myState = CFDtokenizerState::BETWEEN;
+            break;
+        }
+        case CFDtokenizerState::SLASH:
+        {
+            //Comments can be //
+            /* or have the multiline format */
+            //A comment also ends any word it is attached to
+            char aLetter = data[ind];
+            if ((aLetter == '/') || (aLetter == '*'))
+            {
+                if (slashInWord) endWord(data, (ind > 0) ? ind - 1 : 0);
+                myState = (aLetter == '/') ? CFDtokenizerState::LINE_COMMENT : CFDtokenizerState::BLOCK_COMMENT;
+                ind++;
+                break;
+            }
+
+            //Otherwise, the slash is part of a word
+            if (!slashInWord)
+            {
+                wordOffset = streamPos + ind - 1;
+                wordStart = ind - 1;
+            }
+            if (ind == 0)
+            {
+                carryWord.append('/');
+                wordStart = 0;
+            }
+            myState = CFDtokenizerState::WORD;
+            break;
+        }
+        case CFDtokenizerState::LINE_COMMENT:
+        {
+            const void * lineEnd = memchr(data + ind, '\n', static_cast<size_t>(length - ind));
+            if (lineEnd == nullptr)
+            {
+                ind = length;
+                break;
+            }
+            ind = static_cast<int>(static_cast<const char *>(lineEnd) - data);
+            myState = CFDtokenizerState::BETWEEN;
+            break;
+        }
+        case CFDtokenizerState::BLOCK_COMMENT:
+        {
+            const void * starPos = memchr(data + ind, '*', static_cast<size_t>(length - ind));
+            if (starPos == nullptr)
+            {
+                ind = length;
+                break;
+            }
+            ind = static_cast<int>(static_cast<const char *>(starPos) - data) + 1;
+            myState = CFDtokenizerState::BLOCK_STAR;
+            break;
+        }
+        case CFDtokenizerState::BLOCK_STAR:
+        {
+            char aLetter = data[ind];
+            if (aLetter == '/') myState = CFDtokenizerState::BETWEEN;
+            else if (aLetter != '*') myState = CFDtokenizerState::BLOCK_COMMENT;
+            ind++;
+            break;
+        }
+        }
+    }
+
+    //Keep the part of a word which may continue in the next piece
+    if (myState == CFDtokenizerState::WORD)
+    {
+        carryWord.append(data + wordStart, length - wordStart);
+    }
+    else if ((myState == CFDtokenizerState::SLASH) && slashInWord)
+    {
+        carryWord.append(data + wordStart, length - 1 - wordStart);
+    }
+
+    streamPos += length;
+}
+
+bool CFDtokenizer::finish()
+{
+    bool ret = true;
+    wordStart = 0;
+
+    if (myState == CFDtokenizerState::WORD)
+    {
+        endWord(nullptr, 0);
+    }
+    else if (myState == CFDtokenizerState::SLASH)
+    {
+        //A slash at the very end is an ordinary character
+        if (!slashInWord) wordOffset = streamPos - 1;
+        carryWord.append('/');
+        endWord(nullptr, 0);
+    }
+    else if ((myState == CFDtokenizerState::BLOCK_COMMENT) || (myState == CFDtokenizerState::BLOCK_STAR))
+    {
+        //Unclosed comment
+        ret = false;
+    }
+
+    myState = CFDtokenizerState::BETWEEN;
+    return ret;
+}
+
+void CFDtokenizer::reset()
+{
+    myState = CFDtokenizerState::BETWEEN;
+    streamPos = 0;
+    carryWord.clear();
+}
+
+qint64 CFDtokenizer::getBytesRead() const
+{
+    return streamPos;
+}
+
+void CFDtokenizer::endWord(const char * data, int wordEnd)
+{
+    int pieceLen = wordEnd - wordStart;
+    if (carryWord.isEmpty())
+    {
+        mySink->receiveToken(CFDlexType::WORD, wordOffset, data + wordStart, pieceLen);
+        return;
+    }
+
+    if (pieceLen > 0) carryWord.append(data + wordStart, pieceLen);
+    mySink->receiveToken(CFDlexType::WORD, wordOffset, carryWord.constData(), carryWord.size());
+    carryWord.clear();
+}
@@ -0,0 +1,100 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef CFDTOKENIZER_H
+#define CFDTOKENIZER_H
+
+#include <QByteArray>
+
+//Splits OpenFOAM text into words and brackets, skipping // and /* */ comments in the same pass.
+//Input may be given in pieces of any size, as it arrives from a download or decompression.
+//Tokens are passed to a sink as soon as they are complete.
+
+enum class CFDlexType
+{
+    WORD,
+    OPEN_PAREN,
+    CLOSE_PAREN,
+    OPEN_BRACE,
+    CLOSE_BRACE
+};
+
+class CFDtokenSink
+{
+public:
+    virtual ~CFDtokenSink() {}
+
+    //Offset is from the start of the whole input
+    //Note: text is only valid during the call
+    virtual void receiveToken(CFDlexType kind, qint64 offset, const char * text, int length) = 0;
+};
+
+enum class CFDtokenizerState
+{
+    BETWEEN,
+    WORD,
+    SLASH,
+    LINE_COMMENT,
+    BLOCK_COMMENT,
+    BLOCK_STAR
+};
+
+class CFDtokenizer
+{
+public:
+    explicit CFDtokenizer(CFDtokenSink * tokenSink);
+
+    void feed(const char * data, int length);
+    //Returns false if the input ends inside a /* comment
+    bool finish();
+    void reset();
+
+    qint64 getBytesRead() const;
+
+private:
+    void endWord(const char * data, int wordEnd);
+
+    CFDtokenSink * mySink;
+    CFDtokenizerState myState = CFDtokenizerState::BETWEEN;
+    qint64 streamPos = 0;
+
+    //Words split between pieces are collected here
+    QByteArray carryWord;
+    qint64 wordOffset = 0;
+    int wordStart = 0;
+    bool slashInWord = false;
+};
+
+#endif // CFDTOKENIZER_H
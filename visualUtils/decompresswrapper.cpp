@@ -34,79 +34,836 @@
 // Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
 
 #include "decompresswrapper.h"
+#include "cfdlocalfile.h"
+
+#include <QBuffer>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <QtEndian>
+
+#include <climits>
+#include <cstring>
+
+//Largest output which a QByteArray can hold, with room for its header
+static const qint64 MAX_OUTPUT_LEN = INT_MAX - 64;
+
+//A BGZF header is a gzip header with a 6 byte extra field, 'B' 'C', which holds the block size
+static const int BGZF_HEADER_LEN = 18;
+static const int BGZF_TRAILER_LEN = 8;
+static const qint64 BGZF_MAX_BLOCK_LEN = 65536;
+
+//The empty block which bgzip puts at the end of a file
+static const uchar BGZF_EOF_BLOCK[28] = {0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+                                         0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00,
+                                         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+struct DeCompressGroup
+{
+    size_t firstBlock = 0;
+    size_t endBlock = 0;
+    bool inflateOK = false;
+};
+
+struct DeCompressBgzfBlock
+{
+    const char * input = nullptr;
+    int inputLength = 0;
+    QByteArray output;
+    bool compressOK = false;
+};
+
+static bool compressBgzfBlock(DeCompressBgzfBlock &aBlock, int level)
+{
+    z_stream blockStream;
+    memset(&blockStream, 0, sizeof(blockStream));
+    //Note: negative window bits gives raw deflate, the gzip wrapper is written here
+    if (deflateInit2(&blockStream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return false;
+    }
+
+    qint64 boundLength = deflateBound(&blockStream, static_cast<uLong>(aBlock.inputLength));
+    aBlock.output.resize(static_cast<int>(BGZF_HEADER_LEN + boundLength + BGZF_TRAILER_LEN));
+    uchar * outData = reinterpret_cast<uchar *>(aBlock.output.data());
+
+    blockStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(aBlock.input));
+    blockStream.avail_in = static_cast<uInt>(aBlock.inputLength);
+    blockStream.next_out = outData + BGZF_HEADER_LEN;
+    blockStream.avail_out = static_cast<uInt>(boundLength);
+    int resultVal = deflate(&blockStream, Z_FINISH);
+    qint64 deflatedLength = static_cast<qint64>(blockStream.total_out);
+    deflateEnd(&blockStream);
+    if (resultVal != Z_STREAM_END) return false;
+
+    qint64 blockLength = BGZF_HEADER_LEN + deflatedLength + BGZF_TRAILER_LEN;
+    if (blockLength > BGZF_MAX_BLOCK_LEN) return false;
+
+    memcpy(outData, BGZF_EOF_BLOCK, BGZF_HEADER_LEN);
+    qToLittleEndian<quint16>(static_cast<quint16>(blockLength - 1), outData + 16);
+
+    uLong blockCRC = crc32(0, reinterpret_cast<const Bytef *>(aBlock.input), static_cast<uInt>(aBlock.inputLength));
+    uchar * trailer = outData + BGZF_HEADER_LEN + deflatedLength;
+    qToLittleEndian<quint32>(static_cast<quint32>(blockCRC), trailer);
+    qToLittleEndian<quint32>(static_cast<quint32>(aBlock.inputLength), trailer + 4);
+
+    aBlock.output.resize(static_cast<int>(blockLength));
+    return true;
+}
+
+//Compresses data as BGZF blocks as it is given, a group of blocks at a time, so the whole file is never held
+class DeCompressBgzfWriter : public DeCompressSink
+{
+public:
+    DeCompressBgzfWriter(QIODevice * outputDevice, int blockLength);
+
+    virtual bool receiveChunk(const char * data, int length);
+    //Writes the last part block, then the end of file block
+    bool finish();
+    //Includes the end of file block, as readBgzfIndex does
+    const std::vector<DeCompressBlock> &getBlockIndex() const;
+
+private:
+    bool writeBlocks(bool atEnd);
+    bool writeBlock(const QByteArray &blockData, qint64 outputLength);
+
+    QIODevice * myDevice;
+    int myBlockLength;
+    int groupLength;
+    QByteArray pendingInput;
+    std::vector<DeCompressBlock> myBlockIndex;
+    qint64 compressedPos = 0;
+    qint64 outputPos = 0;
+};
+
+DeCompressBgzfWriter::DeCompressBgzfWriter(QIODevice * outputDevice, int blockLength)
+{
+    myDevice = outputDevice;
+    myBlockLength = blockLength;
+    groupLength = qMax(1, DECOMPRESS_BLOCK_GROUP_LEN / blockLength) * blockLength;
+}
+
+bool DeCompressBgzfWriter::receiveChunk(const char * data, int length)
+{
+    pendingInput.append(data, length);
+    if (pendingInput.size() < groupLength) return true;
+    return writeBlocks(false);
+}
+
+bool DeCompressBgzfWriter::finish()
+{
+    if (!writeBlocks(true)) return false;
+    return writeBlock(QByteArray::fromRawData(reinterpret_cast<const char *>(BGZF_EOF_BLOCK), sizeof(BGZF_EOF_BLOCK)), 0);
+}
+
+const std::vector<DeCompressBlock> &DeCompressBgzfWriter::getBlockIndex() const
+{
+    return myBlockIndex;
+}
+
+bool DeCompressBgzfWriter::writeBlocks(bool atEnd)
+{
+    //Note: a part block is only written at the end, so every other block holds blockLength
+    int blockCount = pendingInput.size() / myBlockLength;
+    if (atEnd && (pendingInput.size() % myBlockLength != 0)) blockCount++;
+
+    std::vector<DeCompressBgzfBlock> blockList(static_cast<size_t>(blockCount));
+    for (size_t ind = 0; ind < blockList.size(); ind++)
+    {
+        int inputPos = static_cast<int>(ind) * myBlockLength;
+        blockList[ind].input = pendingInput.constData() + inputPos;
+        blockList[ind].inputLength = qMin(myBlockLength, pendingInput.size() - inputPos);
+    }
+
+    QtConcurrent::blockingMap(blockList, [](DeCompressBgzfBlock & aBlock)
+    {
+        //Note: data which does not compress is stored, which always fits in a block
+        aBlock.compressOK = compressBgzfBlock(aBlock, Z_DEFAULT_COMPRESSION) || compressBgzfBlock(aBlock, 0);
+    });
+
+    int inputUsed = 0;
+    for (const DeCompressBgzfBlock &aBlock : blockList)
+    {
+        if (!aBlock.compressOK || !writeBlock(aBlock.output, aBlock.inputLength)) return false;
+        inputUsed += aBlock.inputLength;
+    }
+    pendingInput.remove(0, inputUsed);
+    return true;
+}
+
+bool DeCompressBgzfWriter::writeBlock(const QByteArray &blockData, qint64 outputLength)
+{
+    if (myDevice->write(blockData) != blockData.size()) return false;
+
+    DeCompressBlock aBlock;
+    aBlock.compressedStart = compressedPos;
+    aBlock.compressedLength = blockData.size();
+    aBlock.outputStart = outputPos;
+    aBlock.outputLength = outputLength;
+    myBlockIndex.push_back(aBlock);
+
+    compressedPos += aBlock.compressedLength;
+    outputPos += outputLength;
+    return true;
+}
 
 DeCompressWrapper::DeCompressWrapper(QByteArray *ref)
 {
     myRefArray = ref;
+    memset(&myStream, 0, sizeof(myStream));
 }
 
-QByteArray * DeCompressWrapper::getDecompressedFile()
+DeCompressWrapper::DeCompressWrapper()
 {
-    QByteArray * myResultArray = nullptr;
+    memset(&myStream, 0, sizeof(myStream));
+}
+
+DeCompressWrapper::~DeCompressWrapper()
+{
+    endStream();
+}
 
+QByteArray * DeCompressWrapper::getDecompressedFile()
+{
     if (myRefArray == nullptr)
     {
         return nullptr;
     }
 
-    QTemporaryFile compressedFile;
-    if (!compressedFile.open())
+    if (checkBgzfIndex())
+    {
+        QByteArray * ret = inflateAllBlocks();
+        if (ret != nullptr) return ret;
+        //Note: an index given with setBlockIndex may not fit, so the file is read as one stream
+        myBlockIndex.clear();
+    }
+
+    resetStream();
+    sizeHint = getSizeHint(*myRefArray);
+    if (!appendCompressed(myRefArray->constData(), myRefArray->size()))
     {
         return nullptr;
     }
-    QByteArray qFileName = compressedFile.fileName().toLatin1();
-    const char * realFileName = qFileName.data();
-    compressedFile.write(*myRefArray);
-    compressedFile.close();
+    return finishStream();
+}
+
+bool DeCompressWrapper::inflateToSink(DeCompressSink * outputSink, int chunkLength)
+{
+    if ((myRefArray == nullptr) || (outputSink == nullptr) || (chunkLength <= 0))
+    {
+        return false;
+    }
 
-    gzFile compressHandle = gzopen(realFileName, "rb");
+    //Note: the sink is only used during this call, it is often a local of the caller
+    resetStream();
+    mySink = outputSink;
+    bool inflateOK = checkBgzfIndex() ? inflateBlocksToSink(chunkLength) : inflateStreamToSink(chunkLength);
+    mySink = nullptr;
+    return inflateOK;
+}
 
-    myResultArray = new QByteArray();
+bool DeCompressWrapper::appendCompressed(const char * data, int length)
+{
+    if (streamFailed) return false;
+    if (length <= 0) return true;
 
-    int resultVal = 1;
+    if (!streamStarted && !beginStream(data, length))
+    {
+        streamFailed = true;
+        return false;
+    }
 
-    while (resultVal > 0)
+    if (passThrough)
     {
-        char dataBuff[DECOMPRESS_READ_BUF_LEN];
-        resultVal = gzread(compressHandle, dataBuff ,DECOMPRESS_READ_BUF_LEN);
-        if (resultVal < 0)
+        if (mySink != nullptr)
         {
-            delete myResultArray;
-            myResultArray = nullptr;
-            return nullptr;
+            return mySink->receiveChunk(data, length);
         }
-        myResultArray->append(dataBuff, resultVal);
+        if (outputUsed + length > MAX_OUTPUT_LEN)
+        {
+            streamFailed = true;
+            return false;
+        }
+        myOutput.append(data, length);
+        outputUsed += length;
+        return true;
     }
-    gzclose(compressHandle);
 
-    return myResultArray;
+    if (!inflateInput(data, length))
+    {
+        streamFailed = true;
+        endStream();
+        return false;
+    }
+    return true;
+}
+
+QByteArray * DeCompressWrapper::finishStream()
+{
+    //Note: empty input gives an empty file, as it did with gzread
+    bool streamComplete = !streamFailed && (!streamStarted || passThrough || memberEnded);
+    endStream();
+    if (!streamComplete) return nullptr;
+
+    keepFoundMembers();
+    myOutput.resize(static_cast<int>(outputUsed));
+    QByteArray * ret = new QByteArray();
+    ret->swap(myOutput);
+    outputUsed = 0;
+    return ret;
 }
 
 QByteArray * DeCompressWrapper::getConditionalCompressedFileContents(QString fileName)
 {
-    QFile uncompressedFile(fileName);
-    if (uncompressedFile.exists())
+    //Note: callers which only parse the file should use CFDlocalFile, which does not copy it
+    if (!QFileInfo(fileName).exists())
+    {
+        fileName = fileName.append(".gz");
+    }
+
+    CFDlocalFile localFile(fileName);
+    if (!localFile.openFile())
+    {
+        return nullptr;
+    }
+    return localFile.decodeFile();
+}
+
+qint64 DeCompressWrapper::getSizeHint(const QByteArray &compressedData)
+{
+    //The smallest gzip member is a 10 byte header, an empty block and an 8 byte trailer
+    if (compressedData.size() < 20) return 0;
+    if ((static_cast<unsigned char>(compressedData.at(0)) != 0x1f) ||
+            (static_cast<unsigned char>(compressedData.at(1)) != 0x8b))
+    {
+        return 0;
+    }
+
+    const uchar * trailer = reinterpret_cast<const uchar *>(compressedData.constData() + compressedData.size() - 4);
+    return static_cast<qint64>(qFromLittleEndian<quint32>(trailer));
+}
+
+const std::vector<DeCompressBlock> &DeCompressWrapper::getBlockIndex() const
+{
+    return myBlockIndex;
+}
+
+bool DeCompressWrapper::setBlockIndex(const QByteArray &gziData)
+{
+    if ((myRefArray == nullptr) || (gziData.size() < 8)) return false;
+
+    //The .gzi format is a count, then the compressed and output offsets of each block after the first
+    const uchar * gziBytes = reinterpret_cast<const uchar *>(gziData.constData());
+    quint64 entryCount = qFromLittleEndian<quint64>(gziBytes);
+    if (static_cast<quint64>(gziData.size() - 8) / 16 != entryCount) return false;
+
+    const uchar * refBytes = reinterpret_cast<const uchar *>(myRefArray->constData());
+    qint64 refLength = myRefArray->size();
+
+    std::vector<DeCompressBlock> newIndex(static_cast<size_t>(entryCount) + 1);
+    for (size_t ind = 1; ind < newIndex.size(); ind++)
+    {
+        const uchar * anEntry = gziBytes + 8 + 16 * (ind - 1);
+        newIndex[ind].compressedStart = static_cast<qint64>(qFromLittleEndian<quint64>(anEntry));
+        newIndex[ind].outputStart = static_cast<qint64>(qFromLittleEndian<quint64>(anEntry + 8));
+    }
+
+    for (size_t ind = 0; ind < newIndex.size(); ind++)
+    {
+        DeCompressBlock &aBlock = newIndex[ind];
+        qint64 nextStart = refLength;
+        if (ind + 1 < newIndex.size()) nextStart = newIndex[ind + 1].compressedStart;
+
+        aBlock.compressedLength = nextStart - aBlock.compressedStart;
+        if ((aBlock.compressedStart < 0) || (nextStart > refLength) || (aBlock.compressedLength < 20)) return false;
+        if ((refBytes[aBlock.compressedStart] != 0x1f) || (refBytes[aBlock.compressedStart + 1] != 0x8b)) return false;
+
+        if (ind + 1 < newIndex.size())
+        {
+            aBlock.outputLength = newIndex[ind + 1].outputStart - aBlock.outputStart;
+            if (aBlock.outputLength < 0) return false;
+        }
+        else
+        {
+            //The size of the last block is only in its trailer
+            aBlock.outputLength = qFromLittleEndian<quint32>(refBytes + nextStart - 4);
+        }
+
+        //Each trailer holds its block's size mod 2^32, so an index of other data is not used
+        if (qFromLittleEndian<quint32>(refBytes + nextStart - 4) != static_cast<quint32>(aBlock.outputLength)) return false;
+    }
+    if (newIndex.size() < 2) return false;
+
+    myBlockIndex.swap(newIndex);
+    indexChecked = true;
+    return true;
+}
+
+QByteArray DeCompressWrapper::blockIndexToGzi(const std::vector<DeCompressBlock> &blockIndex)
+{
+    quint64 entryCount = blockIndex.empty() ? 0 : blockIndex.size() - 1;
+
+    QByteArray ret;
+    ret.resize(static_cast<int>(8 + 16 * entryCount));
+    uchar * gziBytes = reinterpret_cast<uchar *>(ret.data());
+    qToLittleEndian<quint64>(entryCount, gziBytes);
+    for (size_t ind = 1; ind < blockIndex.size(); ind++)
+    {
+        uchar * anEntry = gziBytes + 8 + 16 * (ind - 1);
+        qToLittleEndian<quint64>(static_cast<quint64>(blockIndex[ind].compressedStart), anEntry);
+        qToLittleEndian<quint64>(static_cast<quint64>(blockIndex[ind].outputStart), anEntry + 8);
+    }
+    return ret;
+}
+
+QByteArray DeCompressWrapper::readGziFile(QString dataFileName)
+{
+    QFile gziFile(dataFileName + DECOMPRESS_INDEX_SUFFIX);
+    if (!gziFile.open(QIODevice::ReadOnly)) return QByteArray();
+    return gziFile.readAll();
+}
+
+bool DeCompressWrapper::writeGziFile(QString dataFileName, const QByteArray &gziData)
+{
+    if (gziData.isEmpty()) return false;
+
+    QSaveFile gziFile(dataFileName + DECOMPRESS_INDEX_SUFFIX);
+    return gziFile.open(QIODevice::WriteOnly) &&
+            (gziFile.write(gziData) == gziData.size()) && gziFile.commit();
+}
+
+QByteArray * DeCompressWrapper::reblockFile(const QByteArray &compressedData, int blockLength)
+{
+    if ((blockLength <= 0) || (blockLength > DECOMPRESS_BGZF_INPUT_LEN)) return nullptr;
+
+    QByteArray * ret = new QByteArray();
+    QBuffer outputBuffer(ret);
+    outputBuffer.open(QIODevice::WriteOnly);
+
+    QByteArray inputCopy = compressedData;
+    DeCompressWrapper inflater(&inputCopy);
+    DeCompressBgzfWriter blockWriter(&outputBuffer, blockLength);
+    if (!inflater.inflateToSink(&blockWriter, DECOMPRESS_MIN_CHUNK_LEN) || !blockWriter.finish())
+    {
+        delete ret;
+        return nullptr;
+    }
+    return ret;
+}
+
+bool DeCompressWrapper::reblockFileOnDisk(QString fileName)
+{
+    QSaveFile outputFile(fileName);
+    std::vector<DeCompressBlock> newIndex;
+    bool reblockOK = false;
+
+    //Note: The old file is mapped, not read, and is let go before the new one replaces it
+    {
+        CFDlocalFile inputFile(fileName);
+        if (!inputFile.openFile()) return false;
+        QByteArray rawContent = inputFile.getRawData();
+
+        if ((rawContent.size() < 2) || (static_cast<unsigned char>(rawContent.at(0)) != 0x1f) ||
+                (static_cast<unsigned char>(rawContent.at(1)) != 0x8b))
+        {
+            return false;
+        }
+
+        if (readBgzfIndex(rawContent, &newIndex))
+        {
+            if (!QFileInfo(fileName + DECOMPRESS_INDEX_SUFFIX).exists())
+            {
+                writeGziFile(fileName, blockIndexToGzi(newIndex));
+            }
+            return true;
+        }
+
+        //The blocks are written as the file is inflated, a group at a time
+        if (!outputFile.open(QIODevice::WriteOnly)) return false;
+        DeCompressWrapper inflater(&rawContent);
+        DeCompressBgzfWriter blockWriter(&outputFile, DECOMPRESS_BGZF_INPUT_LEN);
+        reblockOK = inflater.inflateToSink(&blockWriter, DECOMPRESS_MIN_CHUNK_LEN) && blockWriter.finish();
+        newIndex = blockWriter.getBlockIndex();
+    }
+
+    //Note: the new file replaces the old one only once it is fully written
+    if (!reblockOK || !outputFile.commit()) return false;
+
+    //An index of the old file would not fit, and is replaced
+    writeGziFile(fileName, blockIndexToGzi(newIndex));
+    return true;
+}
+
+int DeCompressWrapper::reblockFolder(QString folderName)
+{
+    int reblockCount = 0;
+    QDirIterator folderIterator(folderName, {"*.gz"}, QDir::Files, QDirIterator::Subdirectories);
+    while (folderIterator.hasNext())
+    {
+        if (reblockFileOnDisk(folderIterator.next())) reblockCount++;
+    }
+    return reblockCount;
+}
+
+bool DeCompressWrapper::readBgzfIndex(const QByteArray &compressedData, std::vector<DeCompressBlock> * blockIndex)
+{
+    blockIndex->clear();
+
+    const uchar * refBytes = reinterpret_cast<const uchar *>(compressedData.constData());
+    qint64 refLength = compressedData.size();
+    qint64 outputPos = 0;
+
+    for (qint64 blockPos = 0; blockPos < refLength; )
+    {
+        const uchar * header = refBytes + blockPos;
+        qint64 lengthLeft = refLength - blockPos;
+        if (lengthLeft < BGZF_HEADER_LEN + BGZF_TRAILER_LEN) return false;
+        //Note: 4 is the flag for an extra field
+        if ((header[0] != 0x1f) || (header[1] != 0x8b) || (header[2] != 8) || ((header[3] & 4) == 0)) return false;
+
+        qint64 extraEnd = 12 + qFromLittleEndian<quint16>(header + 10);
+        if (extraEnd > lengthLeft) return false;
+
+        qint64 blockLength = 0;
+        for (qint64 fieldPos = 12; fieldPos + 4 <= extraEnd; )
+        {
+            qint64 fieldLength = qFromLittleEndian<quint16>(header + fieldPos + 2);
+            if ((header[fieldPos] == 'B') && (header[fieldPos + 1] == 'C') &&
+                    (fieldLength == 2) && (fieldPos + 6 <= extraEnd))
+            {
+                blockLength = qFromLittleEndian<quint16>(header + fieldPos + 4) + 1;
+            }
+            fieldPos += 4 + fieldLength;
+        }
+        if ((blockLength < extraEnd + BGZF_TRAILER_LEN) || (blockLength > lengthLeft)) return false;
+
+        DeCompressBlock aBlock;
+        aBlock.compressedStart = blockPos;
+        aBlock.compressedLength = blockLength;
+        aBlock.outputStart = outputPos;
+        aBlock.outputLength = qFromLittleEndian<quint32>(header + blockLength - 4);
+        blockIndex->push_back(aBlock);
+
+        outputPos += aBlock.outputLength;
+        blockPos += blockLength;
+    }
+
+    if (blockIndex->size() < 2)
+    {
+        blockIndex->clear();
+        return false;
+    }
+    return true;
+}
+
+bool DeCompressWrapper::inflateBlock(const char * input, const DeCompressBlock &aBlock, char * output)
+{
+    z_stream blockStream;
+    memset(&blockStream, 0, sizeof(blockStream));
+    if (inflateInit2(&blockStream, 15 + 16) != Z_OK)
+    {
+        return false;
+    }
+
+    //Note: zlib needs somewhere to write, even for an empty block
+    char emptyOutput = 0;
+    blockStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input + aBlock.compressedStart));
+    blockStream.avail_in = static_cast<uInt>(aBlock.compressedLength);
+    blockStream.next_out = reinterpret_cast<Bytef *>((aBlock.outputLength > 0) ? output : &emptyOutput);
+    blockStream.avail_out = static_cast<uInt>(aBlock.outputLength);
+
+    int resultVal = inflate(&blockStream, Z_FINISH);
+    bool inflateOK = (resultVal == Z_STREAM_END) && (blockStream.avail_in == 0) &&
+            (static_cast<qint64>(blockStream.total_out) == aBlock.outputLength);
+    inflateEnd(&blockStream);
+    return inflateOK;
+}
+
+bool DeCompressWrapper::inflateBlockList(size_t firstBlock, size_t endBlock, char * output) const
+{
+    const char * input = myRefArray->constData();
+    qint64 firstOutput = myBlockIndex[firstBlock].outputStart;
+
+    std::vector<DeCompressGroup> groupList;
+    for (size_t ind = firstBlock; ind < endBlock; )
     {
-        QByteArray * ret = nullptr;
-        uncompressedFile.open(QIODevice::ReadOnly);
-        *ret = uncompressedFile.readAll();
-        uncompressedFile.close();
-        return ret;
+        DeCompressGroup aGroup;
+        aGroup.firstBlock = ind;
+        qint64 groupLength = 0;
+        while ((ind < endBlock) && ((groupLength == 0) || (groupLength + myBlockIndex[ind].outputLength <= DECOMPRESS_BLOCK_GROUP_LEN)))
+        {
+            groupLength += myBlockIndex[ind].outputLength;
+            ind++;
+        }
+        aGroup.endBlock = ind;
+        groupList.push_back(aGroup);
     }
 
-    fileName = fileName.append(".gz");
+    QtConcurrent::blockingMap(groupList, [this, input, firstOutput, output](DeCompressGroup & aGroup)
+    {
+        aGroup.inflateOK = true;
+        for (size_t ind = aGroup.firstBlock; (ind < aGroup.endBlock) && aGroup.inflateOK; ind++)
+        {
+            const DeCompressBlock &aBlock = myBlockIndex[ind];
+            aGroup.inflateOK = inflateBlock(input, aBlock, output + (aBlock.outputStart - firstOutput));
+        }
+    });
 
-    QFile compressedFile(fileName);
-    if (!compressedFile.exists())
+    for (const DeCompressGroup &aGroup : groupList)
     {
+        if (!aGroup.inflateOK) return false;
+    }
+    return true;
+}
+
+bool DeCompressWrapper::checkBgzfIndex()
+{
+    if (!indexChecked)
+    {
+        indexChecked = true;
+        readBgzfIndex(*myRefArray, &myBlockIndex);
+    }
+    return !myBlockIndex.empty();
+}
+
+QByteArray * DeCompressWrapper::inflateAllBlocks()
+{
+    const DeCompressBlock &lastBlock = myBlockIndex.back();
+    qint64 totalLength = lastBlock.outputStart + lastBlock.outputLength;
+    if (totalLength > MAX_OUTPUT_LEN) return nullptr;
+
+    QByteArray * ret = new QByteArray();
+    ret->resize(static_cast<int>(totalLength));
+    if (!inflateBlockList(0, myBlockIndex.size(), ret->data()))
+    {
+        delete ret;
         return nullptr;
     }
+    return ret;
+}
+
+bool DeCompressWrapper::inflateBlocksToSink(int chunkLength)
+{
+    //Enough blocks are inflated at once to keep each thread busy, then passed on in order
+    qint64 waveLength = static_cast<qint64>(qMax(QThread::idealThreadCount(), 1)) * DECOMPRESS_BLOCK_GROUP_LEN;
+    QByteArray waveOutput;
+
+    for (size_t firstBlock = 0; firstBlock < myBlockIndex.size(); )
+    {
+        size_t endBlock = firstBlock;
+        qint64 outputLength = 0;
+        while ((endBlock < myBlockIndex.size()) &&
+               ((outputLength == 0) || (outputLength + myBlockIndex[endBlock].outputLength <= waveLength)))
+        {
+            outputLength += myBlockIndex[endBlock].outputLength;
+            endBlock++;
+        }
+        if (outputLength > MAX_OUTPUT_LEN) return false;
+
+        waveOutput.resize(static_cast<int>(outputLength));
+        if (!inflateBlockList(firstBlock, endBlock, waveOutput.data())) return false;
+
+        for (qint64 outputPos = 0; outputPos < outputLength; outputPos += chunkLength)
+        {
+            int thisLength = static_cast<int>(qMin(static_cast<qint64>(chunkLength), outputLength - outputPos));
+            if (!mySink->receiveChunk(waveOutput.constData() + outputPos, thisLength)) return false;
+        }
+        firstBlock = endBlock;
+    }
+    return true;
+}
+
+bool DeCompressWrapper::inflateStreamToSink(int chunkLength)
+{
+    myOutput.resize(chunkLength);
+
+    //Input which is not compressed is passed on in pieces as well
+    const char * inputData = myRefArray->constData();
+    int inputLength = myRefArray->size();
+    bool isCompressed = (inputLength > 0) && (static_cast<unsigned char>(inputData[0]) == 0x1f);
+    int pieceLength = isCompressed ? inputLength : chunkLength;
+
+    for (int inputPos = 0; inputPos < inputLength; inputPos += pieceLength)
+    {
+        int thisLength = qMin(pieceLength, inputLength - inputPos);
+        if (!appendCompressed(inputData + inputPos, thisLength))
+        {
+            endStream();
+            return false;
+        }
+    }
+
+    bool streamComplete = !streamFailed && (!streamStarted || passThrough || memberEnded);
+    endStream();
+    if (!streamComplete || !flushToSink()) return false;
+
+    keepFoundMembers();
+    return true;
+}
+
+void DeCompressWrapper::resetStream()
+{
+    endStream();
+    mySink = nullptr;
+    myOutput.clear();
+    streamStarted = false;
+    passThrough = false;
+    memberEnded = false;
+    ignoreRest = false;
+    streamFailed = false;
+    outputUsed = 0;
+    inputFed = 0;
+    outputFlushed = 0;
+    foundMembers.clear();
+}
+
+void DeCompressWrapper::recordMemberEnd()
+{
+    DeCompressBlock aMember;
+    if (!foundMembers.empty())
+    {
+        const DeCompressBlock &lastMember = foundMembers.back();
+        aMember.compressedStart = lastMember.compressedStart + lastMember.compressedLength;
+        aMember.outputStart = lastMember.outputStart + lastMember.outputLength;
+    }
+    aMember.compressedLength = inputFed - myStream.avail_in - aMember.compressedStart;
+    aMember.outputLength = outputFlushed + outputUsed - aMember.outputStart;
+    foundMembers.push_back(aMember);
+}
+
+void DeCompressWrapper::keepFoundMembers()
+{
+    //Members are only useful as an index for the whole of the given data
+    if ((myRefArray != nullptr) && !passThrough && (foundMembers.size() > 1))
+    {
+        myBlockIndex.swap(foundMembers);
+        indexChecked = true;
+    }
+    foundMembers.clear();
+}
+
+bool DeCompressWrapper::beginStream(const char * firstData, int length)
+{
+    streamStarted = true;
+
+    //As gzread does, data without the gzip magic number is not compressed
+    if (static_cast<unsigned char>(firstData[0]) != 0x1f)
+    {
+        passThrough = true;
+        if (mySink == nullptr) myOutput.reserve(length);
+        return true;
+    }
+
+    //Note: 16 added to the window bits reads gzip headers only
+    if (inflateInit2(&myStream, 15 + 16) != Z_OK)
+    {
+        return false;
+    }
+    streamOpen = true;
+
+    //Output to a sink reuses one chunk
+    if (mySink != nullptr) return true;
+
+    //Compression of OpenFOAM text is rarely below 2:1, so a trailer size below
+    //the input size is wrong (usually a file over 4 GB) and is not used
+    qint64 startSize = 4 * static_cast<qint64>(length);
+    if ((myRefArray != nullptr) && (sizeHint >= myRefArray->size()))
+    {
+        //Note: a little extra, so that the end of the stream is seen without growing
+        startSize = sizeHint + 64;
+    }
+    if (startSize < DECOMPRESS_MIN_CHUNK_LEN) startSize = DECOMPRESS_MIN_CHUNK_LEN;
+    if (startSize > MAX_OUTPUT_LEN) startSize = MAX_OUTPUT_LEN;
+
+    myOutput.resize(static_cast<int>(startSize));
+    return true;
+}
+
+bool DeCompressWrapper::inflateInput(const char * data, int length)
+{
+    if (ignoreRest || !streamOpen) return ignoreRest;
+
+    myStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    myStream.avail_in = static_cast<uInt>(length);
+    inputFed += length;
+
+    while (true)
+    {
+        if (memberEnded)
+        {
+            if (myStream.avail_in == 0) return true;
+
+            //Another member may follow, anything else after a member is ignored, as gzread does
+            if (*myStream.next_in != 0x1f)
+            {
+                ignoreRest = true;
+                return true;
+            }
+            if (inflateReset(&myStream) != Z_OK) return false;
+            memberEnded = false;
+        }
 
-    compressedFile.open(QIODevice::ReadOnly);
-    QByteArray rawContent = compressedFile.readAll();
-    compressedFile.close();
+        if (!reserveOutput()) return false;
 
-    DeCompressWrapper inflater(&rawContent);
+        int resultVal = inflate(&myStream, Z_NO_FLUSH);
+        outputUsed = reinterpret_cast<char *>(myStream.next_out) - myOutput.data();
 
-    return inflater.getDecompressedFile();
+        if (resultVal == Z_STREAM_END)
+        {
+            memberEnded = true;
+            recordMemberEnd();
+            continue;
+        }
+        //Note: Z_BUF_ERROR only means that more input is needed
+        if ((resultVal != Z_OK) && (resultVal != Z_BUF_ERROR))
+        {
+            return false;
+        }
+        if ((myStream.avail_in == 0) && (myStream.avail_out != 0))
+        {
+            return true;
+        }
+    }
+}
+
+bool DeCompressWrapper::reserveOutput()
+{
+    qint64 outputSize = myOutput.size();
+    if ((outputUsed >= outputSize) && (mySink != nullptr))
+    {
+        if (!flushToSink()) return false;
+    }
+    else if (outputUsed >= outputSize)
+    {
+        if (outputSize >= MAX_OUTPUT_LEN) return false;
+
+        qint64 growBy = outputSize / 2;
+        if (growBy < DECOMPRESS_MIN_CHUNK_LEN) growBy = DECOMPRESS_MIN_CHUNK_LEN;
+        outputSize += growBy;
+        if (outputSize > MAX_OUTPUT_LEN) outputSize = MAX_OUTPUT_LEN;
+
+        myOutput.resize(static_cast<int>(outputSize));
+    }
+
+    myStream.next_out = reinterpret_cast<Bytef *>(myOutput.data() + outputUsed);
+    myStream.avail_out = static_cast<uInt>(outputSize - outputUsed);
+    return true;
+}
+
+bool DeCompressWrapper::flushToSink()
+{
+    if (outputUsed == 0) return true;
+    bool keepGoing = mySink->receiveChunk(myOutput.constData(), static_cast<int>(outputUsed));
+    outputFlushed += outputUsed;
+    outputUsed = 0;
+    return keepGoing;
+}
+
+void DeCompressWrapper::endStream()
+{
+    if (!streamOpen) return;
+    inflateEnd(&myStream);
+    streamOpen = false;
 }
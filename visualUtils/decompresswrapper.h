@@ -44,21 +44,132 @@
     #include <zlib.h>
 #endif
 
-#define DECOMPRESS_READ_BUF_LEN 1024
+//Output is grown by at least this much when the size from the gzip trailer is not right
+#define DECOMPRESS_MIN_CHUNK_LEN (1024 * 1024)
+//Blocks are inflated in parallel in groups of about this much output
+#define DECOMPRESS_BLOCK_GROUP_LEN (4 * 1024 * 1024)
+//As bgzip does, re-blocked files hold this much input per block, so that the
+//compressed block always fits the 64 KB limit of BGZF
+#define DECOMPRESS_BGZF_INPUT_LEN 0xff00
+//A block index is kept next to its file, with this added to the name, as bgzip does
+#define DECOMPRESS_INDEX_SUFFIX ".gzi"
 
 #include <QByteArray>
-#include <QTemporaryFile>
+#include <QFile>
+#include <QString>
+
+#include <vector>
+
+//One gzip member of a file, which can be inflated on its own
+struct DeCompressBlock
+{
+    qint64 compressedStart = 0;
+    qint64 compressedLength = 0;
+    qint64 outputStart = 0;
+    qint64 outputLength = 0;
+};
+
+class DeCompressSink
+{
+public:
+    virtual ~DeCompressSink() {}
+
+    //Returns false to stop decompression, ex: when cancelled
+    //Note: data is only valid during the call
+    virtual bool receiveChunk(const char * data, int length) = 0;
+};
+
+//Inflates gzip data in memory. As with gzread, several gzip members one after another
+//are read as one file, and data which is not gzip is passed through as is.
+//Files made of many members (BGZF, as from bgzip or reblockFile) are inflated in parallel,
+//using the block sizes in the BGZF headers, or a block index from an earlier read.
+//The members of a plain multi-member file are only found by inflating it once, so their index
+//is kept in a .gzi file (see CFDlocalFile), and later reads start every block at once.
 
 class DeCompressWrapper
 {
 public:
     explicit DeCompressWrapper(QByteArray *ref);
+    //For streaming, compressed data is given to appendCompressed as it arrives
+    DeCompressWrapper();
+    ~DeCompressWrapper();
 
     QByteArray * getDecompressedFile();
+    //Gives the output to the sink in pieces of chunkLength, so the whole file is never held
+    bool inflateToSink(DeCompressSink * outputSink, int chunkLength);
+
+    bool appendCompressed(const char * data, int length);
+    //Returns nullptr if the data was not valid, or ended part way through
+    QByteArray * finishStream();
+
     static QByteArray * getConditionalCompressedFileContents(QString fileName);
+    //From the gzip trailer, this is the size mod 2^32 of the last member only, so is only a hint
+    static qint64 getSizeHint(const QByteArray &compressedData);
+
+    //The index is read from BGZF headers, or found while inflating a plain multi-member file.
+    //It is empty for a single gzip member, which cannot be split.
+    const std::vector<DeCompressBlock> &getBlockIndex() const;
+    //For an index kept from an earlier read, in the .gzi format of bgzip
+    //Returns false, and the index is not used, if it does not fit the data
+    bool setBlockIndex(const QByteArray &gziData);
+    static QByteArray blockIndexToGzi(const std::vector<DeCompressBlock> &blockIndex);
+
+    //The .gzi kept next to a file, or an empty array if there is none
+    static QByteArray readGziFile(QString dataFileName);
+    static bool writeGziFile(QString dataFileName, const QByteArray &gziData);
+
+    //Compresses the data again as BGZF, returns nullptr if it could not be read
+    //Note: Both re-block as they inflate, a group of blocks at a time, so the inflated file is never held
+    static QByteArray * reblockFile(const QByteArray &compressedData, int blockLength = DECOMPRESS_BGZF_INPUT_LEN);
+    //Re-blocks a .gz file in place, files which are already BGZF are left as they are.
+    //Either way, the block index is written next to the file. This is slow for large files,
+    //and is run from the "reblockGz" mode of main, not by the GUI.
+    static bool reblockFileOnDisk(QString fileName);
+    //Re-blocks every .gz file under a folder, returns the number re-blocked
+    static int reblockFolder(QString folderName);
 
 private:
+    Q_DISABLE_COPY(DeCompressWrapper)
+
+    bool beginStream(const char * firstData, int length);
+    bool inflateInput(const char * data, int length);
+    bool reserveOutput();
+    bool flushToSink();
+    void endStream();
+
+    static bool readBgzfIndex(const QByteArray &compressedData, std::vector<DeCompressBlock> * blockIndex);
+    static bool inflateBlock(const char * input, const DeCompressBlock &aBlock, char * output);
+    //Output for the blocks from firstBlock up to endBlock starts at output
+    bool inflateBlockList(size_t firstBlock, size_t endBlock, char * output) const;
+    bool checkBgzfIndex();
+    QByteArray * inflateAllBlocks();
+    bool inflateBlocksToSink(int chunkLength);
+    bool inflateStreamToSink(int chunkLength);
+    void resetStream();
+    void recordMemberEnd();
+    void keepFoundMembers();
+
     QByteArray * myRefArray = nullptr;
+    DeCompressSink * mySink = nullptr;
+
+    z_stream myStream;
+    bool streamOpen = false;
+    bool streamStarted = false;
+    bool passThrough = false;
+    bool memberEnded = false;
+    bool ignoreRest = false;
+    bool streamFailed = false;
+
+    qint64 sizeHint = 0;
+    QByteArray myOutput;
+    qint64 outputUsed = 0;
+
+    std::vector<DeCompressBlock> myBlockIndex;
+    bool indexChecked = false;
+    //For finding member bounds in the stream, as zlib counts from each member
+    qint64 inputFed = 0;
+    qint64 outputFlushed = 0;
+    std::vector<DeCompressBlock> foundMembers;
 };
 
 #endif // DECOMPRESSWRAPPER_H
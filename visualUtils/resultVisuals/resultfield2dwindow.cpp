@@ -36,6 +36,7 @@
 #include "resultfield2dwindow.h"
 
 #include "visualUtils/cfdglcanvas2D.h"
+#include "visualUtils/cfdfielddisplay.h"
 
 ResultField2dWindow::ResultField2dWindow(CWEcaseInstance * theCase, RESULT_ENTRY *resultDesc, QWidget *parent):
     ResultVisualPopup(theCase, resultDesc, parent) {}
@@ -60,24 +61,65 @@ void ResultField2dWindow::initializeView()
 void ResultField2dWindow::allFilesLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
 
-    CFDglCanvas * myCanvas;
-    changeDisplayFrameTenant(myCanvas = new CFDglCanvas2D());
+    QMap<QString, CFDparseTarget> parseTargets;
+    parseTargets["points"] = CFDparseTarget::POINTS;
+    parseTargets["faces"] = CFDparseTarget::FACES;
+    parseTargets["owner"] = CFDparseTarget::LABELS;
+    parseTargets["data"] = (getResultObj().values == "magnitude") ? CFDparseTarget::VECTOR_FIELD : CFDparseTarget::SCALAR_FIELD;
 
-    myCanvas->loadMeshData(fileBuffers["points"], fileBuffers["faces"], fileBuffers["owner"]);
+    parseFileBuffers(parseTargets);
+}
+
+void ResultField2dWindow::allFilesParsed()
+{
+    //Note: As in ResultPatch3dWindow, the canvas is a hidden child until its data is ready
+    CFDglCanvas2D * newCanvas = new CFDglCanvas2D(this);
+    newCanvas->hide();
+    newCanvas->setCancelCheck([this]() { return loadingCancelled(); });
+    loadingCanvas = newCanvas;
+
+    //Note: The job only writes to what it holds, since this window may be closed while it runs
+    meshOK = QSharedPointer<bool>::create(false);
+    QSharedPointer<bool> meshResult = meshOK;
+
+    QString valueType = getResultObj().values;
 
-    if (!myCanvas->getDisplayError().isEmpty())
+    runLoadJob([this, newCanvas, meshResult, valueType]()
     {
+        QMap<QString, CFDparsedList *> parsedLists = getParsedLists();
+
+        *meshResult = newCanvas->loadParsedMeshData(parsedLists["points"], parsedLists["faces"], parsedLists["owner"]);
+        if (!*meshResult || loadingCancelled()) return false;
+
+        return newCanvas->loadParsedFieldData(parsedLists["data"], valueType);
+    });
+}
+
+void ResultField2dWindow::loadJobFinished(bool jobOK)
+{
+    CFDglCanvas2D * myCanvas = loadingCanvas;
+    loadingCanvas = nullptr;
+
+    if (!*meshOK)
+    {
+        delete myCanvas;
         changeDisplayFrameTenant(new QLabel("Error: Data for 2D mesh is unreadable. Please reset and try again."));
         return;
     }
 
-    myCanvas->loadFieldData(fileBuffers["data"], getResultObj().values);
-
-    if (!myCanvas->displayAvailData())
+    if (!jobOK || !myCanvas->displayAvailData())
     {
+        delete myCanvas;
         changeDisplayFrameTenant(new QLabel("Error: Data for 2D field visual is unreadable. Please reset and try again."));
         return;
     }
+
+    changeDisplayFrameTenant(new CFDfieldDisplay(myCanvas));
+}
+
+void ResultField2dWindow::loadJobCancelled()
+{
+    delete loadingCanvas;
+    loadingCanvas = nullptr;
 }
@@ -36,8 +36,11 @@
 #ifndef RESULTFIELD2DWINDOW_H
 #define RESULTFIELD2DWINDOW_H
 
+#include <QSharedPointer>
+
 #include "visualUtils/resultvisualpopup.h"
 
+class CFDglCanvas2D;
 struct RESULT_ENTRY;
 
 class ResultField2dWindow : public ResultVisualPopup
@@ -50,6 +53,13 @@ public:
 
 private:
     virtual void allFilesLoaded();
+    virtual void allFilesParsed();
+    virtual void loadJobFinished(bool jobOK);
+    virtual void loadJobCancelled();
+
+    //Filled by the load job, then shown once it is done
+    CFDglCanvas2D * loadingCanvas = nullptr;
+    QSharedPointer<bool> meshOK;
 };
 
 #endif // RESULTFIELD2DWINDOW_H
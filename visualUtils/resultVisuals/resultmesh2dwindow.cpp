@@ -55,16 +55,47 @@ void ResultMesh2dWindow::initializeView()
 void ResultMesh2dWindow::allFilesLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
 
-    CFDglCanvas * myCanvas;
-    changeDisplayFrameTenant(myCanvas = new CFDglCanvas2D());
+    QMap<QString, CFDparseTarget> parseTargets;
+    parseTargets["points"] = CFDparseTarget::POINTS;
+    parseTargets["faces"] = CFDparseTarget::FACES;
+    parseTargets["owner"] = CFDparseTarget::LABELS;
 
-    myCanvas->loadMeshData(fileBuffers["points"], fileBuffers["faces"], fileBuffers["owner"]);
+    parseFileBuffers(parseTargets);
+}
+
+void ResultMesh2dWindow::allFilesParsed()
+{
+    //Note: As in ResultPatch3dWindow, the canvas is a hidden child until its data is ready
+    CFDglCanvas2D * newCanvas = new CFDglCanvas2D(this);
+    newCanvas->hide();
+    newCanvas->setCancelCheck([this]() { return loadingCancelled(); });
+    loadingCanvas = newCanvas;
+
+    runLoadJob([this, newCanvas]()
+    {
+        QMap<QString, CFDparsedList *> parsedLists = getParsedLists();
+        return newCanvas->loadParsedMeshData(parsedLists["points"], parsedLists["faces"], parsedLists["owner"]);
+    });
+}
 
-    if (!myCanvas->displayAvailData())
+void ResultMesh2dWindow::loadJobFinished(bool jobOK)
+{
+    CFDglCanvas2D * myCanvas = loadingCanvas;
+    loadingCanvas = nullptr;
+
+    if (!jobOK || !myCanvas->displayAvailData())
     {
+        delete myCanvas;
         changeDisplayFrameTenant(new QLabel("Error: Data for 2D mesh result is unreadable. Please reset and try again."));
         return;
     }
+
+    changeDisplayFrameTenant(myCanvas);
+}
+
+void ResultMesh2dWindow::loadJobCancelled()
+{
+    delete loadingCanvas;
+    loadingCanvas = nullptr;
 }
@@ -41,6 +41,7 @@
 #include "visualUtils/resultvisualpopup.h"
 
 class CFDglCanvas;
+class CFDglCanvas2D;
 struct RESULT_ENTRY;
 
 class ResultMesh2dWindow : public ResultVisualPopup
@@ -54,6 +55,12 @@ public:
 
 private:
     virtual void allFilesLoaded();
+    virtual void allFilesParsed();
+    virtual void loadJobFinished(bool jobOK);
+    virtual void loadJobCancelled();
+
+    //Filled by the load job, then shown once it is done
+    CFDglCanvas2D * loadingCanvas = nullptr;
 };
 
 #endif // RESULTMESH2DWINDOW_H
@@ -55,17 +55,48 @@ void ResultMesh3dWindow::initializeView()
 void ResultMesh3dWindow::allFilesLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
 
+    QMap<QString, CFDparseTarget> parseTargets;
+    parseTargets["points"] = CFDparseTarget::POINTS;
+    parseTargets["faces"] = CFDparseTarget::FACES;
+    parseTargets["owner"] = CFDparseTarget::LABELS;
+
+    parseFileBuffers(parseTargets);
+}
+
+void ResultMesh3dWindow::allFilesParsed()
+{
     //TODO: Redo for 3D
-    CFDglCanvas * myCanvas;
-    changeDisplayFrameTenant(myCanvas = new CFDglCanvas3D());
+    //Note: As in ResultPatch3dWindow, the canvas is a hidden child until its data is ready
+    CFDglCanvas3D * newCanvas = new CFDglCanvas3D(this);
+    newCanvas->hide();
+    newCanvas->setCancelCheck([this]() { return loadingCancelled(); });
+    loadingCanvas = newCanvas;
+
+    runLoadJob([this, newCanvas]()
+    {
+        QMap<QString, CFDparsedList *> parsedLists = getParsedLists();
+        return newCanvas->loadParsedMeshData(parsedLists["points"], parsedLists["faces"], parsedLists["owner"]);
+    });
+}
 
-    myCanvas->loadMeshData(fileBuffers["points"], fileBuffers["faces"], fileBuffers["owner"]);
+void ResultMesh3dWindow::loadJobFinished(bool jobOK)
+{
+    CFDglCanvas3D * myCanvas = loadingCanvas;
+    loadingCanvas = nullptr;
 
-    if (!myCanvas->displayAvailData())
+    if (!jobOK || !myCanvas->displayAvailData())
     {
+        delete myCanvas;
         changeDisplayFrameTenant(new QLabel("Error: Data for 3D mesh result is unreadable. Please reset and try again."));
         return;
     }
+
+    changeDisplayFrameTenant(myCanvas);
+}
+
+void ResultMesh3dWindow::loadJobCancelled()
+{
+    delete loadingCanvas;
+    loadingCanvas = nullptr;
 }
@@ -41,6 +41,7 @@
 #include "visualUtils/resultvisualpopup.h"
 
 class CFDglCanvas;
+class CFDglCanvas3D;
 struct RESULT_ENTRY;
 
 class ResultMesh3dWindow : public ResultVisualPopup
@@ -54,6 +55,12 @@ public:
 
 private:
     virtual void allFilesLoaded();
+    virtual void allFilesParsed();
+    virtual void loadJobFinished(bool jobOK);
+    virtual void loadJobCancelled();
+
+    //Filled by the load job, then shown once it is done
+    CFDglCanvas3D * loadingCanvas = nullptr;
 };
 
 #endif // RESULTMESH3DWINDOW_H
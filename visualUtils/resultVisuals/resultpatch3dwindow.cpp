@@ -0,0 +1,122 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "resultpatch3dwindow.h"
+
+#include "visualUtils/cfdglcanvas3D.h"
+#include "visualUtils/cfdfielddisplay.h"
+
+ResultPatch3dWindow::ResultPatch3dWindow(CWEcaseInstance * theCase, RESULT_ENTRY *resultDesc, QWidget *parent):
+    ResultVisualPopup(theCase, resultDesc, parent) {}
+
+ResultPatch3dWindow::~ResultPatch3dWindow(){}
+
+void ResultPatch3dWindow::initializeView()
+{
+    //Note: owner is not needed, since only the faces of one patch are drawn
+    QMap<QString, QString> neededFiles;
+    neededFiles["points"] = "/constant/polyMesh/points.gz";
+    neededFiles["faces"] = "/constant/polyMesh/faces.gz";
+    neededFiles["boundary"] = "/constant/polyMesh/boundary.gz";
+
+    QString fieldName = getResultObj().file;
+    QString fieldFile = "[final]/";
+    fieldFile.append(fieldName).append(".gz");
+    neededFiles["data"] = fieldFile;
+
+    performStandardInit(neededFiles);
+}
+
+void ResultPatch3dWindow::allFilesLoaded()
+{
+    QObject::disconnect(this);
+
+    //Note: The canvas is a hidden child of this window until it is ready, so it outlives the
+    //load job even if the window is closed first. Being hidden, its data may be read on a worker.
+    CFDglCanvas3D * newCanvas = new CFDglCanvas3D(this);
+    newCanvas->hide();
+    newCanvas->setCancelCheck([this]() { return loadingCancelled(); });
+    loadingCanvas = newCanvas;
+
+    //Note: The job only writes to what it holds, since this window may be closed while it runs
+    patchMeshOK = QSharedPointer<bool>::create(false);
+    QSharedPointer<bool> meshResult = patchMeshOK;
+
+    QString patchName = getResultObj().patch;
+    QString valueType = getResultObj().values;
+
+    runLoadJob([this, newCanvas, meshResult, patchName, valueType]()
+    {
+        QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
+
+        *meshResult = newCanvas->loadPatchMeshData(fileBuffers["points"], fileBuffers["faces"], fileBuffers["boundary"], patchName);
+        releaseFileBuffer("points");
+        releaseFileBuffer("faces");
+        releaseFileBuffer("boundary");
+        if (!*meshResult || loadingCancelled()) return false;
+
+        bool fieldOK = newCanvas->loadPatchFieldData(fileBuffers["data"], valueType);
+        releaseFileBuffer("data");
+        return fieldOK;
+    });
+}
+
+void ResultPatch3dWindow::loadJobFinished(bool jobOK)
+{
+    CFDglCanvas3D * myCanvas = loadingCanvas;
+    loadingCanvas = nullptr;
+
+    if (!*patchMeshOK)
+    {
+        delete myCanvas;
+        changeDisplayFrameTenant(new QLabel("Error: Data for surface patch is unreadable. Please reset and try again."));
+        return;
+    }
+
+    if (!jobOK || !myCanvas->displayAvailData())
+    {
+        delete myCanvas;
+        changeDisplayFrameTenant(new QLabel("Error: Data for surface field visual is unreadable. Please reset and try again."));
+        return;
+    }
+
+    changeDisplayFrameTenant(new CFDfieldDisplay(myCanvas));
+}
+
+void ResultPatch3dWindow::loadJobCancelled()
+{
+    delete loadingCanvas;
+    loadingCanvas = nullptr;
+}
@@ -53,11 +53,35 @@ void ResultTextDisplay::initializeView()
 void ResultTextDisplay::allFilesLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
 
-    QPlainTextEdit * myDisplay;
+    //Note: The job only writes to what it holds, since this window may be closed while it runs
+    loadedText = QSharedPointer<QString>::create();
+    QSharedPointer<QString> textResult = loadedText;
+
+    runLoadJob([this, textResult]()
+    {
+        QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
+        *textResult = QString::fromLatin1(*(fileBuffers["text"]));
+        releaseFileBuffer("text");
+        return true;
+    });
+}
+
+void ResultTextDisplay::loadJobFinished(bool jobOK)
+{
+    if (!jobOK)
+    {
+        initialFailure();
+        return;
+    }
 
-    QString theText = QString::fromLatin1(*(fileBuffers["text"]));
-    changeDisplayFrameTenant(myDisplay = new QPlainTextEdit(theText));
+    QPlainTextEdit * myDisplay;
+    changeDisplayFrameTenant(myDisplay = new QPlainTextEdit(*loadedText));
     myDisplay->setReadOnly(true);
+    loadedText.reset();
+}
+
+void ResultTextDisplay::loadJobCancelled()
+{
+    loadedText.reset();
 }
@@ -37,6 +37,7 @@
 #define RESULTTEXTDISP_H
 
 #include <QPlainTextEdit>
+#include <QSharedPointer>
 
 #include "visualUtils/resultvisualpopup.h"
 
@@ -50,6 +51,10 @@ public:
 
 private:
     virtual void allFilesLoaded();
+    virtual void loadJobFinished(bool jobOK);
+    virtual void loadJobCancelled();
+
+    QSharedPointer<QString> loadedText;
 };
 
 #endif // RESULTTEXTDISP_H
@@ -35,21 +35,71 @@
 
 #include "resultprocurebase.h"
 #include "cwe_globals.h"
-#include "decompresswrapper.h"
+#include "cfdcodec.h"
+#include "cfdresultcache.h"
+#include "cfdmeshsidecar.h"
+#include "cfdmemoryuse.h"
 
 #include "remoteFiles/filetreenode.h"
 #include "remoteFiles/fileoperator.h"
 
 #include "filemetadata.h"
 
-ResultProcureBase::ResultProcureBase(QWidget *parent) : QWidget(parent) {}
+#include <QtConcurrentRun>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+//How often the progress of reading the files is shown, in ms
+static const int LOAD_PROGRESS_INTERVAL = 200;
+
+//Runs on a worker thread. A file which was parsed before is read from its sidecar instead.
+static bool parseWithSidecar(CFDparsePipeline * aPipeline, CFDparseTarget aTarget, QString sidecarName)
+{
+    CFDparsedList * parsedList = aPipeline->getResult();
+    if (!sidecarName.isEmpty() && CFDresultCache::useSidecar(sidecarName) &&
+            CFDmeshSidecar::readSidecar(sidecarName, aTarget, parsedList))
+    {
+        return true;
+    }
+
+    if (!aPipeline->run()) return false;
+    //Note: A load cancelled once the list is read does not wait for the sidecar to be written
+    if (aPipeline->isCancelled()) return false;
+
+    if (!sidecarName.isEmpty() && CFDmeshSidecar::writeSidecar(sidecarName, aTarget, *parsedList))
+    {
+        CFDresultCache::trimCache();
+    }
+    return true;
+}
+
+ResultProcureBase::ResultProcureBase(QWidget *parent) : QWidget(parent)
+{
+    progressTimer.setInterval(LOAD_PROGRESS_INTERVAL);
+    QObject::connect(&progressTimer, SIGNAL(timeout()), this, SLOT(updateLoadProgress()));
+}
 
 ResultProcureBase::~ResultProcureBase()
 {
+    //Closing the window stops any load still running
+    stopLoading();
+
     for (auto itr = myBufferList.cbegin(); itr != myBufferList.cend(); itr++)
     {
         delete (*itr);
     }
+    for (CFDparsePipeline * aPipeline : myPipelines)
+    {
+        delete aPipeline;
+    }
+
+    //Note: buffers and pipelines may be views of these files, so they are deleted first
+    myRawFiles.clear();
+    for (CFDlocalFile * aFile : myLocalFiles)
+    {
+        delete aFile;
+    }
 }
 
 void ResultProcureBase::initializeWithNeededFiles(FileNodeRef baseFolder, QMap<QString, QString> neededFiles)
@@ -79,6 +129,58 @@ void ResultProcureBase::initializeWithNeededFiles(FileNodeRef baseFolder, QMap<Q
     fileChanged(nil);
 }
 
+void ResultProcureBase::initializeWithLocalFolder(QString localFolder, QMap<QString, QString> neededFiles)
+{
+    if (!myFileNames.empty() || initLoadDone)
+    {
+        cwe_globals::displayPopup("Internal Error: Attempt made to double-initialize result display.");
+        return;
+    }
+
+    if (!QFileInfo(localFolder).isDir() || neededFiles.isEmpty())
+    {
+        initialFailure();
+        return;
+    }
+
+    myFileNames = neededFiles;
+    localSource = true;
+
+    //The same rules as for remote files: [final] is the latest time folder, and any codec will do
+    for (QString fileID : myFileNames.keys())
+    {
+        QString fileName = myFileNames.value(fileID);
+        QString folderName = localFolder;
+
+        if (fileName.startsWith("[final]"))
+        {
+            fileName.remove(0,7);
+            folderName = getFinalLocalFolder(localFolder);
+        }
+
+        QString foundName;
+        if (!folderName.isEmpty())
+        {
+            foundName = CFDlocalFile::findVariant(folderName + "/" + fileName);
+        }
+
+        CFDlocalFile * localFile = new CFDlocalFile(foundName);
+        myLocalFiles[fileID] = localFile;
+        if (foundName.isEmpty() || !localFile->openFile())
+        {
+            initialFailure();
+            return;
+        }
+
+        myRawFiles[fileID] = localFile->getRawData();
+        mySourcePaths[fileID] = foundName;
+    }
+
+    noteMemoryUse(getRawFileBytes());
+    initLoadDone = true;
+    allFilesLoaded();
+}
+
 QMap<QString, FileNodeRef> ResultProcureBase::getFileNodes()
 {
     return myFileNodes;
@@ -93,47 +195,372 @@ QMap<QString, QByteArray *> ResultProcureBase::getFileBuffers()
         return empty;
     }
 
-    if (myBufferList.isEmpty())
+    if (myBufferList.isEmpty() && !computeFileBuffers())
     {
-        computeFileBuffers();
+        cwe_globals::displayFatalPopup("Internal Error: result buffer not loaded after load");
     }
     return myBufferList;
 }
 
-void ResultProcureBase::computeFileBuffers()
+bool ResultProcureBase::computeFileBuffers()
 {
-    myBufferList.clear();
+    QMap<QString, QString> fileNames;
+    QMap<QString, QByteArray> rawFiles;
+    if (!collectRawFiles(&fileNames, &rawFiles)) return false;
+    return decodeFileBuffers(fileNames, rawFiles);
+}
 
-    for (QString fileID : myFileNodes.keys())
+bool ResultProcureBase::collectRawFiles(QMap<QString, QString> * fileNames, QMap<QString, QByteArray> * rawFiles)
+{
+    for (QString fileID : myFileNames.keys())
+    {
+        if (!myRawFiles.contains(fileID)) return false;
+
+        (*fileNames)[fileID] = mySourcePaths.value(fileID);
+        (*rawFiles)[fileID] = getRawFile(fileID);
+    }
+    return true;
+}
+
+bool ResultProcureBase::decodeFileBuffers(QMap<QString, QString> fileNames, QMap<QString, QByteArray> rawFiles)
+{
+    //Note: May be run on a worker thread, so file nodes are not used here
+    QMap<QString, QByteArray *> newBuffers;
+    qint64 newBytes = 0;
+    bool decodeOK = true;
+
+    for (QString fileID : rawFiles.keys())
     {
-        FileNodeRef theFile = myFileNodes.value(fileID);
-        if (!theFile.fileNodeExtant())
+        if (loadCancelled.loadAcquire())
         {
-            cwe_globals::displayFatalPopup("Internal Error: result file not loaded after load");
+            decodeOK = false;
+            break;
         }
+        //Note: local files are not changed until the load is done, so may be used here
         QByteArray * rawBuffer = nullptr;
-
-        if (theFile.getFileName().endsWith(".gz"))
+        if (myLocalFiles.contains(fileID))
         {
-            QByteArray compressedBuffer = theFile.getFileBuffer();
-            DeCompressWrapper realPoints(&compressedBuffer);
-            rawBuffer = realPoints.getDecompressedFile();
+            rawBuffer = myLocalFiles.value(fileID)->decodeFile();
         }
         else
         {
-            rawBuffer = new QByteArray(theFile.getFileBuffer());
+            rawBuffer = CFDcodecList::decodeFile(fileNames.value(fileID), rawFiles.value(fileID));
         }
 
         if (rawBuffer == nullptr)
         {
-            cwe_globals::displayFatalPopup("Internal Error: result buffer not loaded after load");
+            decodeOK = false;
+            break;
+        }
+        newBuffers[fileID] = rawBuffer;
+        newBytes += rawBuffer->size();
+        buffersDecoded.fetchAndAddRelease(1);
+    }
+
+    if (!decodeOK)
+    {
+        qDeleteAll(newBuffers);
+        return false;
+    }
+    myBufferList = newBuffers;
+    decodedBytes = newBytes;
+    return true;
+}
+
+void ResultProcureBase::runLoadJob(std::function<bool()> loadJob)
+{
+    if (!initLoadDone || (loadJobWatcher != nullptr))
+    {
+        qCDebug(agaveAppLayer, "ERROR: Load job requested before files retrieved, or made twice.");
+        return;
+    }
+
+    //The files are found here, since file nodes are only used on this thread
+    //Note: A job started from allFilesParsed reads the parsed lists, so nothing is decoded
+    bool needsDecode = myBufferList.isEmpty() && myPipelines.isEmpty();
+    QMap<QString, QString> fileNames;
+    QMap<QString, QByteArray> rawFiles;
+    if (needsDecode && !collectRawFiles(&fileNames, &rawFiles))
+    {
+        cwe_globals::displayFatalPopup("Internal Error: result file not loaded after load");
+    }
+
+    buffersDecoded.storeRelease(needsDecode ? 0 : myBufferList.size());
+    loadJobRunning = true;
+    loadJobWatcher = new QFutureWatcher<bool>(this);
+    QObject::connect(loadJobWatcher, SIGNAL(finished()), this, SLOT(loadJobDone()));
+    loadJobWatcher->setFuture(QtConcurrent::run([this, loadJob, needsDecode, fileNames, rawFiles]()
+    {
+        if (needsDecode && !decodeFileBuffers(fileNames, rawFiles)) return false;
+        if (loadCancelled.loadAcquire()) return false;
+        return loadJob();
+    }));
+
+    updateLoadProgress();
+    progressTimer.start();
+}
+
+void ResultProcureBase::loadJobFinished(bool)
+{
+    //Note: Only needed by result displays which use runLoadJob
+}
+
+void ResultProcureBase::loadJobCancelled()
+{
+    //Note: Only needed by result displays whose load job fills something which must then be deleted
+}
+
+void ResultProcureBase::releaseFileBuffer(QString fileID)
+{
+    delete myBufferList.take(fileID);
+}
+
+void ResultProcureBase::loadProgressChanged(QString, int)
+{
+    //Note: This is deliberately blank. Displays may show the progress if they choose.
+}
+
+void ResultProcureBase::cancelLoading()
+{
+    if (loadingCancelled()) return;
+    loadCancelled.storeRelease(1);
+    progressTimer.stop();
+
+    for (CFDparsePipeline * aPipeline : myPipelines)
+    {
+        aPipeline->cancel();
+    }
+
+    //Otherwise, the files are freed once the jobs still reading them stop
+    if ((parseJobsLeft == 0) && !loadJobRunning)
+    {
+        releaseFileData();
+    }
+}
+
+void ResultProcureBase::stopLoading()
+{
+    cancelLoading();
+
+    //Note: The jobs are waited for here, so their finished slots are not run
+    for (QFutureWatcher<bool> * aWatcher : parseWatchers)
+    {
+        aWatcher->disconnect(this);
+        aWatcher->waitForFinished();
+    }
+    if (loadJobWatcher != nullptr)
+    {
+        loadJobWatcher->disconnect(this);
+        loadJobWatcher->waitForFinished();
+    }
+    parseJobsLeft = 0;
+    loadJobRunning = false;
+}
+
+bool ResultProcureBase::loadingCancelled()
+{
+    return loadCancelled.loadAcquire();
+}
+
+void ResultProcureBase::parseFileBuffers(QMap<QString, CFDparseTarget> parseTargets)
+{
+    if (!initLoadDone || !parseWatchers.isEmpty())
+    {
+        qCDebug(agaveAppLayer, "ERROR: File parse request before files retrieved, or made twice.");
+        return;
+    }
+
+    for (QString fileID : parseTargets.keys())
+    {
+        if (!myRawFiles.contains(fileID))
+        {
+            cwe_globals::displayFatalPopup("Internal Error: result file not loaded after load");
+        }
+        myPipelines[fileID] = new CFDparsePipeline(getRawFile(fileID), parseTargets.value(fileID));
+        if (myLocalFiles.contains(fileID))
+        {
+            myPipelines[fileID]->setBlockIndex(myLocalFiles.value(fileID)->getBlockIndex());
+        }
+    }
+
+    parseJobsLeft = myPipelines.size();
+    for (QString fileID : myPipelines.keys())
+    {
+        CFDparsePipeline * aPipeline = myPipelines.value(fileID);
+        CFDparseTarget aTarget = parseTargets.value(fileID);
+        QString sidecarName = getSidecarName(fileID, aTarget);
+
+        QFutureWatcher<bool> * aWatcher = new QFutureWatcher<bool>(this);
+        QObject::connect(aWatcher, SIGNAL(finished()), this, SLOT(parseJobFinished()));
+        aWatcher->setFuture(QtConcurrent::run(&parseWithSidecar, aPipeline, aTarget, sidecarName));
+        parseWatchers.append(aWatcher);
+    }
+
+    updateLoadProgress();
+    progressTimer.start();
+}
+
+QMap<QString, CFDparsedList *> ResultProcureBase::getParsedLists()
+{
+    QMap<QString, CFDparsedList *> ret;
+    for (QString fileID : myPipelines.keys())
+    {
+        ret[fileID] = myPipelines.value(fileID)->getResult();
+    }
+    return ret;
+}
+
+void ResultProcureBase::allFilesParsed()
+{
+    //Note: Only needed by result displays which use parseFileBuffers
+}
+
+void ResultProcureBase::parseJobFinished()
+{
+    parseJobsLeft--;
+    if (parseJobsLeft == 0)
+    {
+        progressTimer.stop();
+
+        if (loadingCancelled())
+        {
+            releaseFileData();
+            return;
+        }
+
+        qint64 parsedBytes = 0;
+        for (CFDparsePipeline * aPipeline : myPipelines)
+        {
+            CFDparsedList * parsedList = aPipeline->getResult();
+            parsedBytes += CFDmemoryUse::getVectorBytes(parsedList->doubleVals) + CFDmemoryUse::getVectorBytes(parsedList->labelVals) +
+                    CFDmemoryUse::getVectorBytes(parsedList->faceOffsets);
+        }
+        noteMemoryUse(getRawFileBytes() + parsedBytes);
+
+        //Block indexes found for files on disk are kept, so the next read is parallel
+        for (QString fileID : myLocalFiles.keys())
+        {
+            if (!myPipelines.contains(fileID)) continue;
+            myLocalFiles.value(fileID)->keepBlockIndex(myPipelines.value(fileID)->getBlockIndex());
+        }
+
+        allFilesParsed();
+        //The parsed lists are kept for a load job started by allFilesParsed, until it is done
+        if (loadJobWatcher == nullptr)
+        {
+            releaseFileData();
         }
-        myBufferList[fileID] = rawBuffer;
     }
 }
 
+void ResultProcureBase::loadJobDone()
+{
+    loadJobRunning = false;
+    progressTimer.stop();
+
+    if (loadingCancelled())
+    {
+        loadJobCancelled();
+        releaseFileData();
+        return;
+    }
+
+    noteMemoryUse(getRawFileBytes() + decodedBytes);
+
+    loadJobFinished(loadJobWatcher->result());
+    releaseFileData();
+}
+
+void ResultProcureBase::releaseFileData()
+{
+    //Once read, the files are not kept. A result opened again is read from the disk cache.
+    for (CFDparsePipeline * aPipeline : myPipelines)
+    {
+        delete aPipeline;
+    }
+    myPipelines.clear();
+    qDeleteAll(myBufferList);
+    myBufferList.clear();
+    myRawFiles.clear();
+
+    for (FileNodeRef aNode : myFileNodes)
+    {
+        if (aNode.fileNodeExtant() && aNode.fileBufferLoaded())
+        {
+            aNode.setFileBuffer(nullptr);
+        }
+    }
+
+    //Note: buffers and pipelines may be views of these files, so they are deleted first
+    qDeleteAll(myLocalFiles);
+    myLocalFiles.clear();
+
+    qCDebug(agaveAppLayer, "Result files read: peak of %.1f MB of file data for this window, process peak %.1f MB",
+            static_cast<double>(peakBytesHeld) / (1024.0 * 1024.0), CFDmemoryUse::getPeakRssMB());
+}
+
+void ResultProcureBase::noteMemoryUse(qint64 bytesHeld)
+{
+    if (bytesHeld > peakBytesHeld) peakBytesHeld = bytesHeld;
+}
+
+qint64 ResultProcureBase::getRawFileBytes()
+{
+    qint64 ret = 0;
+    for (const QByteArray &aFile : myRawFiles)
+    {
+        ret += aFile.size();
+    }
+    return ret;
+}
+
+void ResultProcureBase::updateLoadProgress()
+{
+    if (parseJobsLeft > 0)
+    {
+        //Files of unknown size count only once done
+        double fractionDone = 0.0;
+        int jobIndex = 0;
+        for (CFDparsePipeline * aPipeline : myPipelines)
+        {
+            qint64 expectedBytes = aPipeline->getExpectedBytes();
+            if (parseWatchers.at(jobIndex)->isFinished())
+            {
+                fractionDone += 1.0;
+            }
+            else if (expectedBytes > 0)
+            {
+                fractionDone += qMin(1.0, static_cast<double>(aPipeline->getBytesRead()) / static_cast<double>(expectedBytes));
+            }
+            jobIndex++;
+        }
+        int percentDone = static_cast<int>(100.0 * fractionDone / myPipelines.size());
+        loadProgressChanged("Decompressing and reading result files", percentDone);
+        return;
+    }
+
+    if (loadJobWatcher == nullptr) return;
+
+    if (!myPipelines.isEmpty())
+    {
+        loadProgressChanged("Building display", -1);
+        return;
+    }
+
+    //Note: the buffer list itself is not looked at, the worker may be filling it
+    int filesDecoded = buffersDecoded.loadAcquire();
+    if (filesDecoded < myFileNames.size())
+    {
+        loadProgressChanged("Decompressing result files", filesDecoded * 100 / myFileNames.size());
+        return;
+    }
+    loadProgressChanged("Reading result files", -1);
+}
+
 void ResultProcureBase::fileChanged(FileNodeRef changedFile)
 {
+    if (loadingCancelled()) return;
+
     if (changedFile.isNil())
     {
         if (initLoadDone) return;
@@ -200,21 +627,11 @@ bool ResultProcureBase::checkForAndSeekFiles()
                     return false;
                 }
 
-                targetFileNode = cwe_globals::get_file_handle()->speculateFileWithName(lastResult, fileName, false);
-            }
-            else if (fileName.endsWith(".gz"))
-            {
-                targetFileNode = cwe_globals::get_file_handle()->speculateFileWithName(myBaseFolder, fileName, false);
-
-                if (targetFileNode.isNil())
-                {
-                    fileName.chop(3);
-                    targetFileNode = cwe_globals::get_file_handle()->speculateFileWithName(myBaseFolder, fileName, false);
-                }
+                targetFileNode = speculateFileVariant(lastResult, fileName);
             }
             else
             {
-                targetFileNode = cwe_globals::get_file_handle()->speculateFileWithName(myBaseFolder, fileName, false);
+                targetFileNode = speculateFileVariant(myBaseFolder, fileName);
             }
 
             if (targetFileNode.isNil())
@@ -231,21 +648,77 @@ bool ResultProcureBase::checkForAndSeekFiles()
             fileNode = targetFileNode;
         }
 
-        if (!fileNode.fileBufferLoaded())
+        //Note: Taken as soon as downloaded, so another window may free the node's copy
+        if (myRawFiles.contains(fileID)) continue;
+        if (fileNode.fileBufferLoaded())
+        {
+            myRawFiles[fileID] = fileNode.getFileBuffer();
+            mySourcePaths[fileID] = fileNode.getFullPath();
+        }
+        else if (!openCachedFile(fileID, fileNode))
         {
             cwe_globals::get_file_handle()->sendDownloadBuffReq(fileNode);
         }
     }
 
-    for (FileNodeRef aNode : myFileNodes)
+    if (myRawFiles.size() < myFileNames.size())
+    {
+        loadProgressChanged("Downloading result files", myRawFiles.size() * 100 / myFileNames.size());
+        return false;
+    }
+
+    storeDownloadedFiles();
+    noteMemoryUse(getRawFileBytes());
+    return true;
+}
+
+bool ResultProcureBase::openCachedFile(QString fileID, FileNodeRef fileNode)
+{
+    QString cachedName = CFDresultCache::lookupFile(fileNode.getFullPath(), fileNode.getSize());
+    if (cachedName.isEmpty()) return false;
+
+    CFDlocalFile * cachedFile = new CFDlocalFile(cachedName);
+    if (!cachedFile->openFile())
     {
-        if (aNode.isNil()) return false;
-        if (!aNode.fileBufferLoaded()) return false;
+        delete cachedFile;
+        return false;
     }
 
+    myLocalFiles[fileID] = cachedFile;
+    myRawFiles[fileID] = cachedFile->getRawData();
+    mySourcePaths[fileID] = fileNode.getFullPath();
     return true;
 }
 
+void ResultProcureBase::storeDownloadedFiles()
+{
+    //Writing the cache is done in the background, the buffers are shared, not copied
+    for (QString fileID : myFileNodes.keys())
+    {
+        if (myLocalFiles.contains(fileID)) continue;
+
+        FileNodeRef aNode = myFileNodes.value(fileID);
+        QtConcurrent::run(&CFDresultCache::storeFile, aNode.getFullPath(),
+                          static_cast<qint64>(aNode.getSize()), myRawFiles.value(fileID));
+    }
+}
+
+QByteArray ResultProcureBase::getRawFile(QString fileID)
+{
+    return myRawFiles.value(fileID);
+}
+
+FileNodeRef ResultProcureBase::speculateFileVariant(FileNodeRef folder, QString fileName)
+{
+    //The named file is looked for first, then the same file stored with any other codec
+    for (QString aVariant : CFDcodecList::getFileVariants(fileName))
+    {
+        FileNodeRef ret = cwe_globals::get_file_handle()->speculateFileWithName(folder, aVariant, false);
+        if (!ret.isNil()) return ret;
+    }
+    return FileNodeRef();
+}
+
 FileNodeRef ResultProcureBase::getFinalResultFolder()
 {
     double biggestNum = -1.0;
@@ -273,6 +746,41 @@ FileNodeRef ResultProcureBase::getFinalResultFolder()
     return targetChild;
 }
 
+QString ResultProcureBase::getFinalLocalFolder(QString localFolder)
+{
+    double biggestNum = -1.0;
+    QString targetChild;
+
+    for (QString childName : QDir(localFolder).entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        if (childName == "0") continue;
+
+        bool isNum = false;
+        double childVal = childName.toDouble(&isNum);
+        if (!isNum) continue;
+
+        if (biggestNum < childVal)
+        {
+            biggestNum = childVal;
+            targetChild = localFolder + "/" + childName;
+        }
+    }
+
+    return targetChild;
+}
+
+QString ResultProcureBase::getSidecarName(QString fileID, CFDparseTarget aTarget)
+{
+    //Local files may change in place, so their time is part of the key
+    QString sourceName = mySourcePaths.value(fileID);
+    if (localSource)
+    {
+        sourceName = "file:" + sourceName + "@" + QString::number(QFileInfo(sourceName).lastModified().toMSecsSinceEpoch());
+    }
+
+    return CFDresultCache::getSidecarName(sourceName, getRawFile(fileID).size(), QString::number(static_cast<int>(aTarget)));
+}
+
 QString ResultProcureBase::getIDfromNode(FileNodeRef fileNode)
 {
     QString ret;
@@ -38,8 +38,15 @@
 
 #include <QWidget>
 #include <QMap>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QAtomicInt>
+
+#include <functional>
 
 #include "remoteFiles/filenoderef.h"
+#include "cfdparsepipeline.h"
+#include "cfdlocalfile.h"
 
 //TODO: Need to deal with situation when bsae folder is removed
 
@@ -55,6 +62,8 @@ public:
 
     void initializeWithNeededFiles(FileNodeRef baseFolder, QMap<QString, QString> neededFiles);
     //Note: needed files is a map: internalID => path relative to base folder
+    //The same, for a case already on local disk, such as one saved with CWEcaseInstance::downloadCase
+    void initializeWithLocalFolder(QString localFolder, QMap<QString, QString> neededFiles);
 
 protected:
     virtual void allFilesLoaded() = 0;
@@ -62,7 +71,25 @@ protected:
     QMap<QString, FileNodeRef> getFileNodes();
     QMap<QString, QByteArray *> getFileBuffers();
 
-    void computeFileBuffers();
+    //Returns false if a file could not be decoded, or the load was cancelled
+    bool computeFileBuffers();
+
+    //Decodes the files for getFileBuffers, then runs loadJob, both on a worker thread.
+    //loadJobFinished is then called on this thread. The job must not use any shown widget.
+    //If called from allFilesParsed, the job may read getParsedLists instead, and nothing is decoded.
+    void runLoadJob(std::function<bool()> loadJob);
+    virtual void loadJobFinished(bool jobOK);
+    //Called instead of loadJobFinished once a cancelled job stops, ex: to delete what it was filling
+    virtual void loadJobCancelled();
+    //A load job may free each decoded buffer as soon as it has read it
+    void releaseFileBuffer(QString fileID);
+
+    //Reads the files on worker threads, inflating and parsing at once, then calls allFilesParsed
+    //The parse is cancelled if this object is deleted first
+    //Note: All file data is freed once allFilesParsed, or loadJobFinished, returns
+    void parseFileBuffers(QMap<QString, CFDparseTarget> parseTargets);
+    QMap<QString, CFDparsedList *> getParsedLists();
+    virtual void allFilesParsed();
 
     virtual void underlyingDataChanged(QString fileID) = 0;
     //Note: input to the above method might be an empty string
@@ -70,20 +97,66 @@ protected:
 
     virtual void initialFailure() = 0;
 
+    //Called on this thread as the files are fetched and read. percentDone is -1 if not known.
+    virtual void loadProgressChanged(QString stageText, int percentDone);
+    //Stops any fetch or read still going, allFilesParsed and loadJobFinished are then not called
+    //The file data is freed once no job still reads it
+    void cancelLoading();
+    //Cancels, then waits for any job still going. Called by the destructor of a display whose
+    //jobs use its members or children, since this destructor only runs after that one.
+    void stopLoading();
+    bool loadingCancelled();
+
 private slots:
     void fileChanged(FileNodeRef changedFile);
+    void parseJobFinished();
+    void loadJobDone();
+    void updateLoadProgress();
 
 private:
     bool checkForAndSeekFiles(); //Returns true if all files loaded
+    FileNodeRef speculateFileVariant(FileNodeRef folder, QString fileName);
+    //Files found in the local cache are read from there, and not downloaded
+    bool openCachedFile(QString fileID, FileNodeRef fileNode);
+    void storeDownloadedFiles();
+    QByteArray getRawFile(QString fileID);
+    void releaseFileData();
+    void noteMemoryUse(qint64 bytesHeld);
+    qint64 getRawFileBytes();
+    bool collectRawFiles(QMap<QString, QString> * fileNames, QMap<QString, QByteArray> * rawFiles);
+    bool decodeFileBuffers(QMap<QString, QString> fileNames, QMap<QString, QByteArray> rawFiles);
     FileNodeRef getFinalResultFolder();
+    QString getFinalLocalFolder(QString localFolder);
+    QString getSidecarName(QString fileID, CFDparseTarget aTarget);
     QString getIDfromNode(FileNodeRef fileNode);
 
     FileNodeRef myBaseFolder;
 
     QMap<QString, QString> myFileNames;
     QMap<QString, FileNodeRef> myFileNodes;
+    //Raw files are shared with their file node or local file, not copied
+    QMap<QString, QByteArray> myRawFiles;
     QMap<QString, QByteArray *> myBufferList;
+    //Files read from disk, from the result cache or a local case
+    QMap<QString, CFDlocalFile *> myLocalFiles;
+    //The path of each file, remote or local, as found
+    QMap<QString, QString> mySourcePaths;
+    bool localSource = false;
     bool initLoadDone = false;
+
+    QMap<QString, CFDparsePipeline *> myPipelines;
+    QList<QFutureWatcher<bool> *> parseWatchers;
+    int parseJobsLeft = 0;
+
+    QFutureWatcher<bool> * loadJobWatcher = nullptr;
+    bool loadJobRunning = false;
+    QAtomicInt buffersDecoded;
+    QAtomicInt loadCancelled;
+    QTimer progressTimer;
+
+    //Bytes of file data held for this window, for reporting
+    qint64 decodedBytes = 0;
+    qint64 peakBytesHeld = 0;
 };
 
 #endif // RESULTVISUALBASE_H
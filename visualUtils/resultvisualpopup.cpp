@@ -42,6 +42,10 @@
 #include "CFDanalysis/cweanalysistype.h"
 #include "cwe_globals.h"
 
+#include <QDir>
+#include <QPushButton>
+#include <QVBoxLayout>
+
 ResultVisualPopup::ResultVisualPopup(CWEcaseInstance *theCase, RESULT_ENTRY * resultDesc, QWidget *parent) :
     ResultProcureBase(parent),
     ui(new Ui::ResultVisualPopup)
@@ -50,21 +54,21 @@ ResultVisualPopup::ResultVisualPopup(CWEcaseInstance *theCase, RESULT_ENTRY * re
 
     setAttribute(Qt::WA_DeleteOnClose, true);
 
+    //Note: A result shown from a local folder has no case, see setLocalFolder
     myCase = theCase;
-    if (myCase == nullptr)
-    {
-        cwe_globals::displayFatalPopup("Internal error: Empty case passed to result display");
-    }
 
     resultObj = *resultDesc;
 
-    displayFrameTenant = new QLabel("Loading result data. Please Wait.",this);
+    displayFrameTenant = makeLoadingDisplay();
     resultFrameLayout = new QHBoxLayout(ui->displayFrame);
     resultFrameLayout->addWidget(displayFrameTenant);
 }
 
 ResultVisualPopup::~ResultVisualPopup()
 {
+    //Note: The load jobs may still be filling a hidden child, so they are stopped before anything is deleted
+    stopLoading();
+
     if (displayFrameTenant != nullptr) delete displayFrameTenant;
     if (resultFrameLayout != nullptr) delete resultFrameLayout;
     delete ui;
@@ -72,6 +76,18 @@ ResultVisualPopup::~ResultVisualPopup()
 
 void ResultVisualPopup::performStandardInit(QMap<QString, QString> neededFiles)
 {
+    if (!localStageFolder.isEmpty())
+    {
+        setupResultDisplay(QDir::toNativeSeparators(localStageFolder), localTypeName, resultObj.displayName);
+        initializeWithLocalFolder(localStageFolder, neededFiles);
+        return;
+    }
+
+    if (myCase == nullptr)
+    {
+        cwe_globals::displayFatalPopup("Internal error: Empty case passed to result display");
+    }
+
     FileNodeRef trueBaseFolder = myCase->getCaseFolder().getChildWithName(resultObj.stage);
     if (trueBaseFolder.isNil())
     {
@@ -84,6 +100,12 @@ void ResultVisualPopup::performStandardInit(QMap<QString, QString> neededFiles)
     initializeWithNeededFiles(trueBaseFolder, neededFiles);
 }
 
+void ResultVisualPopup::setLocalFolder(QString stageFolder, QString typeName)
+{
+    localStageFolder = stageFolder;
+    localTypeName = typeName;
+}
+
 void ResultVisualPopup::setupResultDisplay(QString caseName, QString caseType, QString resultName)
 {
     ui->label_theName->setText(caseName);
@@ -92,10 +114,54 @@ void ResultVisualPopup::setupResultDisplay(QString caseName, QString caseType, Q
     this->show();
 }
 
+QWidget * ResultVisualPopup::makeLoadingDisplay()
+{
+    loadingDisplay = new QWidget(this);
+    QVBoxLayout * loadingLayout = new QVBoxLayout(loadingDisplay);
+
+    loadingLabel = new QLabel("Loading result data. Please Wait.", loadingDisplay);
+    loadingLabel->setAlignment(Qt::AlignCenter);
+
+    //Note: A range of 0 to 0 shows a busy bar, until the progress is known
+    loadingBar = new QProgressBar(loadingDisplay);
+    loadingBar->setRange(0, 0);
+
+    QPushButton * cancelButton = new QPushButton("Cancel", loadingDisplay);
+    QObject::connect(cancelButton, SIGNAL(clicked()), this, SLOT(cancelButtonClicked()));
+
+    loadingLayout->addStretch();
+    loadingLayout->addWidget(loadingLabel);
+    loadingLayout->addWidget(loadingBar);
+    loadingLayout->addWidget(cancelButton, 0, Qt::AlignHCenter);
+    loadingLayout->addStretch();
+
+    return loadingDisplay;
+}
+
+void ResultVisualPopup::loadProgressChanged(QString stageText, int percentDone)
+{
+    if ((loadingDisplay == nullptr) || (displayFrameTenant != loadingDisplay)) return;
+
+    loadingLabel->setText(stageText);
+    if (percentDone < 0)
+    {
+        loadingBar->setRange(0, 0);
+        return;
+    }
+    loadingBar->setRange(0, 100);
+    loadingBar->setValue(percentDone);
+}
+
 void ResultVisualPopup::changeDisplayFrameTenant(QWidget * newDisplay)
 {
     if (displayFrameTenant != nullptr)
     {
+        if (displayFrameTenant == loadingDisplay)
+        {
+            loadingDisplay = nullptr;
+            loadingLabel = nullptr;
+            loadingBar = nullptr;
+        }
         displayFrameTenant->deleteLater();
     }
     displayFrameTenant = newDisplay;
@@ -126,6 +192,12 @@ void ResultVisualPopup::initialFailure()
     changeDisplayFrameTenant(new QLabel("Error: Data for this result not available."));
 }
 
+void ResultVisualPopup::cancelButtonClicked()
+{
+    cancelLoading();
+    changeDisplayFrameTenant(new QLabel("Loading of this result was cancelled."));
+}
+
 void ResultVisualPopup::closeButtonClicked()
 {
     QObject::disconnect(this);
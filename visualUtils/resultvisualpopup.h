@@ -40,6 +40,7 @@
 #include <QFrame>
 #include <QLabel>
 #include <QHBoxLayout>
+#include <QProgressBar>
 
 #include "CFDanalysis/cweanalysistype.h"
 
@@ -60,12 +61,15 @@ public:
 
     virtual void initializeView() = 0;
     void performStandardInit(QMap<QString, QString> neededFiles);
+    //Call before initializeView, to show a stage folder on local disk. The case may then be null.
+    void setLocalFolder(QString stageFolder, QString typeName);
 
 protected:
     void setupResultDisplay(QString caseName, QString caseType, QString resultName);
     void changeDisplayFrameTenant(QWidget * newDisplay);
     virtual void initialFailure();
     virtual void underlyingDataChanged(QString fileID);
+    virtual void loadProgressChanged(QString stageText, int percentDone);
 
     RESULT_ENTRY getResultObj();
 
@@ -74,6 +78,7 @@ protected slots:
 
 private slots:
     void closeButtonClicked();
+    void cancelButtonClicked();
 
 private:
     Ui::ResultVisualPopup *ui;
@@ -81,8 +86,17 @@ private:
     CWEcaseInstance * myCase;
     RESULT_ENTRY resultObj;
 
+    QString localStageFolder;
+    QString localTypeName;
+
     QWidget * displayFrameTenant = nullptr;
     QHBoxLayout * resultFrameLayout = nullptr;
+
+    //Shown in the display frame until the result is ready
+    QWidget * makeLoadingDisplay();
+    QWidget * loadingDisplay = nullptr;
+    QLabel * loadingLabel = nullptr;
+    QProgressBar * loadingBar = nullptr;
 };
 
 #endif // RESULTVISUALPOPUP_H
@@ -0,0 +1,23 @@
+# The decoder of Zstandard 1.5.7, from https://github.com/facebook/zstd, BSD license (see LICENSE)
+# Files are as released, from lib/. The compressor, dictionary builder and legacy formats
+# are left out. Built into the program, so zstd results are read on every platform.
+
+DEFINES += ZSTD_DISABLE_ASM ZSTD_LEGACY_SUPPORT=0
+
+INCLUDEPATH += $$PWD/lib
+
+SOURCES += \
+    $$PWD/lib/common/debug.c \
+    $$PWD/lib/common/entropy_common.c \
+    $$PWD/lib/common/error_private.c \
+    $$PWD/lib/common/fse_decompress.c \
+    $$PWD/lib/common/xxhash.c \
+    $$PWD/lib/common/zstd_common.c \
+    $$PWD/lib/decompress/huf_decompress.c \
+    $$PWD/lib/decompress/zstd_ddict.c \
+    $$PWD/lib/decompress/zstd_decompress.c \
+    $$PWD/lib/decompress/zstd_decompress_block.c
+
+HEADERS += \
+    $$PWD/lib/zstd.h \
+    $$PWD/lib/zstd_errors.h